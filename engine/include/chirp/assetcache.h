@@ -0,0 +1,56 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct asset_cache asset_cache_t;
+
+typedef void (*asset_cache_free_t)(void *data);
+
+typedef struct asset_cache_stats
+{
+	size_t size;
+	size_t budget;
+	Uint32 entry_count;
+	Uint64 hits;
+	Uint64 misses;
+	Uint64 evictions;
+} asset_cache_stats_t;
+
+/**
+ * Cache of decoded assets, keyed by asset hash,
+ * entries without references are evicted, least recently used first,
+ * once the total size goes above the budget
+ */
+[[nodiscard]]
+asset_cache_t *asset_cache_create(size_t budget);
+
+/**
+ * Free all entries, including entries that are still referenced
+ */
+void asset_cache_destroy(asset_cache_t *cache);
+
+/**
+ * Get a cached entry and add a reference to it
+ * @returns Cached data, or nullptr if not cached
+ */
+[[nodiscard]]
+void *asset_cache_acquire(asset_cache_t *cache, Uint32 key);
+
+/**
+ * Add an entry with one reference,
+ * if the key is already cached, data is freed and the cached entry is acquired instead
+ * @returns Cached data, or nullptr on failure, in which case data is not freed
+ */
+[[nodiscard]]
+void *asset_cache_insert(asset_cache_t *cache, Uint32 key,
+	void *data, size_t size, asset_cache_free_t free_data);
+
+/**
+ * Remove a reference, entry is kept until evicted
+ */
+void asset_cache_release(asset_cache_t *cache, Uint32 key);
+
+[[nodiscard]]
+asset_cache_stats_t asset_cache_stats(asset_cache_t *cache);
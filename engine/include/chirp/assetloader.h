@@ -0,0 +1,44 @@
+#pragma once
+
+#include "chirp/assets.h"
+#include "chirp/threadpool.h"
+
+typedef struct asset_loader asset_loader_t;
+
+/**
+ * Runs on a worker thread, set an error and return false on failure
+ */
+typedef bool (*asset_job_t)(const assets_t *assets, void *userdata);
+
+/**
+ * Runs on the thread calling asset_loader_poll, with the error set if the job failed
+ */
+typedef void (*asset_job_done_t)(bool success, void *userdata);
+
+/**
+ * @param assets Not copied, has to outlive the loader
+ * @param thread_count Number of worker threads, or 0 to base it on the number of cores
+ */
+[[nodiscard]]
+asset_loader_t *asset_loader_create(const assets_t *assets, int thread_count);
+
+/**
+ * Wait for all pending jobs and run their callbacks before destroying
+ */
+void asset_loader_destroy(asset_loader_t *loader);
+
+/**
+ * Workers of the loader, jobs may submit more work to it,
+ * but shouldn't wait for it to start, as every worker could be waiting
+ */
+[[nodiscard]]
+thread_pool_t *asset_loader_thread_pool(const asset_loader_t *loader);
+
+[[nodiscard]]
+bool asset_loader_submit(asset_loader_t *loader, asset_job_t job,
+	asset_job_done_t done, void *userdata);
+
+/**
+ * Run callbacks for all jobs that finished since the last poll
+ */
+void asset_loader_poll(asset_loader_t *loader);
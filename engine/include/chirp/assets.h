@@ -1,20 +1,94 @@
 #pragma once
 
+#include "chirp/assettrace.h"
+#include "chirp/blockcache.h"
+#include "chirp/diskcache.h"
+#include "chirp/filemap.h"
+#include "chirp/filereader.h"
 #include "chirp/input.h"
-#include "chirp/map.h"
 #include "chirp/windowconfig.h"
 
 #include <SDL3/SDL_iostream.h>
 #include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct file_descriptor file_descriptor_t;
+
+/**
+ * Set to 0 to read archives instead of memory mapping them,
+ * using the block cache, resident assets and batched reads, read when assets are created
+ */
+#define ASSETS_HINT_MAP "CHIRP_ASSETS_MAP"
+
+/**
+ * Size of each block in the block cache in KiB, a power of two,
+ * read when assets are created, for archives that aren't memory mapped
+ */
+#define ASSETS_HINT_BLOCK_SIZE "CHIRP_ASSETS_BLOCK_SIZE"
+
+/**
+ * Number of blocks in the block cache, or 0 to disable it,
+ * like the block size only used for archives that aren't memory mapped
+ */
+#define ASSETS_HINT_BLOCK_COUNT "CHIRP_ASSETS_BLOCK_COUNT"
+
+/**
+ * Asset is stored as compressed blocks, see compress.h
+ */
+constexpr Uint16 asset_flag_compressed = 1 << 0;
+
+/**
+ * Asset is already in the layout the GPU expects,
+ * and can be read as is into a transfer buffer
+ */
+constexpr Uint16 asset_flag_gpu_ready = 1 << 1;
+
+/**
+ * Asset is small, and stored next to all other resident assets,
+ * so they can all be kept in memory after a single read
+ */
+constexpr Uint16 asset_flag_resident = 1 << 2;
 
 typedef struct assets
 {
 	SDL_IOStream *stream;
 	SDL_Mutex *read_mutex;
+	file_map_t map;
+	file_reader_t reader;
 	window_config_t window_config;
-	map_t desc;
+	file_descriptor_t *desc;
+	Uint32 desc_count;
+	// Alignment of each asset in the archive, in bytes
+	Uint32 alignment;
+	// Only set while recording or prefetching a trace
+	asset_trace_t *trace;
+	asset_readahead_t *readahead;
+	// Shared by all streams, only used if not memory mapped
+	block_cache_t *cache;
+	// All resident assets, read when created, only used if not memory mapped
+	Uint8 *resident;
+	Uint64 resident_offset;
+	size_t resident_size;
+	// Decoded assets from previous launches, only set if enabled
+	disk_cache_t *disk_cache;
 } assets_t;
 
+typedef struct asset_view
+{
+	const void *data;
+	size_t size;
+} asset_view_t;
+
+typedef struct asset_read
+{
+	const char *name;
+	void *dst;
+	// Expected size of the asset, see assets_size
+	size_t size;
+} asset_read_t;
+
 bool assets_create(const char *path, input_t input, assets_t *assets);
 
 void assets_destroy(const assets_t *assets);
@@ -22,5 +96,81 @@ void assets_destroy(const assets_t *assets);
 [[nodiscard]]
 window_config_t assets_window_config(const assets_t *assets);
 
+/**
+ * Hash of an asset name, as stored in the archive
+ */
+[[nodiscard]]
+Uint32 assets_hash(const char *name);
+
+/**
+ * Check if an asset exists, without setting an error if not
+ */
+[[nodiscard]]
+bool assets_exists(const assets_t *assets, const char *name);
+
+/**
+ * Hash of the contents of an asset before compression, as stored by chirp-pack,
+ * only available in archives of version 3 and later
+ */
+[[nodiscard]]
+bool assets_content_hash(const assets_t *assets, const char *name, Uint32 *hash);
+
 [[nodiscard]]
 SDL_IOStream *assets_load(const assets_t *assets, const char *name);
+
+/**
+ * Get a read-only view of an asset directly inside the archive,
+ * only available if the archive is memory mapped, or the asset is resident,
+ * and the asset isn't compressed
+ */
+[[nodiscard]]
+bool assets_view(const assets_t *assets, const char *name, asset_view_t *view);
+
+/**
+ * Size of an asset once loaded, after decompression
+ */
+[[nodiscard]]
+bool assets_size(const assets_t *assets, const char *name, size_t *size);
+
+/**
+ * Read an entire asset into caller owned memory, like a mapped transfer buffer,
+ * without any intermediate copies if the asset isn't compressed
+ * @param size Expected size of the asset, see assets_size
+ */
+[[nodiscard]]
+bool assets_read(const assets_t *assets, const char *name, void *dst, size_t size);
+
+/**
+ * Read several entire assets, like assets_read,
+ * uncompressed assets are submitted together as a single batch (see readbatch.h),
+ * and compressed assets are decompressed while the batch is read
+ */
+[[nodiscard]]
+bool assets_read_batch(const assets_t *assets, const asset_read_t *reads, size_t count);
+
+/**
+ * Hit and miss counters of the block cache
+ * @returns false if there is no block cache
+ */
+[[nodiscard]]
+bool assets_block_cache_stats(const assets_t *assets, block_cache_stats_t *stats);
+
+/**
+ * Record every asset accessed from now on to a trace file, see assettrace.h
+ */
+[[nodiscard]]
+bool assets_record_trace(assets_t *assets, const char *path);
+
+/**
+ * Prefetch assets in a previously recorded trace on a background thread,
+ * in the order they were accessed
+ */
+[[nodiscard]]
+bool assets_readahead(assets_t *assets, const char *path);
+
+/**
+ * Keep decoded assets in a directory between launches, see diskcache.h,
+ * entries are only used while the asset in the archive is unchanged
+ */
+[[nodiscard]]
+bool assets_use_disk_cache(assets_t *assets, const char *path, const char *version);
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "chirp/blockcache.h"
+#include "chirp/filereader.h"
+
 #include <SDL3/SDL_iostream.h>
 #include <SDL3/SDL_mutex.h>
 #include <SDL3/SDL_stdinc.h>
@@ -7,3 +10,26 @@
 [[nodiscard]]
 SDL_IOStream *asset_stream_open_io(SDL_IOStream *stream,
 	SDL_Mutex *read_mutex, Sint64 offset, Sint64 size);
+
+/**
+ * Stream reading with positional reads,
+ * each stream has its own position, so no locking is needed
+ */
+[[nodiscard]]
+SDL_IOStream *asset_stream_open_reader(file_reader_t reader,
+	Sint64 offset, Sint64 size);
+
+/**
+ * Stream reading through a block cache shared with other streams,
+ * reads ahead until the end of the asset while reading sequentially
+ */
+[[nodiscard]]
+SDL_IOStream *asset_stream_open_cached(block_cache_t *cache,
+	Sint64 offset, Sint64 size);
+
+/**
+ * Stream decompressing chunked data from source as it's read,
+ * source is closed together with the returned stream, or on failure
+ */
+[[nodiscard]]
+SDL_IOStream *asset_stream_open_compressed(SDL_IOStream *source);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "chirp/filemap.h"
+#include "chirp/filereader.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+/**
+ * Records every asset access to a text file, one asset per line, as:
+ * name, offset, size and microseconds since recording started, separated by tabs
+ *
+ * The same file can be given to chirp-pack --trace, to order the archive by it
+ */
+typedef struct asset_trace asset_trace_t;
+
+/**
+ * Reads ranges of an archive on a background thread, ahead of when they're needed
+ */
+typedef struct asset_readahead asset_readahead_t;
+
+typedef struct asset_range
+{
+	Uint64 offset;
+	Uint64 size;
+} asset_range_t;
+
+/**
+ * Called for each asset name in a trace, in the order they were accessed
+ */
+typedef void (*asset_trace_callback_t)(const char *name, void *userdata);
+
+[[nodiscard]]
+asset_trace_t *asset_trace_create(const char *path);
+
+void asset_trace_destroy(asset_trace_t *trace);
+
+/**
+ * Safe to call from multiple threads
+ */
+void asset_trace_add(asset_trace_t *trace, const char *name, Uint64 offset, Uint64 size);
+
+/**
+ * Parse a previously recorded trace, names are only valid during the callback
+ */
+[[nodiscard]]
+bool asset_trace_parse(const char *text, size_t size,
+	asset_trace_callback_t callback, void *userdata);
+
+/**
+ * Start prefetching ranges in order, uses the mapping if there is one, otherwise the reader
+ * @param ranges Ranges to prefetch, ownership is taken even on failure
+ */
+[[nodiscard]]
+asset_readahead_t *asset_readahead_start(const file_map_t *map, const file_reader_t *reader,
+	asset_range_t *ranges, size_t range_count);
+
+/**
+ * Stop prefetching, has to be called before the file is closed
+ */
+void asset_readahead_stop(asset_readahead_t *readahead);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+/**
+ * Cache of fixed-size blocks of a file, aligned to the block size,
+ * shared by all streams reading from the same file
+ */
+typedef struct block_cache block_cache_t;
+
+/**
+ * Read from the underlying file, has to be safe to call from multiple threads
+ * @returns Number of bytes read
+ */
+typedef size_t (*block_cache_read_t)(void *userdata, void *dst, size_t size, Uint64 offset);
+
+typedef struct block_cache_stats
+{
+	// Blocks found in the cache
+	Uint64 hits;
+	// Blocks read from the file
+	Uint64 misses;
+	// Blocks read ahead of time, before they were requested
+	Uint64 readahead;
+	// Reads large enough to skip the cache
+	Uint64 direct;
+} block_cache_stats_t;
+
+/**
+ * @param block_size Size of each block, has to be a power of two
+ * @param block_count Number of blocks to keep in memory
+ * @param userdata Passed to read, freed using SDL_free together with the cache
+ */
+[[nodiscard]]
+block_cache_t *block_cache_create(size_t block_size, size_t block_count, Uint64 file_size,
+	block_cache_read_t read, void *userdata);
+
+void block_cache_destroy(block_cache_t *cache);
+
+/**
+ * Read through the cache, safe to call from multiple threads
+ * @param readahead_end Where reading is expected to continue up to,
+ * blocks up to here are read together with the first missing block
+ * @returns Number of bytes read
+ */
+[[nodiscard]]
+size_t block_cache_read(block_cache_t *cache, void *dst, size_t size,
+	Uint64 offset, Uint64 readahead_end);
+
+[[nodiscard]]
+block_cache_stats_t block_cache_stats(block_cache_t *cache);
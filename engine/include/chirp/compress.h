@@ -0,0 +1,43 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+/**
+ * Size of uncompressed blocks, each block can be decoded on its own
+ */
+constexpr Uint32 compress_block_size = 64 * 1024;
+
+/**
+ * Size of the header in front of chunked data:
+ * raw size, block size and block count, followed by the end offset of each block
+ */
+constexpr size_t compress_header_size = sizeof(Uint32) * 3;
+
+/**
+ * Largest possible size of a single compressed block
+ */
+[[nodiscard]]
+size_t compress_bound(size_t size);
+
+/**
+ * Compress a single block using the LZ4 block format,
+ * returns 0 if the result doesn't fit in dst
+ */
+[[nodiscard]]
+size_t compress_block(const void *src, size_t src_size, void *dst, size_t dst_capacity);
+
+/**
+ * Decompress a single block, dst_size must be the exact decompressed size
+ */
+[[nodiscard]]
+bool decompress_block(const void *src, size_t src_size, void *dst, size_t dst_size);
+
+/**
+ * Compress data into independent blocks,
+ * blocks that don't get any smaller are stored as-is
+ * @returns Compressed data, or nullptr on failure, free using SDL_free
+ */
+[[nodiscard]]
+void *compress_chunked(const void *data, size_t size, size_t *compressed_size);
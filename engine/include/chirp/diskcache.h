@@ -0,0 +1,51 @@
+#pragma once
+
+#include "chirp/filemap.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+/**
+ * Assets decoded on a previous launch, stored as one file per asset in a directory,
+ * usually in the pref path, so decoding can be skipped until the asset changes
+ */
+typedef struct disk_cache disk_cache_t;
+
+typedef struct disk_cache_entry
+{
+	const Uint8 *data;
+	size_t size;
+
+	// Either the mapped file, or the file read into memory if it couldn't be mapped
+	file_map_t map;
+	void *buffer;
+} disk_cache_entry_t;
+
+/**
+ * @param path Directory to store files in, created if it doesn't exist
+ * @param version Entries stored by a different version are ignored, usually the engine version
+ */
+[[nodiscard]]
+disk_cache_t *disk_cache_create(const char *path, const char *version);
+
+void disk_cache_destroy(disk_cache_t *cache);
+
+/**
+ * Open a previously stored entry, close using disk_cache_close
+ * @param signature Has to match what the entry was stored with, for example a hash of its source
+ * @returns false if there is no entry, or if it's outdated
+ */
+[[nodiscard]]
+bool disk_cache_open(const disk_cache_t *cache, const char *key, Uint32 signature,
+	disk_cache_entry_t *entry);
+
+void disk_cache_close(const disk_cache_entry_t *entry);
+
+/**
+ * Store an entry, replacing any previous one with the same key,
+ * safe to call from multiple threads as long as keys are different
+ */
+[[nodiscard]]
+bool disk_cache_store(const disk_cache_t *cache, const char *key, Uint32 signature,
+	const void *data, size_t size);
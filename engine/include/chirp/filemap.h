@@ -0,0 +1,30 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct file_map
+{
+	const Uint8 *data;
+	size_t size;
+
+	// Platform specific handle, only used on Windows
+	void *handle;
+} file_map_t;
+
+/**
+ * Map an entire file read-only into memory,
+ * fails on platforms or paths where mapping isn't possible
+ * (for example, assets packed inside an APK)
+ */
+[[nodiscard]]
+bool file_map_open(const char *path, file_map_t *map);
+
+void file_map_close(const file_map_t *map);
+
+/**
+ * Hint that a range will be read soon, so it can be paged in ahead of time,
+ * may block while pages are read on platforms without an asynchronous hint
+ */
+void file_map_prefetch(const file_map_t *map, size_t offset, size_t size);
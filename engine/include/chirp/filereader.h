@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct file_reader
+{
+	// File descriptor, or HANDLE on Windows
+	Sint64 handle;
+	Uint64 size;
+	// Set once opened, 0 is a valid file descriptor, so the handle can't tell
+	bool is_open;
+} file_reader_t;
+
+/**
+ * Open a file for positional reads,
+ * fails on paths only reachable through SDL (for example, inside an APK)
+ */
+[[nodiscard]]
+bool file_reader_open(const char *path, file_reader_t *reader);
+
+void file_reader_close(const file_reader_t *reader);
+
+/**
+ * Read from an absolute offset without using a shared file position,
+ * safe to call from multiple threads at the same time
+ */
+[[nodiscard]]
+size_t file_reader_read_at(const file_reader_t *reader, void *ptr, size_t size, Uint64 offset);
+
+/**
+ * Hint that a range will be read soon, so it can be cached ahead of time,
+ * may block while it's read on platforms without an asynchronous hint
+ */
+void file_reader_prefetch(const file_reader_t *reader, Uint64 offset, Uint64 size);
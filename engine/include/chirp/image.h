@@ -3,4 +3,11 @@
 #include <SDL3/SDL_iostream.h>
 #include <SDL3/SDL_surface.h>
 
+#include <stddef.h>
+
 SDL_Surface *load_qoi(SDL_IOStream *source, bool close_io);
+
+/**
+ * Decode directly from memory, without copying the encoded data first
+ */
+SDL_Surface *load_qoi_mem(const void *data, size_t size);
@@ -38,3 +38,14 @@ void json_init(json_parser_t *parser);
 
 int json_parse(json_parser_t *parser, const char *json, size_t json_len,
 	json_token_t *tokens, size_t token_count);
+
+/**
+ * Tokenize an entire document at once, with the same tokens as json_parse,
+ * structural characters are found 32 bytes at a time using SSE2/NEON if enabled,
+ * and tokens are allocated as needed,
+ * unlike json_parse, quotes, brackets and colons inside numbers and literals are errors
+ * @param tokens Set to the tokens, free using SDL_free
+ * @returns Number of tokens, or a json_error_t
+ */
+[[nodiscard]]
+int json_tokenize(const char *json, size_t json_len, json_token_t **tokens);
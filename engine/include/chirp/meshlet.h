@@ -0,0 +1,35 @@
+#pragma once
+
+#include "chirp/matrix.h"
+#include "chirp/modelinfo.h"
+
+#include <stddef.h>
+
+/**
+ * Most vertices used by a single cluster
+ */
+static constexpr size_t mesh_cluster_max_vertices = 64;
+
+/**
+ * Most triangles in a single cluster
+ */
+static constexpr size_t mesh_cluster_max_triangles = 124;
+
+/**
+ * Split the full detail indices of an optimized primitive into clusters, in the order they're drawn,
+ * starting a new cluster when one would use too many vertices or triangles,
+ * replacing any existing clusters, primitives that fit in a single cluster don't get any
+ */
+[[nodiscard]]
+bool mesh_primitive_build_clusters(mesh_primitive_t *primitive);
+
+/**
+ * Find clusters that are inside the view frustum and have triangles facing the camera
+ * @param mvp Transform from model space to clip space
+ * @param ranges One for each cluster, or one if the primitive has no clusters,
+ * clusters next to each other are merged into one range
+ * @returns Number of ranges of full detail indices to draw
+ */
+[[nodiscard]]
+size_t mesh_primitive_cull_clusters(const mesh_primitive_t *primitive, const matrix4x4_t *mvp,
+	mesh_lod_t *ranges);
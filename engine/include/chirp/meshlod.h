@@ -0,0 +1,77 @@
+#pragma once
+
+#include "chirp/matrix.h"
+#include "chirp/modelinfo.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+/**
+ * Primitives with fewer triangles are always drawn in full detail
+ */
+static constexpr size_t mesh_lod_min_triangles = 64;
+
+/**
+ * Largest error allowed when simplifying, relative to the radius of the primitive
+ */
+static constexpr float mesh_lod_max_error = 0.05F;
+
+/**
+ * Projected size, as a fraction of the screen height, below which levels of detail are used
+ */
+static constexpr float mesh_lod_detail_size = 0.5F;
+
+/**
+ * How much the projected size has to change before a different level of detail is picked
+ */
+static constexpr float mesh_lod_hysteresis = 0.15F;
+
+/**
+ * Reduce the number of triangles by collapsing edges, picking those that change the surface
+ * the least first, measured using quadric error metrics, vertices on borders and seams don't move
+ * @param destination Same size as indices, can be the same array
+ * @param target_error Largest error allowed, relative to the radius of the mesh
+ * @param result_count Number of indices written to destination
+ * @param result_error Largest error of any collapse, relative to the radius of the mesh
+ */
+[[nodiscard]]
+bool mesh_simplify(Uint32 *destination, const Uint32 *indices, size_t index_count,
+	const primitive_vertex_t *vertices, size_t vertex_count, size_t target_index_count,
+	float target_error, size_t *result_count, float *result_error);
+
+/**
+ * Simplify an optimized primitive into a chain of levels of detail, each from the previous one,
+ * levels that barely remove any triangles are skipped, along with all after them
+ * @param ratios Target ratios of triangles compared to full detail, in decreasing order
+ */
+[[nodiscard]]
+bool mesh_primitive_generate_lods(mesh_primitive_t *primitive, const float *ratios, size_t ratio_count);
+
+/**
+ * Indices to draw for a level of detail, 0 being full detail
+ */
+[[nodiscard]]
+mesh_lod_t mesh_primitive_lod(const mesh_primitive_t *primitive, size_t level);
+
+/**
+ * Projected diameter of the bounding sphere of all primitives, as a fraction of the screen height
+ * @param mvp Transform from model space to clip space
+ */
+[[nodiscard]]
+float mesh_screen_size(const model_mesh_t *mesh, const matrix4x4_t *mvp);
+
+/**
+ * Only follow larger changes in projected size,
+ * so levels of detail don't flicker when close to where they change
+ * @param previous Size returned last frame, or 0 if there is none
+ */
+[[nodiscard]]
+float mesh_lod_screen_size(float previous, float size);
+
+/**
+ * Coarsest level of detail that still has about as many triangles per pixel as full detail would,
+ * with full detail at mesh_lod_detail_size
+ */
+[[nodiscard]]
+size_t mesh_primitive_select_lod(const mesh_primitive_t *primitive, float screen_size);
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "chirp/modelinfo.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+/**
+ * Post-transform vertex cache size the optimizations target,
+ * small enough to not be worse on any current GPU
+ */
+constexpr size_t mesh_cache_size = 16;
+
+typedef struct mesh_cache_stats
+{
+	// Average cache miss ratio, vertices transformed per triangle, 0.5 at best, 3 at worst
+	float acmr;
+
+	// Average transform to vertex ratio, vertices transformed per used vertex, 1 at best
+	float atvr;
+} mesh_cache_stats_t;
+
+/**
+ * Triangles using each vertex
+ */
+typedef struct mesh_vertex_triangles
+{
+	// Where the triangles of each vertex start in triangles, vertex_count + 1 entries
+	Uint32 *offsets;
+	Uint32 *triangles;
+} mesh_vertex_triangles_t;
+
+/**
+ * Free using mesh_free_vertex_triangles, even on failure
+ */
+[[nodiscard]]
+bool mesh_build_vertex_triangles(const Uint32 *indices, size_t index_count,
+	size_t vertex_count, mesh_vertex_triangles_t *adjacency);
+
+void mesh_free_vertex_triangles(const mesh_vertex_triangles_t *adjacency);
+
+/**
+ * Simulate a FIFO post-transform cache to see how often vertices are transformed,
+ * index counts are always a multiple of 3, as only triangle lists are supported
+ */
+[[nodiscard]]
+mesh_cache_stats_t mesh_analyze_vertex_cache(const Uint32 *indices, size_t index_count,
+	size_t vertex_count, size_t cache_size);
+
+/**
+ * Reorder triangles so recently used vertices are reused while still in the cache, using Tipsify
+ */
+[[nodiscard]]
+bool mesh_optimize_vertex_cache(Uint32 *indices, size_t index_count,
+	size_t vertex_count, size_t cache_size);
+
+/**
+ * Reorder clusters of triangles so outward facing ones are drawn first,
+ * indices should already be optimized for the vertex cache
+ * @param threshold How much worse the cache miss ratio is allowed to get, 1.05 allows 5%
+ */
+[[nodiscard]]
+bool mesh_optimize_overdraw(Uint32 *indices, size_t index_count,
+	const primitive_vertex_t *vertices, size_t vertex_count, size_t cache_size, float threshold);
+
+/**
+ * Reorder vertices in the order they're first used, and remove unused ones
+ * @param destination Same size as vertices, can't be the same array
+ * @param used_count Number of vertices written to destination
+ */
+[[nodiscard]]
+bool mesh_optimize_vertex_fetch(primitive_vertex_t *destination, const primitive_vertex_t *vertices,
+	size_t vertex_count, Uint32 *indices, size_t index_count, size_t *used_count);
+
+/**
+ * Copy the full detail indices to a 32-bit array, regardless of index size
+ * @returns Indices, free using SDL_free, or nullptr if out of memory or any index is out of range
+ */
+[[nodiscard]]
+Uint32 *mesh_primitive_widen_indices(const mesh_primitive_t *primitive);
+
+/**
+ * Copy 32-bit indices to an array of the given index size
+ */
+void mesh_narrow_indices(const Uint32 *indices, size_t index_count, size_t index_size, void *target);
+
+/**
+ * Optimize a loaded primitive for the vertex cache, overdraw and vertex fetch, in that order,
+ * primitives without indices are left as is
+ */
+[[nodiscard]]
+bool mesh_primitive_optimize(mesh_primitive_t *primitive);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "chirp/assets.h"
+#include "chirp/modelinfo.h"
+
+#include <SDL3/SDL_iostream.h>
+
+#include <stddef.h>
+
+/**
+ * Name of the cooked version of a model
+ * @returns Name, free using SDL_free
+ */
+[[nodiscard]]
+char *model_cooked_name(const char *name);
+
+/**
+ * Name of the GPU-ready vertices and indices of a primitive in a cooked model,
+ * index counts primitives across all meshes
+ * @returns Name, free using SDL_free
+ */
+[[nodiscard]]
+char *model_cooked_mesh_name(const char *name, size_t index);
+
+/**
+ * Write everything except vertices and indices,
+ * those are written separately for each primitive using model_cooked_write_mesh
+ */
+[[nodiscard]]
+bool model_cooked_write(const model_info_t *model, SDL_IOStream *stream);
+
+/**
+ * Write vertices followed by indices, in the layout uploaded to the GPU
+ */
+[[nodiscard]]
+bool model_cooked_write_mesh(const mesh_primitive_t *primitive, SDL_IOStream *stream);
+
+/**
+ * Write everything, including vertices and indices of all primitives,
+ * for models stored outside of an archive
+ */
+[[nodiscard]]
+bool model_cooked_write_all(const model_info_t *model, SDL_IOStream *stream);
+
+[[nodiscard]]
+bool model_cooked_exists(const assets_t *assets, const char *name);
+
+/**
+ * Load a cooked model without parsing any glTF,
+ * vertices and indices are read straight into transfer buffers when uploaded
+ */
+[[nodiscard]]
+bool model_info_create_cooked(const assets_t *assets, const char *name, model_info_t *model);
+
+/**
+ * Load a model written by model_cooked_write_all,
+ * data only needs to be valid until this returns
+ */
+[[nodiscard]]
+bool model_info_create_cooked_mem(const assets_t *assets, const void *data,
+	size_t size, model_info_t *model);
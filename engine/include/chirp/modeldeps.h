@@ -0,0 +1,82 @@
+#pragma once
+
+#include "chirp/assets.h"
+
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef enum : Uint8
+{
+	MODEL_DEPENDENCY_GLTF   = 0,
+	MODEL_DEPENDENCY_BUFFER = 1,
+	MODEL_DEPENDENCY_IMAGE  = 2,
+} model_dependency_type_t;
+
+typedef struct model_dependency
+{
+	model_dependency_type_t type;
+	// Name of the asset inside the archive
+	char *asset_name;
+	// As referenced by the glTF file, empty for the glTF file itself
+	char *uri;
+	// Size once loaded, after decompression
+	Uint64 size;
+} model_dependency_t;
+
+/**
+ * Every file a glTF model is loaded from, including itself,
+ * recorded by chirp-pack so they can all be read before parsing starts
+ */
+typedef struct model_deps
+{
+	model_dependency_t *items;
+	size_t count;
+} model_deps_t;
+
+/**
+ * Name of the dependency list of a model
+ * @returns Name, free using SDL_free
+ */
+[[nodiscard]]
+char *model_deps_name(const char *name);
+
+/**
+ * Name of a buffer or image referenced by a model, as stored in the archive
+ * @returns Name, free using SDL_free
+ */
+[[nodiscard]]
+char *model_dependency_asset_name(const char *uri);
+
+[[nodiscard]]
+model_dependency_type_t model_dependency_type(const char *uri);
+
+/**
+ * Add a dependency, taking ownership of asset_name and uri
+ */
+[[nodiscard]]
+bool model_deps_add(model_deps_t *deps, model_dependency_type_t type,
+	char *asset_name, char *uri, Uint64 size);
+
+[[nodiscard]]
+bool model_deps_write(const model_deps_t *deps, SDL_IOStream *stream);
+
+/**
+ * Load the dependency list of a model
+ * @returns false if the model has none, or it couldn't be read
+ */
+[[nodiscard]]
+bool model_deps_load(const assets_t *assets, const char *name, model_deps_t *deps);
+
+[[nodiscard]]
+bool model_deps_exists(const assets_t *assets, const char *name);
+
+/**
+ * Hash of the contents of every dependency, changes if any of them change
+ * @returns false if the archive doesn't store content hashes
+ */
+[[nodiscard]]
+bool model_deps_signature(const assets_t *assets, const model_deps_t *deps, Uint32 *signature);
+
+void model_deps_destroy(const model_deps_t *deps);
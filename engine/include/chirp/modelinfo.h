@@ -2,6 +2,7 @@
 
 #include "chirp/assets.h"
 #include "chirp/matrix.h"
+#include "chirp/threadpool.h"
 #include "chirp/vector.h"
 
 #include <SDL3/SDL_iostream.h>
@@ -9,7 +10,15 @@
 
 #include <stddef.h>
 
-typedef Uint16 primitive_index_t;
+/**
+ * Default number of vertices in a model before its primitives are decoded in parallel
+ */
+static constexpr size_t model_parallel_min_vertices = 65'536;
+
+/**
+ * Maximum number of simplified levels of detail for each primitive
+ */
+static constexpr size_t mesh_max_lods = 4;
 
 typedef struct material material_t;
 typedef struct scene_camera scene_camera_t;
@@ -19,24 +28,82 @@ typedef struct primitive_vertex
 	vector3f_t position;
 	vector3f_t normal;
 	vector2f_t tex_coord;
-	vector4f_t color;
 } primitive_vertex_t;
 
+/**
+ * Simplified version of a primitive, using the same vertices
+ */
+typedef struct mesh_lod
+{
+	// In indices, not bytes, into the indices of the primitive
+	size_t index_offset;
+	size_t index_count;
+} mesh_lod_t;
+
+/**
+ * Range of full detail triangles close to each other, culled as one
+ */
+typedef struct mesh_cluster
+{
+	// In indices, not bytes, into the indices of the primitive
+	size_t index_offset;
+	size_t index_count;
+
+	// Bounding sphere of its vertices
+	vector3f_t center;
+	float radius;
+
+	// Normals of all triangles are within this cone, cutoff is the sine of the half angle
+	// of the cone, or 1 if the triangles face too many directions to ever all face away
+	vector3f_t cone_axis;
+	float cone_cutoff;
+} mesh_cluster_t;
+
 typedef struct mesh_primitive
 {
 	primitive_vertex_t *vertices;
 	size_t vertex_count;
 
-	primitive_index_t *indices;
+	// Uint16 or Uint32 depending on index_size, see mesh_primitive_index_size,
+	// full detail, followed by the indices of each level of detail
+	void *indices;
 	size_t index_count;
+	size_t index_size;
+
+	// Each with fewer triangles than the previous one
+	mesh_lod_t lods[mesh_max_lods];
+	size_t lod_count;
+
+	// Full detail indices split into consecutive ranges, none if small enough to be a single one
+	mesh_cluster_t *clusters;
+	size_t cluster_count;
+
+	// Base colour of the material, the same for every vertex
+	vector4f_t color;
+
+	// Axis aligned bounds of all vertex positions
+	vector3f_t bounds_min;
+	vector3f_t bounds_max;
+
+	// GPU-ready asset with vertices followed by all indices, read instead if set
+	char *gpu_asset;
 } mesh_primitive_t;
 
+/**
+ * Primitives of a glTF mesh, shared by all nodes using it
+ */
+typedef struct model_mesh
+{
+	mesh_primitive_t *primitives;
+	size_t primitive_count;
+} model_mesh_t;
+
 typedef struct model_node
 {
 	char *name;
 
-	mesh_primitive_t *primitives;
-	size_t primitive_count;
+	// Owned by the model, nullptr if the node doesn't have a mesh
+	model_mesh_t *mesh;
 
 	const matrix4x4_t world_transform;
 	vector3f_t translation;
@@ -44,9 +111,15 @@ typedef struct model_node
 
 typedef struct model_info
 {
+	// Archive the model was loaded from
+	const assets_t *assets;
+
 	material_t *materials;
 	size_t material_count;
 
+	model_mesh_t *meshes;
+	size_t mesh_count;
+
 	model_node_t *nodes;
 	size_t node_count;
 
@@ -57,8 +130,73 @@ typedef struct model_info
 bool model_info_create(const assets_t *assets, SDL_IOStream *stream,
 	bool close_io, model_info_t *model);
 
+/**
+ * Parse directly from memory, for example an asset view,
+ * data only needs to be valid until this returns
+ */
+bool model_info_create_mem(const assets_t *assets, const void *data,
+	size_t size, model_info_t *model);
+
+/**
+ * Read the glTF file and all its buffers in a single batch before parsing,
+ * using the dependencies recorded by chirp-pack, see modeldeps.h
+ */
+bool model_info_create_preloaded(const assets_t *assets, const char *name, model_info_t *model);
+
+/**
+ * Parse a glTF file on disk, with buffers read relative to it,
+ * used when cooking models ahead of time
+ */
+bool model_info_create_file(const char *path, model_info_t *model);
+
+/**
+ * Target ratios of triangles for simplified levels of detail generated when loading glTF models,
+ * in decreasing order, defaults to 0.5, 0.25 and 0.125,
+ * should only be changed while no models are loading
+ * @param count Up to mesh_max_lods, or 0 to not generate any
+ */
+[[nodiscard]]
+bool model_info_set_lod_ratios(const float *ratios, size_t count);
+
+/**
+ * @param ratios Filled with the current ratios, up to mesh_max_lods
+ * @returns Number of ratios
+ */
+[[nodiscard]]
+size_t model_info_lod_ratios(float *ratios);
+
+/**
+ * Decode primitives of models with at least min_vertex_count vertices in total on the pool,
+ * with the loading thread helping, or always on the loading thread if pool is nullptr,
+ * min_vertex_count should only be changed while no models are loading
+ */
+void model_info_set_thread_pool(thread_pool_t *pool, size_t min_vertex_count);
+
 void model_info_destroy(model_info_t *model);
 
+/**
+ * Free vertex and index data once it's no longer needed, for example after upload,
+ * counts and clusters are kept
+ */
+void model_info_free_vertices(model_info_t *model);
+
+/**
+ * Size of each index, 16-bit when every vertex can be indexed with it, otherwise 32-bit
+ */
+[[nodiscard]]
+size_t mesh_primitive_index_size(size_t vertex_count);
+
+/**
+ * Number of indices including all levels of detail, as stored in indices
+ */
+[[nodiscard]]
+size_t mesh_primitive_stored_index_count(const mesh_primitive_t *primitive);
+
+/**
+ * Update bounds from the current vertices
+ */
+void mesh_primitive_update_bounds(mesh_primitive_t *primitive);
+
 [[nodiscard]]
 const char *model_node_name(const model_info_t *model, size_t index);
 
@@ -67,3 +205,9 @@ matrix4x4_t model_node_world_transform(const model_info_t *model, size_t index);
 
 [[nodiscard]]
 vector3f_t model_node_translation(const model_info_t *model, size_t index);
+
+[[nodiscard]]
+const char *model_camera_name(const model_info_t *model, size_t index);
+
+[[nodiscard]]
+bool model_info_add_camera(model_info_t *model, const char *name);
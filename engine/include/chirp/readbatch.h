@@ -0,0 +1,47 @@
+#pragma once
+
+#include "chirp/filereader.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+/**
+ * Set to 0 to read one request at a time, even where io_uring is available,
+ * read when a batch is submitted
+ */
+#define READ_BATCH_HINT_IO_URING "CHIRP_IO_URING"
+
+/**
+ * Several reads from the same file, submitted together and completed in any order,
+ * uses io_uring where available, otherwise positional reads one at a time
+ */
+typedef struct read_batch read_batch_t;
+
+typedef struct read_request
+{
+	void *dst;
+	size_t size;
+	Uint64 offset;
+} read_request_t;
+
+/**
+ * Start reading all requests, without waiting for any of them to finish
+ * @param requests Has to stay valid until the batch is destroyed
+ */
+[[nodiscard]]
+read_batch_t *read_batch_submit(const file_reader_t *reader,
+	const read_request_t *requests, size_t count);
+
+/**
+ * Wait for the next request to finish
+ * @param request Set to the finished request, or nullptr once all requests are finished
+ * @returns false if a read failed
+ */
+[[nodiscard]]
+bool read_batch_wait(read_batch_t *batch, const read_request_t **request);
+
+/**
+ * Wait for any reads still in flight, then free the batch
+ */
+void read_batch_destroy(read_batch_t *batch);
@@ -0,0 +1,20 @@
+#pragma once
+
+typedef struct thread_pool thread_pool_t;
+
+typedef void (*thread_pool_job_t)(void *userdata);
+
+/**
+ * Create worker threads that run jobs in the order they were submitted
+ * @param thread_count Number of threads, or 0 to base it on the number of cores
+ */
+[[nodiscard]]
+thread_pool_t *thread_pool_create(const char *name, int thread_count);
+
+/**
+ * Finish all submitted jobs, then stop all threads
+ */
+void thread_pool_destroy(thread_pool_t *pool);
+
+[[nodiscard]]
+bool thread_pool_submit(thread_pool_t *pool, thread_pool_job_t job, void *userdata);
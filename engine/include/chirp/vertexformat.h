@@ -0,0 +1,60 @@
+#pragma once
+
+#include "chirp/matrix.h"
+#include "chirp/modelinfo.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+/**
+ * Layout of vertices in GPU buffers
+ */
+typedef enum : Uint8
+{
+	VERTEX_FORMAT_FLOAT,     // primitive_vertex_t as is
+	VERTEX_FORMAT_QUANTIZED, // quantized_vertex_t
+} vertex_format_t;
+
+typedef struct quantized_vertex
+{
+	// Signed normalized within the bounds of the primitive, last component is padding
+	Sint16 position[4];
+
+	// Signed normalized, last component is padding,
+	// so shaders read it the same way as float normals
+	Sint16 normal[4];
+
+	// Half precision floats, so repeating textures still work
+	Uint16 tex_coord[2];
+} quantized_vertex_t;
+
+static_assert(sizeof(quantized_vertex_t) == 20);
+
+/**
+ * Size of a single vertex in the format
+ */
+[[nodiscard]]
+size_t vertex_format_size(vertex_format_t format);
+
+/**
+ * Convert vertices to the format, positions are relative to the bounds of the primitive
+ * @param destination vertex_format_size(format) * vertex_count bytes
+ */
+void vertex_format_encode(vertex_format_t format, const mesh_primitive_t *primitive,
+	const primitive_vertex_t *vertices, void *destination);
+
+/**
+ * Transform from encoded positions back to model space, identity for float vertices
+ */
+[[nodiscard]]
+matrix4x4_t vertex_format_dequantize(vertex_format_t format, const mesh_primitive_t *primitive);
+
+/**
+ * Round to the nearest half precision float, values too large become infinity
+ */
+[[nodiscard]]
+Uint16 vertex_half_from_float(float value);
+
+[[nodiscard]]
+float vertex_half_to_float(Uint16 value);
@@ -0,0 +1,262 @@
+#include "chirp/assetcache.h"
+#include "chirp/logcategory.h"
+
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct asset_cache_entry
+{
+	Uint32 key;
+	Uint32 refs;
+	Uint64 last_used;
+	void *data;
+	size_t size;
+	asset_cache_free_t free_data;
+} asset_cache_entry_t;
+
+struct asset_cache
+{
+	SDL_Mutex *mutex;
+
+	// Sorted by key
+	asset_cache_entry_t *entries;
+	Uint32 entry_count;
+	Uint32 entry_capacity;
+
+	size_t size;
+	size_t budget;
+
+	// Incremented on each use, to find the least recently used entry
+	Uint64 clock;
+
+	Uint64 hits;
+	Uint64 misses;
+	Uint64 evictions;
+};
+
+asset_cache_t *asset_cache_create(const size_t budget)
+{
+	asset_cache_t *cache = SDL_calloc(1, sizeof(asset_cache_t));
+	if (cache == nullptr)
+	{
+		return nullptr;
+	}
+
+	cache->mutex = SDL_CreateMutex();
+	if (cache->mutex == nullptr)
+	{
+		SDL_free(cache);
+		return nullptr;
+	}
+
+	cache->budget = budget;
+	return cache;
+}
+
+void asset_cache_destroy(asset_cache_t *cache)
+{
+	if (cache == nullptr)
+	{
+		return;
+	}
+
+	for (Uint32 i = 0; i < cache->entry_count; i++)
+	{
+		const asset_cache_entry_t *entry = cache->entries + i;
+		entry->free_data(entry->data);
+	}
+
+	SDL_free(cache->entries);
+	SDL_DestroyMutex(cache->mutex);
+	SDL_free(cache);
+}
+
+/**
+ * @returns Index of the entry, or where it should be inserted
+ */
+[[nodiscard]]
+static Uint32 find_entry(const asset_cache_t *cache, const Uint32 key)
+{
+	Uint32 low = 0;
+	Uint32 high = cache->entry_count;
+
+	while (low < high)
+	{
+		const Uint32 mid = low + ((high - low) / 2);
+
+		if (cache->entries[mid].key < key)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+[[nodiscard]]
+static bool has_entry(const asset_cache_t *cache, const Uint32 index, const Uint32 key)
+{
+	return index < cache->entry_count && cache->entries[index].key == key;
+}
+
+static void remove_entry(asset_cache_t *cache, const Uint32 index)
+{
+	const asset_cache_entry_t entry = cache->entries[index];
+
+	SDL_memmove(cache->entries + index, cache->entries + index + 1,
+		sizeof(asset_cache_entry_t) * (cache->entry_count - index - 1));
+
+	cache->entry_count--;
+	cache->size -= entry.size;
+
+	entry.free_data(entry.data);
+}
+
+static void evict(asset_cache_t *cache)
+{
+	while (cache->size > cache->budget)
+	{
+		Uint32 oldest = cache->entry_count;
+
+		for (Uint32 i = 0; i < cache->entry_count; i++)
+		{
+			const asset_cache_entry_t *entry = cache->entries + i;
+			if (entry->refs == 0
+				&& (oldest == cache->entry_count || entry->last_used < cache->entries[oldest].last_used))
+			{
+				oldest = i;
+			}
+		}
+
+		// Everything left is still in use
+		if (oldest == cache->entry_count)
+		{
+			return;
+		}
+
+		SDL_LogDebug(LOG_CATEGORY_ASSETS, "Evicting %x from cache (%zu bytes)",
+			cache->entries[oldest].key, cache->entries[oldest].size);
+
+		remove_entry(cache, oldest);
+		cache->evictions++;
+	}
+}
+
+void *asset_cache_acquire(asset_cache_t *cache, const Uint32 key)
+{
+	SDL_LockMutex(cache->mutex);
+
+	const Uint32 index = find_entry(cache, key);
+	if (!has_entry(cache, index, key))
+	{
+		cache->misses++;
+		SDL_UnlockMutex(cache->mutex);
+		return nullptr;
+	}
+
+	asset_cache_entry_t *entry = cache->entries + index;
+	entry->refs++;
+	entry->last_used = ++cache->clock;
+	cache->hits++;
+
+	void *data = entry->data;
+	SDL_UnlockMutex(cache->mutex);
+
+	return data;
+}
+
+void *asset_cache_insert(asset_cache_t *cache, const Uint32 key,
+	void *data, const size_t size, const asset_cache_free_t free_data)
+{
+	SDL_LockMutex(cache->mutex);
+
+	const Uint32 index = find_entry(cache, key);
+
+	// Loaded by someone else at the same time
+	if (has_entry(cache, index, key))
+	{
+		asset_cache_entry_t *entry = cache->entries + index;
+		entry->refs++;
+		entry->last_used = ++cache->clock;
+
+		void *cached = entry->data;
+		SDL_UnlockMutex(cache->mutex);
+
+		free_data(data);
+		return cached;
+	}
+
+	if (cache->entry_count == cache->entry_capacity)
+	{
+		const Uint32 capacity = cache->entry_capacity > 0 ? cache->entry_capacity * 2 : 16;
+		asset_cache_entry_t *entries = SDL_realloc(cache->entries,
+			sizeof(asset_cache_entry_t) * capacity);
+
+		if (entries == nullptr)
+		{
+			SDL_UnlockMutex(cache->mutex);
+			return nullptr;
+		}
+
+		cache->entries = entries;
+		cache->entry_capacity = capacity;
+	}
+
+	SDL_memmove(cache->entries + index + 1, cache->entries + index,
+		sizeof(asset_cache_entry_t) * (cache->entry_count - index));
+
+	cache->entries[index] = (asset_cache_entry_t){
+		.key = key,
+		.refs = 1,
+		.last_used = ++cache->clock,
+		.data = data,
+		.size = size,
+		.free_data = free_data,
+	};
+
+	cache->entry_count++;
+	cache->size += size;
+
+	evict(cache);
+
+	SDL_UnlockMutex(cache->mutex);
+	return data;
+}
+
+void asset_cache_release(asset_cache_t *cache, const Uint32 key)
+{
+	SDL_LockMutex(cache->mutex);
+
+	const Uint32 index = find_entry(cache, key);
+	if (has_entry(cache, index, key) && cache->entries[index].refs > 0)
+	{
+		cache->entries[index].refs--;
+		evict(cache);
+	}
+
+	SDL_UnlockMutex(cache->mutex);
+}
+
+asset_cache_stats_t asset_cache_stats(asset_cache_t *cache)
+{
+	SDL_LockMutex(cache->mutex);
+
+	const asset_cache_stats_t stats = {
+		.size = cache->size,
+		.budget = cache->budget,
+		.entry_count = cache->entry_count,
+		.hits = cache->hits,
+		.misses = cache->misses,
+		.evictions = cache->evictions,
+	};
+
+	SDL_UnlockMutex(cache->mutex);
+	return stats;
+}
@@ -0,0 +1,152 @@
+#include "chirp/assetloader.h"
+#include "chirp/assets.h"
+#include "chirp/threadpool.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct asset_request
+{
+	asset_loader_t *loader;
+	asset_job_t job;
+	asset_job_done_t done;
+	void *userdata;
+
+	bool success;
+	// Errors are per thread, so they're copied back to the polling thread
+	char *error;
+
+	struct asset_request *next;
+} asset_request_t;
+
+struct asset_loader
+{
+	// Not owned, so later changes, like starting a trace, are seen by the workers
+	const assets_t *assets;
+	thread_pool_t *pool;
+
+	SDL_Mutex *mutex;
+	asset_request_t *first_done;
+	asset_request_t *last_done;
+};
+
+static void run_request(void *userdata)
+{
+	asset_request_t *request = userdata;
+	asset_loader_t *loader = request->loader;
+
+	request->success = request->job(loader->assets, request->userdata);
+	if (!request->success)
+	{
+		request->error = SDL_strdup(SDL_GetError());
+	}
+
+	SDL_LockMutex(loader->mutex);
+
+	if (loader->last_done != nullptr)
+	{
+		loader->last_done->next = request;
+	}
+	else
+	{
+		loader->first_done = request;
+	}
+	loader->last_done = request;
+
+	SDL_UnlockMutex(loader->mutex);
+}
+
+asset_loader_t *asset_loader_create(const assets_t *assets, const int thread_count)
+{
+	asset_loader_t *loader = SDL_calloc(1, sizeof(asset_loader_t));
+	if (loader == nullptr)
+	{
+		return nullptr;
+	}
+
+	loader->assets = assets;
+	loader->mutex = SDL_CreateMutex();
+	loader->pool = thread_pool_create("assets", thread_count);
+
+	if (loader->mutex == nullptr || loader->pool == nullptr)
+	{
+		asset_loader_destroy(loader);
+		return nullptr;
+	}
+
+	return loader;
+}
+
+void asset_loader_destroy(asset_loader_t *loader)
+{
+	if (loader == nullptr)
+	{
+		return;
+	}
+
+	thread_pool_destroy(loader->pool);
+
+	if (loader->mutex != nullptr)
+	{
+		asset_loader_poll(loader);
+	}
+
+	SDL_DestroyMutex(loader->mutex);
+	SDL_free(loader);
+}
+
+thread_pool_t *asset_loader_thread_pool(const asset_loader_t *loader)
+{
+	return loader->pool;
+}
+
+bool asset_loader_submit(asset_loader_t *loader, const asset_job_t job,
+	const asset_job_done_t done, void *userdata)
+{
+	asset_request_t *request = SDL_calloc(1, sizeof(asset_request_t));
+	if (request == nullptr)
+	{
+		return false;
+	}
+
+	request->loader = loader;
+	request->job = job;
+	request->done = done;
+	request->userdata = userdata;
+
+	if (!thread_pool_submit(loader->pool, run_request, request))
+	{
+		SDL_free(request);
+		return false;
+	}
+
+	return true;
+}
+
+void asset_loader_poll(asset_loader_t *loader)
+{
+	SDL_LockMutex(loader->mutex);
+	asset_request_t *request = loader->first_done;
+	loader->first_done = nullptr;
+	loader->last_done = nullptr;
+	SDL_UnlockMutex(loader->mutex);
+
+	while (request != nullptr)
+	{
+		asset_request_t *next = request->next;
+
+		if (!request->success)
+		{
+			SDL_SetError("%s", request->error != nullptr ? request->error : "Unknown error");
+		}
+
+		request->done(request->success, request->userdata);
+
+		SDL_free(request->error);
+		SDL_free(request);
+		request = next;
+	}
+}
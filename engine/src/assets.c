@@ -1,6 +1,11 @@
 #include "chirp/assets.h"
 #include "chirp/array.h"
 #include "chirp/assetstream.h"
+#include "chirp/assettrace.h"
+#include "chirp/blockcache.h"
+#include "chirp/diskcache.h"
+#include "chirp/filemap.h"
+#include "chirp/filereader.h"
 #include "chirp/gamepadaxis.h"
 #include "chirp/gamepadbutton.h"
 #include "chirp/gamepadbuttonlabel.h"
@@ -8,12 +13,13 @@
 #include "chirp/inputconfig.h"
 #include "chirp/json.h"
 #include "chirp/logcategory.h"
-#include "chirp/map.h"
 #include "chirp/mousebutton.h"
+#include "chirp/readbatch.h"
 #include "chirp/windowconfig.h"
 
 #include <SDL3/SDL_error.h>
 #include <SDL3/SDL_gamepad.h>
+#include <SDL3/SDL_hints.h>
 #include <SDL3/SDL_init.h>
 #include <SDL3/SDL_iostream.h>
 #include <SDL3/SDL_keyboard.h>
@@ -22,15 +28,60 @@
 #include <SDL3/SDL_mutex.h>
 #include <SDL3/SDL_stdinc.h>
 
-typedef struct
+typedef struct file_descriptor
 {
+	Uint32 hash;
 	Uint16 flags;
-	Uint32 offset;
-	Uint32 size;
+	Uint64 offset;
+	Uint64 size;
+	// Hash of the contents before compression, 0 if unknown
+	Uint32 content_hash;
 } file_descriptor_t;
 
-// Supported version of nest
-static constexpr Uint8 nest_version = 1;
+// Size of each descriptor as stored in the archive
+static constexpr size_t packed_descriptor_size_v1 = 14;
+static constexpr size_t packed_descriptor_size_v2 = 24;
+static constexpr size_t packed_descriptor_size_v3 = 32;
+
+// Supported versions of nest
+static constexpr Uint8 nest_version_min = 1;
+static constexpr Uint8 nest_version_max = 3;
+
+// Largest payload alignment allowed in version 2, 64 KiB
+static constexpr Uint8 max_alignment_log2 = 16;
+
+// Flags this version knows how to handle
+static constexpr Uint16 known_flags = asset_flag_compressed | asset_flag_gpu_ready | asset_flag_resident;
+
+// Block cache defaults, 64 blocks of 64 KiB
+static constexpr size_t default_block_size_kib = 64;
+static constexpr size_t default_block_count = 64;
+
+// Traced assets closer than this are prefetched as a single range, 64 KiB
+static constexpr Uint64 readahead_gap = 64 * 1024;
+
+// Largest resident region read when created, anything larger is read as usual, 64 MiB
+static constexpr Uint64 max_resident_size = 64 * 1024 * 1024;
+
+/**
+ * Where the block cache reads from, owned by the cache
+ */
+typedef struct archive_source
+{
+	file_reader_t reader;
+	// Only used without a reader
+	SDL_IOStream *stream;
+	SDL_Mutex *read_mutex;
+} archive_source_t;
+
+typedef struct readahead_list
+{
+	const assets_t *assets;
+	asset_range_t *ranges;
+	size_t count;
+	size_t capacity;
+	bool failed;
+} readahead_list_t;
 
 [[nodiscard]]
 static bool is_key(const char *json, const json_token_t *token, const char *key)
@@ -283,13 +334,8 @@ static bool parse_project(SDL_IOStream *stream,
 	size_t json_len = 0;
 	char *json = SDL_LoadFile_IO(stream, &json_len, true);
 
-	json_parser_t parser;
-	json_init(&parser);
-
-	constexpr size_t token_count = 256;
-	json_token_t tokens[token_count];
-
-	const int count = json_parse(&parser, json, json_len, tokens, token_count);
+	json_token_t *tokens = nullptr;
+	const int count = json_tokenize(json, json_len, &tokens);
 
 	if (count == JSON_ERROR_OOM)
 	{
@@ -335,130 +381,824 @@ static bool parse_project(SDL_IOStream *stream,
 		}
 	}
 
+	SDL_free(tokens);
 	SDL_free(json);
 	return true;
 }
 
 #undef token_str
 
-SDL_IOStream *assets_load(const assets_t *assets, const char *name)
+Uint32 assets_hash(const char *name)
 {
 	const size_t path_len = SDL_strlen(name);
-	const Uint32 hash = SDL_murmur3_32(name, path_len, path_len);
+	return SDL_murmur3_32(name, path_len, path_len);
+}
+
+[[nodiscard]]
+static const file_descriptor_t *search_descriptor(const assets_t *assets, const Uint32 hash)
+{
+	// Descriptors are always sorted by hash
+	size_t low = 0;
+	size_t high = assets->desc_count;
+
+	while (low < high)
+	{
+		const size_t mid = low + ((high - low) / 2);
+		const file_descriptor_t *desc = assets->desc + mid;
 
-	static constexpr size_t hash_str_len = 9;
-	char hash_str[hash_str_len];
-	SDL_snprintf(hash_str, hash_str_len, "%x", hash);
+		if (desc->hash == hash)
+		{
+			return desc;
+		}
+
+		if (desc->hash < hash)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	return nullptr;
+}
 
-	const file_descriptor_t *desc = map_get(assets->desc, hash_str, nullptr);
+[[nodiscard]]
+static const file_descriptor_t *find_descriptor(const assets_t *assets, const char *name)
+{
+	const file_descriptor_t *desc = search_descriptor(assets, assets_hash(name));
 	if (desc == nullptr)
 	{
 		SDL_SetError("Asset not found: %s", name);
-		return nullptr;
+	}
+
+	return desc;
+}
+
+bool assets_exists(const assets_t *assets, const char *name)
+{
+	return search_descriptor(assets, assets_hash(name)) != nullptr;
+}
+
+bool assets_content_hash(const assets_t *assets, const char *name, Uint32 *hash)
+{
+	const file_descriptor_t *desc = find_descriptor(assets, name);
+	if (desc == nullptr)
+	{
+		return false;
+	}
+
+	if (desc->content_hash == 0)
+	{
+		return SDL_SetError("Archive has no content hashes");
+	}
+
+	*hash = desc->content_hash;
+	return true;
+}
+
+static void record_access(const assets_t *assets, const char *name, const file_descriptor_t *desc)
+{
+	if (assets->trace != nullptr)
+	{
+		asset_trace_add(assets->trace, name, desc->offset, desc->size);
+	}
+}
+
+/**
+ * Asset data if it's already in memory, either mapped or resident
+ */
+[[nodiscard]]
+static const Uint8 *asset_memory(const assets_t *assets, const file_descriptor_t *desc)
+{
+	if (assets->map.data != nullptr)
+	{
+		return assets->map.data + desc->offset;
+	}
+
+	if (assets->resident != nullptr
+		&& (desc->flags & asset_flag_resident) != 0
+		&& desc->offset >= assets->resident_offset
+		&& desc->offset + desc->size <= assets->resident_offset + assets->resident_size)
+	{
+		return assets->resident + (desc->offset - assets->resident_offset);
+	}
+
+	return nullptr;
+}
+
+[[nodiscard]]
+static SDL_IOStream *open_asset(const assets_t *assets, const file_descriptor_t *desc)
+{
+	const Uint8 *memory = asset_memory(assets, desc);
+	if (memory != nullptr)
+	{
+		return SDL_IOFromConstMem(memory, desc->size);
+	}
+
+	if (assets->cache != nullptr)
+	{
+		return asset_stream_open_cached(assets->cache, desc->offset, desc->size);
+	}
+
+	if (assets->read_mutex == nullptr)
+	{
+		return asset_stream_open_reader(assets->reader, desc->offset, desc->size);
 	}
 
 	return asset_stream_open_io(assets->stream, assets->read_mutex,
 		desc->offset, desc->size);
 }
 
-[[nodiscard]]
-static bool validate_header(SDL_IOStream *stream)
+SDL_IOStream *assets_load(const assets_t *assets, const char *name)
 {
-	char magic[5] = {0};
-	if (!SDL_ReadU32LE(stream, (Uint32*) &magic))
+	const file_descriptor_t *desc = find_descriptor(assets, name);
+	if (desc == nullptr)
+	{
+		return nullptr;
+	}
+
+	record_access(assets, name, desc);
+
+	SDL_IOStream *stream = open_asset(assets, desc);
+
+	if ((desc->flags & asset_flag_compressed) != 0)
+	{
+		return asset_stream_open_compressed(stream);
+	}
+
+	return stream;
+}
+
+bool assets_view(const assets_t *assets, const char *name, asset_view_t *view)
+{
+	if (assets->map.data == nullptr && assets->resident == nullptr)
+	{
+		return SDL_SetError("Assets are not memory mapped");
+	}
+
+	const file_descriptor_t *desc = find_descriptor(assets, name);
+	if (desc == nullptr)
 	{
 		return false;
 	}
 
-	if (SDL_strcmp(magic, "nest") != 0)
+	if ((desc->flags & asset_flag_compressed) != 0)
 	{
-		return SDL_SetError("Invalid nest file");
+		return SDL_SetError("Asset is compressed: %s", name);
 	}
 
-	Uint8 version;
-	if (!SDL_ReadU8(stream, &version))
+	const Uint8 *memory = asset_memory(assets, desc);
+	if (memory == nullptr)
+	{
+		return SDL_SetError("Asset is not resident: %s", name);
+	}
+
+	record_access(assets, name, desc);
+
+	view->data = memory;
+	view->size = desc->size;
+
+	return true;
+}
+
+[[nodiscard]]
+static bool loaded_size(const assets_t *assets, const file_descriptor_t *desc, size_t *size)
+{
+	if ((desc->flags & asset_flag_compressed) == 0)
+	{
+		*size = desc->size;
+		return true;
+	}
+
+	// Size before compression is only stored in the payload
+	SDL_IOStream *stream = asset_stream_open_compressed(open_asset(assets, desc));
+	if (stream == nullptr)
 	{
 		return false;
 	}
 
-	if (version != nest_version)
+	const Sint64 raw_size = SDL_GetIOSize(stream);
+	SDL_CloseIO(stream);
+
+	if (raw_size < 0)
 	{
-		return SDL_SetError("Unsupported nest version");
+		return false;
 	}
 
+	*size = (size_t) raw_size;
 	return true;
 }
 
-bool assets_create(const char *path, const input_t input, assets_t *assets)
+bool assets_size(const assets_t *assets, const char *name, size_t *size)
+{
+	const file_descriptor_t *desc = find_descriptor(assets, name);
+	if (desc == nullptr)
+	{
+		return false;
+	}
+
+	return loaded_size(assets, desc, size);
+}
+
+[[nodiscard]]
+static bool read_stream(SDL_IOStream *stream, void *dst, const size_t size)
 {
-	SDL_IOStream *stream = SDL_IOFromFile(path, "rb");
 	if (stream == nullptr)
 	{
 		return false;
 	}
 
-	if (!validate_header(stream))
+	const bool result = SDL_ReadIO(stream, dst, size) == size;
+	SDL_CloseIO(stream);
+
+	return result;
+}
+
+bool assets_read(const assets_t *assets, const char *name, void *dst, const size_t size)
+{
+	const file_descriptor_t *desc = find_descriptor(assets, name);
+	if (desc == nullptr)
 	{
-		SDL_CloseIO(stream);
 		return false;
 	}
 
-	Uint32 file_count = 0;
-	if (!SDL_ReadU32LE(stream, &file_count))
+	size_t asset_size = 0;
+	if (!loaded_size(assets, desc, &asset_size))
 	{
-		SDL_CloseIO(stream);
 		return false;
 	}
 
-	assets->stream = stream;
-	assets->read_mutex = SDL_CreateMutex();
-	assets->window_config = window_config_default();
-	assets->desc = map_create();
+	if (asset_size != size)
+	{
+		return SDL_SetError("Asset %s is %zu bytes, expected %zu", name, asset_size, size);
+	}
+
+	record_access(assets, name, desc);
 
+	if ((desc->flags & asset_flag_compressed) != 0)
+	{
+		return read_stream(asset_stream_open_compressed(open_asset(assets, desc)), dst, size);
+	}
+
+	const Uint8 *memory = asset_memory(assets, desc);
+	if (memory != nullptr)
+	{
+		SDL_memcpy(dst, memory, size);
+		return true;
+	}
+
+	// Straight into dst, without going through a stream
 	if (assets->read_mutex == nullptr)
 	{
-		assets_destroy(assets);
-		return false;
+		if (file_reader_read_at(&assets->reader, dst, size, desc->offset) != size)
+		{
+			return SDL_SetError("Failed to read %s", name);
+		}
+		return true;
 	}
 
-	if (assets->desc == 0)
+	return read_stream(open_asset(assets, desc), dst, size);
+}
+
+/**
+ * Only uncompressed assets read using positional reads can be batched,
+ * anything else is read like assets_read, or copied if already in memory
+ */
+[[nodiscard]]
+static bool can_batch(const assets_t *assets, const file_descriptor_t *desc)
+{
+	return asset_memory(assets, desc) == nullptr
+		&& assets->read_mutex == nullptr
+		&& (desc->flags & asset_flag_compressed) == 0;
+}
+
+bool assets_read_batch(const assets_t *assets, const asset_read_t *reads, const size_t count)
+{
+	if (count == 0)
+	{
+		return true;
+	}
+
+	read_request_t *requests = SDL_malloc(sizeof(read_request_t) * count);
+	if (requests == nullptr)
 	{
-		assets_destroy(assets);
 		return false;
 	}
 
-	for (Uint32 i = 0; i < file_count; i++)
+	size_t request_count = 0;
+
+	for (size_t i = 0; i < count; i++)
 	{
-		Uint32 hash;
-		file_descriptor_t *descriptor = SDL_malloc(sizeof(file_descriptor_t));
+		const asset_read_t *read = reads + i;
 
-		if (!SDL_ReadU32LE(stream, &hash)
-			|| !SDL_ReadU16LE(stream, &descriptor->flags)
-			|| !SDL_ReadU32LE(stream, &descriptor->offset)
-			|| !SDL_ReadU32LE(stream, &descriptor->size))
+		const file_descriptor_t *desc = find_descriptor(assets, read->name);
+		if (desc == nullptr)
 		{
-			assets_destroy(assets);
+			SDL_free(requests);
 			return false;
 		}
 
-		if (descriptor->flags != 0)
+		if (!can_batch(assets, desc))
 		{
-			SDL_SetError("Unknown flag: %d", descriptor->flags);
-			assets_destroy(assets);
-			return false;
+			continue;
 		}
 
-		static constexpr size_t hash_str_len = 9;
-		char hash_str[hash_str_len];
-		SDL_snprintf(hash_str, hash_str_len, "%x", hash);
+		if (desc->size != read->size)
+		{
+			SDL_free(requests);
+			return SDL_SetError("Asset %s is %" SDL_PRIu64 " bytes, expected %zu",
+				read->name, desc->size, read->size);
+		}
+
+		record_access(assets, read->name, desc);
+
+		requests[request_count++] = (read_request_t){
+			.dst = read->dst,
+			.size = read->size,
+			.offset = desc->offset,
+		};
+	}
+
+	read_batch_t *batch = nullptr;
 
-		if (!map_set_with_cleanup(assets->desc, hash_str, descriptor, SDL_free))
+	if (request_count > 0)
+	{
+		batch = read_batch_submit(&assets->reader, requests, request_count);
+		if (batch == nullptr)
 		{
-			assets_destroy(assets);
+			SDL_free(requests);
 			return false;
 		}
 	}
 
+	bool result = true;
+
+	// Decompress the rest while the batch is being read
+	for (size_t i = 0; i < count && result; i++)
+	{
+		if (!can_batch(assets, find_descriptor(assets, reads[i].name)))
+		{
+			result = assets_read(assets, reads[i].name, reads[i].dst, reads[i].size);
+		}
+	}
+
+	const read_request_t *request = nullptr;
+
+	while (result && batch != nullptr)
+	{
+		result = read_batch_wait(batch, &request);
+		if (request == nullptr)
+		{
+			break;
+		}
+	}
+
+	read_batch_destroy(batch);
+	SDL_free(requests);
+
+	return result;
+}
+
+[[nodiscard]]
+static bool validate_header(SDL_IOStream *stream, Uint8 *version)
+{
+	char magic[5] = {0};
+	if (!SDL_ReadU32LE(stream, (Uint32*) &magic))
+	{
+		return false;
+	}
+
+	if (SDL_strcmp(magic, "nest") != 0)
+	{
+		return SDL_SetError("Invalid nest file");
+	}
+
+	if (!SDL_ReadU8(stream, version))
+	{
+		return false;
+	}
+
+	if (*version < nest_version_min || *version > nest_version_max)
+	{
+		return SDL_SetError("Unsupported nest version: %d", *version);
+	}
+
+	return true;
+}
+
+/**
+ * Payload alignment, only stored in version 2 and later
+ */
+[[nodiscard]]
+static bool read_alignment(SDL_IOStream *stream, const Uint8 version, Uint32 *alignment)
+{
+	*alignment = 1;
+
+	if (version < 2)
+	{
+		return true;
+	}
+
+	Uint8 alignment_log2;
+	if (!SDL_ReadU8(stream, &alignment_log2))
+	{
+		return false;
+	}
+
+	if (alignment_log2 > max_alignment_log2)
+	{
+		return SDL_SetError("Unsupported alignment: 2^%d", alignment_log2);
+	}
+
+	*alignment = (Uint32) 1 << alignment_log2;
+	return true;
+}
+
+static int compare_descriptors(const void *a, const void *b)
+{
+	const Uint32 hash_a = ((const file_descriptor_t*) a)->hash;
+	const Uint32 hash_b = ((const file_descriptor_t*) b)->hash;
+
+	return (hash_a > hash_b) - (hash_a < hash_b);
+}
+
+[[nodiscard]]
+static Uint32 read_packed_u32(const Uint8 *data)
+{
+	Uint32 value;
+	SDL_memcpy(&value, data, sizeof(value));
+	return SDL_Swap32LE(value);
+}
+
+[[nodiscard]]
+static Uint64 read_packed_u64(const Uint8 *data)
+{
+	Uint64 value;
+	SDL_memcpy(&value, data, sizeof(value));
+	return SDL_Swap64LE(value);
+}
+
+[[nodiscard]]
+static Uint16 read_packed_u16(const Uint8 *data)
+{
+	Uint16 value;
+	SDL_memcpy(&value, data, sizeof(value));
+	return SDL_Swap16LE(value);
+}
+
+static void read_packed_descriptor(const Uint8 *data, const Uint8 version,
+	file_descriptor_t *descriptor)
+{
+	descriptor->hash = read_packed_u32(data);
+	descriptor->flags = read_packed_u16(data + 4);
+
+	if (version < 2)
+	{
+		descriptor->offset = read_packed_u32(data + 6);
+		descriptor->size = read_packed_u32(data + 10);
+	}
+	else
+	{
+		// Two reserved bytes to keep the 64-bit values aligned
+		descriptor->offset = read_packed_u64(data + 8);
+		descriptor->size = read_packed_u64(data + 16);
+	}
+
+	// Only stored in version 3 and later, followed by four reserved bytes
+	descriptor->content_hash = version < 3 ? 0 : read_packed_u32(data + 24);
+}
+
+/**
+ * Read the entire directory in a single read into a flat table sorted by hash
+ */
+static bool read_descriptors(SDL_IOStream *stream, const Uint8 version, const Uint32 file_count,
+	const Uint32 alignment, const Uint64 archive_size, assets_t *assets)
+{
+	const size_t descriptor_size = version < 2
+		? packed_descriptor_size_v1
+		: version < 3
+		? packed_descriptor_size_v2
+		: packed_descriptor_size_v3;
+
+	const size_t packed_size = descriptor_size * file_count;
+
+	if (archive_size > 0 && packed_size > archive_size)
+	{
+		return SDL_SetError("Invalid file count: %u", file_count);
+	}
+
+	Uint8 *packed = SDL_malloc(packed_size);
+	assets->desc = SDL_malloc(sizeof(file_descriptor_t) * file_count);
+
+	if (packed == nullptr || assets->desc == nullptr)
+	{
+		SDL_free(packed);
+		return false;
+	}
+
+	if (SDL_ReadIO(stream, packed, packed_size) != packed_size)
+	{
+		SDL_free(packed);
+		return SDL_SetError("Failed to read file descriptors");
+	}
+
+	bool sorted = true;
+
+	for (Uint32 i = 0; i < file_count; i++)
+	{
+		file_descriptor_t *descriptor = assets->desc + i;
+		read_packed_descriptor(packed + (i * descriptor_size), version, descriptor);
+
+		if ((descriptor->flags & ~known_flags) != 0)
+		{
+			SDL_free(packed);
+			return SDL_SetError("Unknown flag: %d", descriptor->flags);
+		}
+
+		if (archive_size > 0
+			&& (descriptor->size > archive_size
+				|| descriptor->offset > archive_size - descriptor->size))
+		{
+			SDL_free(packed);
+			return SDL_SetError("File %x is out of bounds", descriptor->hash);
+		}
+
+		if (descriptor->offset % alignment != 0)
+		{
+			SDL_free(packed);
+			return SDL_SetError("File %x is not aligned to %u bytes", descriptor->hash, alignment);
+		}
+
+		if (i > 0 && descriptor->hash <= (descriptor - 1)->hash)
+		{
+			sorted = false;
+		}
+	}
+
+	SDL_free(packed);
+
+	assets->desc_count = file_count;
+
+	// Older packers don't sort the directory
+	if (!sorted)
+	{
+		SDL_qsort(assets->desc, file_count, sizeof(file_descriptor_t), compare_descriptors);
+	}
+
+	for (Uint32 i = 1; i < file_count; i++)
+	{
+		if (assets->desc[i].hash == assets->desc[i - 1].hash)
+		{
+			return SDL_SetError("Duplicate file: %x", assets->desc[i].hash);
+		}
+	}
+
+	SDL_LogDebug(LOG_CATEGORY_ASSETS, "Found %u files", file_count);
+	return true;
+}
+
+[[nodiscard]]
+static SDL_IOStream *open_archive(const char *path, file_map_t *map, file_reader_t *reader)
+{
+	*map = (file_map_t){};
+	*reader = (file_reader_t){};
+
+	if (!SDL_GetHintBoolean(ASSETS_HINT_MAP, true))
+	{
+		SDL_LogDebug(LOG_CATEGORY_ASSETS, "Memory mapping disabled");
+	}
+	else if (file_map_open(path, map))
+	{
+		SDL_LogDebug(LOG_CATEGORY_ASSETS, "Memory mapped %zu bytes", map->size);
+		return SDL_IOFromConstMem(map->data, map->size);
+	}
+	else
+	{
+		// Not fatal, just slower, and project parsing expects errors to be cleared
+		SDL_LogDebug(LOG_CATEGORY_ASSETS, "Memory mapping not available: %s", SDL_GetError());
+		SDL_ClearError();
+		*map = (file_map_t){};
+	}
+
+	if (!file_reader_open(path, reader))
+	{
+		SDL_LogDebug(LOG_CATEGORY_ASSETS, "Positional reads not available: %s", SDL_GetError());
+		SDL_ClearError();
+		*reader = (file_reader_t){};
+	}
+
+	return SDL_IOFromFile(path, "rb");
+}
+
+static size_t read_source(void *userdata, void *dst, const size_t size, const Uint64 offset)
+{
+	const archive_source_t *source = userdata;
+
+	if (source->stream == nullptr)
+	{
+		return file_reader_read_at(&source->reader, dst, size, offset);
+	}
+
+	SDL_LockMutex(source->read_mutex);
+
+	const size_t read = SDL_SeekIO(source->stream, (Sint64) offset, SDL_IO_SEEK_SET) >= 0
+		? SDL_ReadIO(source->stream, dst, size)
+		: 0;
+
+	SDL_UnlockMutex(source->read_mutex);
+	return read;
+}
+
+[[nodiscard]]
+static size_t hint_size(const char *name, const size_t default_value)
+{
+	const char *value = SDL_GetHint(name);
+	if (value == nullptr)
+	{
+		return default_value;
+	}
+
+	return (size_t) SDL_strtoul(value, nullptr, 10);
+}
+
+/**
+ * Small reads are otherwise a syscall each, memory mapped archives use the page cache instead
+ */
+static void create_block_cache(assets_t *assets, const Uint64 archive_size)
+{
+	const size_t block_size = hint_size(ASSETS_HINT_BLOCK_SIZE, default_block_size_kib) * 1024;
+	const size_t block_count = hint_size(ASSETS_HINT_BLOCK_COUNT, default_block_count);
+
+	if (assets->map.data != nullptr || block_count == 0 || archive_size == 0)
+	{
+		return;
+	}
+
+	archive_source_t *source = SDL_malloc(sizeof(archive_source_t));
+	if (source != nullptr)
+	{
+		*source = (archive_source_t){
+			.reader = assets->reader,
+			.stream = assets->read_mutex != nullptr ? assets->stream : nullptr,
+			.read_mutex = assets->read_mutex,
+		};
+
+		assets->cache = block_cache_create(block_size, block_count, archive_size, read_source, source);
+	}
+
+	// Not fatal, reads just go straight to the file instead
+	if (assets->cache == nullptr)
+	{
+		SDL_LogWarn(LOG_CATEGORY_ASSETS, "Block cache not available: %s", SDL_GetError());
+		SDL_ClearError();
+	}
+}
+
+/**
+ * Read all resident assets in a single read, if they're stored next to each other,
+ * not fatal if they can't be kept in memory, they're just read as usual instead
+ */
+[[nodiscard]]
+static bool load_resident(assets_t *assets)
+{
+	if (assets->map.data != nullptr)
+	{
+		return true;
+	}
+
+	Uint64 start = SDL_MAX_UINT64;
+	Uint64 end = 0;
+	Uint64 total = 0;
+
+	for (Uint32 i = 0; i < assets->desc_count; i++)
+	{
+		const file_descriptor_t *desc = assets->desc + i;
+		if ((desc->flags & asset_flag_resident) != 0)
+		{
+			start = SDL_min(start, desc->offset);
+			end = SDL_max(end, desc->offset + desc->size);
+			// Including padding up to the next aligned asset
+			total += ((desc->size + assets->alignment - 1) / assets->alignment) * assets->alignment;
+		}
+	}
+
+	if (end <= start)
+	{
+		return true;
+	}
+
+	// Packed in trace order, mixed with other assets, reading them all would read those too
+	if (end - start > total * 2)
+	{
+		SDL_LogDebug(LOG_CATEGORY_ASSETS, "Resident assets aren't stored together");
+		return true;
+	}
+
+	if (end - start > max_resident_size)
+	{
+		SDL_LogWarn(LOG_CATEGORY_ASSETS, "Resident assets too large: %" SDL_PRIu64 " bytes", end - start);
+		return true;
+	}
+
+	const size_t size = (size_t) (end - start);
+
+	Uint8 *resident = SDL_malloc(size);
+	if (resident == nullptr)
+	{
+		SDL_LogWarn(LOG_CATEGORY_ASSETS, "Resident assets not available: %s", SDL_GetError());
+		SDL_ClearError();
+		return true;
+	}
+
+	const archive_source_t source = {
+		.reader = assets->reader,
+		.stream = assets->read_mutex != nullptr ? assets->stream : nullptr,
+		.read_mutex = assets->read_mutex,
+	};
+
+	if (read_source((void*) &source, resident, size, start) != size)
+	{
+		SDL_free(resident);
+		return SDL_SetError("Failed to read resident assets");
+	}
+
+	assets->resident = resident;
+	assets->resident_offset = start;
+	assets->resident_size = size;
+
+	SDL_LogDebug(LOG_CATEGORY_ASSETS, "Read %zu bytes of resident assets", size);
+	return true;
+}
+
+bool assets_create(const char *path, const input_t input, assets_t *assets)
+{
+	file_map_t map;
+	file_reader_t reader;
+
+	SDL_IOStream *stream = open_archive(path, &map, &reader);
+	if (stream == nullptr)
+	{
+		file_map_close(&map);
+		file_reader_close(&reader);
+		return false;
+	}
+
+	Uint8 version = 0;
+	Uint32 alignment = 1;
+	Uint32 file_count = 0;
+
+	if (!validate_header(stream, &version)
+		|| !read_alignment(stream, version, &alignment)
+		|| !SDL_ReadU32LE(stream, &file_count))
+	{
+		SDL_CloseIO(stream);
+		file_map_close(&map);
+		file_reader_close(&reader);
+		return false;
+	}
+
+	const bool shared_stream = map.data == nullptr && !reader.is_open;
+	const Uint64 archive_size = map.data != nullptr ? map.size
+		: shared_stream ? (Uint64) SDL_max(SDL_GetIOSize(stream), 0)
+		: reader.size;
+
+	assets->stream = stream;
+	assets->map = map;
+	assets->reader = reader;
+	assets->window_config = window_config_default();
+	assets->desc = nullptr;
+	assets->desc_count = 0;
+	assets->alignment = alignment;
+	assets->trace = nullptr;
+	assets->readahead = nullptr;
+	assets->cache = nullptr;
+	assets->resident = nullptr;
+	assets->resident_offset = 0;
+	assets->resident_size = 0;
+	assets->disk_cache = nullptr;
+
+	// Only needed when all reads go through the same stream
+	assets->read_mutex = shared_stream
+		? SDL_CreateMutex()
+		: nullptr;
+
+	if (shared_stream && assets->read_mutex == nullptr)
+	{
+		assets_destroy(assets);
+		return false;
+	}
+
+	create_block_cache(assets, archive_size);
+
+	if (!read_descriptors(stream, version, file_count, alignment, archive_size, assets)
+		|| !load_resident(assets))
+	{
+		assets_destroy(assets);
+		return false;
+	}
+
 	if (!parse_project(assets_load(assets, "project"), assets, input))
 	{
 		assets_destroy(assets);
@@ -477,12 +1217,145 @@ void assets_destroy(const assets_t *assets)
 
 	SDL_free((void*) assets->window_config.title);
 
+	// Has to stop before the archive is closed
+	asset_readahead_stop(assets->readahead);
+	asset_trace_destroy(assets->trace);
+	disk_cache_destroy(assets->disk_cache);
+
+	block_cache_stats_t stats;
+	if (assets_block_cache_stats(assets, &stats))
+	{
+		SDL_LogDebug(LOG_CATEGORY_ASSETS,
+			"Block cache: %" SDL_PRIu64 " hits, %" SDL_PRIu64 " misses, %" SDL_PRIu64 " read ahead, %" SDL_PRIu64 " direct",
+			stats.hits, stats.misses, stats.readahead, stats.direct);
+	}
+	block_cache_destroy(assets->cache);
+
 	SDL_CloseIO(assets->stream);
 	SDL_DestroyMutex(assets->read_mutex);
-	map_destroy(assets->desc);
+	file_map_close(&assets->map);
+	file_reader_close(&assets->reader);
+	SDL_free(assets->desc);
+	SDL_free(assets->resident);
 }
 
 window_config_t assets_window_config(const assets_t *assets)
 {
 	return assets->window_config;
 }
+
+bool assets_block_cache_stats(const assets_t *assets, block_cache_stats_t *stats)
+{
+	if (assets->cache == nullptr)
+	{
+		return false;
+	}
+
+	*stats = block_cache_stats(assets->cache);
+	return true;
+}
+
+bool assets_record_trace(assets_t *assets, const char *path)
+{
+	asset_trace_t *trace = asset_trace_create(path);
+	if (trace == nullptr)
+	{
+		return false;
+	}
+
+	asset_trace_destroy(assets->trace);
+	assets->trace = trace;
+
+	return true;
+}
+
+/**
+ * Add the range of a traced asset, merged with the previous one if they're close
+ */
+static void add_readahead_range(const char *name, void *userdata)
+{
+	readahead_list_t *list = userdata;
+
+	const file_descriptor_t *desc = search_descriptor(list->assets, assets_hash(name));
+	if (desc == nullptr || list->failed)
+	{
+		// Trace might be from an older archive
+		return;
+	}
+
+	if (list->count > 0)
+	{
+		asset_range_t *last = list->ranges + list->count - 1;
+		const Uint64 last_end = last->offset + last->size;
+
+		if (desc->offset >= last->offset && desc->offset <= last_end + readahead_gap)
+		{
+			last->size = SDL_max(last_end, desc->offset + desc->size) - last->offset;
+			return;
+		}
+	}
+
+	if (list->count == list->capacity)
+	{
+		const size_t capacity = SDL_max(list->capacity * 2, 16);
+		asset_range_t *ranges = SDL_realloc(list->ranges, sizeof(asset_range_t) * capacity);
+		if (ranges == nullptr)
+		{
+			list->failed = true;
+			return;
+		}
+
+		list->ranges = ranges;
+		list->capacity = capacity;
+	}
+
+	list->ranges[list->count++] = (asset_range_t){
+		.offset = desc->offset,
+		.size = desc->size,
+	};
+}
+
+bool assets_readahead(assets_t *assets, const char *path)
+{
+	size_t size = 0;
+	char *text = SDL_LoadFile(path, &size);
+	if (text == nullptr)
+	{
+		return false;
+	}
+
+	readahead_list_t list = {
+		.assets = assets,
+	};
+
+	const bool parsed = asset_trace_parse(text, size, add_readahead_range, &list);
+	SDL_free(text);
+
+	if (!parsed || list.failed)
+	{
+		SDL_free(list.ranges);
+		return false;
+	}
+
+	SDL_LogDebug(LOG_CATEGORY_ASSETS, "Prefetching %zu ranges from %s", list.count, path);
+
+	asset_readahead_stop(assets->readahead);
+	assets->readahead = asset_readahead_start(&assets->map, &assets->reader,
+		list.ranges, list.count);
+
+	return assets->readahead != nullptr;
+}
+
+bool assets_use_disk_cache(assets_t *assets, const char *path, const char *version)
+{
+	disk_cache_t *cache = disk_cache_create(path, version);
+	if (cache == nullptr)
+	{
+		return false;
+	}
+
+	disk_cache_destroy(assets->disk_cache);
+	assets->disk_cache = cache;
+
+	return true;
+}
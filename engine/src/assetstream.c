@@ -1,5 +1,9 @@
 #include "chirp/assetstream.h"
+#include "chirp/blockcache.h"
+#include "chirp/compress.h"
+#include "chirp/filereader.h"
 
+#include <SDL3/SDL_error.h>
 #include <SDL3/SDL_iostream.h>
 #include <SDL3/SDL_mutex.h>
 #include <SDL3/SDL_stdinc.h>
@@ -8,11 +12,16 @@
 
 typedef struct
 {
+	// Cache is used first if set, then stream, otherwise reader
+	block_cache_t *cache;
+	file_reader_t reader;
 	SDL_IOStream *stream;
 	SDL_Mutex *read_mutex;
 	Sint64 offset;
 	Sint64 size;
 	Sint64 current;
+	// Where the previous read ended, to detect sequential reads
+	Sint64 read_end;
 } stream_info_t;
 
 static Sint64 stream_size(void *userdata)
@@ -35,7 +44,7 @@ static Sint64 stream_seek(void *userdata, const Sint64 offset, const SDL_IOWhenc
 			break;
 
 		case SDL_IO_SEEK_END:
-			info->current = info->offset - offset;
+			info->current = info->size + offset;
 			break;
 	}
 
@@ -46,10 +55,52 @@ static size_t stream_read(void *userdata, void *ptr, const size_t size, SDL_IOSt
 {
 	stream_info_t *info = userdata;
 
-	const size_t read_size = (info->current + size) > info->size
-		? info->size - info->current
+	if (info->current >= info->size)
+	{
+		*status = SDL_IO_STATUS_EOF;
+		return 0;
+	}
+
+	const size_t read_size = (info->current + (Sint64) size) > info->size
+		? (size_t) (info->size - info->current)
 		: size;
 
+	if (info->cache != nullptr)
+	{
+		// Likely to continue reading until the end if reading sequentially
+		const Sint64 readahead_end = info->current == info->read_end
+			? info->size
+			: info->current + (Sint64) read_size;
+
+		const size_t read = block_cache_read(info->cache, ptr, read_size,
+			(Uint64) (info->offset + info->current), (Uint64) (info->offset + readahead_end));
+
+		if (read != read_size)
+		{
+			*status = SDL_IO_STATUS_ERROR;
+			return 0;
+		}
+
+		info->current += (Sint64) read_size;
+		info->read_end = info->current;
+		return read_size;
+	}
+
+	if (info->stream == nullptr)
+	{
+		const size_t read = file_reader_read_at(&info->reader, ptr, read_size,
+			(Uint64) (info->offset + info->current));
+
+		if (read != read_size)
+		{
+			*status = SDL_IO_STATUS_ERROR;
+			return 0;
+		}
+
+		info->current += (Sint64) read_size;
+		return read_size;
+	}
+
 	SDL_LockMutex(info->read_mutex);
 
 	SDL_SeekIO(info->stream, info->offset + info->current, SDL_IO_SEEK_SET);
@@ -86,8 +137,8 @@ static bool stream_close(void *userdata)
 	return true;
 }
 
-SDL_IOStream *asset_stream_open_io(SDL_IOStream *stream, SDL_Mutex *read_mutex,
-	const Sint64 offset, const Sint64 size)
+[[nodiscard]]
+static SDL_IOStream *open_stream(const stream_info_t *source)
 {
 	const SDL_IOStreamInterface interface = {
 		.version = sizeof(interface),
@@ -100,11 +151,288 @@ SDL_IOStream *asset_stream_open_io(SDL_IOStream *stream, SDL_Mutex *read_mutex,
 	};
 
 	stream_info_t *info = SDL_malloc(sizeof(stream_info_t));
-	info->stream = stream;
-	info->read_mutex = read_mutex;
-	info->offset = offset;
-	info->size = size;
-	info->current = 0;
+	if (info == nullptr)
+	{
+		return nullptr;
+	}
+	*info = *source;
+
+	SDL_IOStream *stream = SDL_OpenIO(&interface, info);
+	if (stream == nullptr)
+	{
+		SDL_free(info);
+	}
+
+	return stream;
+}
+
+SDL_IOStream *asset_stream_open_io(SDL_IOStream *stream, SDL_Mutex *read_mutex,
+	const Sint64 offset, const Sint64 size)
+{
+	return open_stream(&(stream_info_t){
+		.cache = nullptr,
+		.reader = {},
+		.stream = stream,
+		.read_mutex = read_mutex,
+		.offset = offset,
+		.size = size,
+		.current = 0,
+		.read_end = 0,
+	});
+}
+
+SDL_IOStream *asset_stream_open_reader(const file_reader_t reader,
+	const Sint64 offset, const Sint64 size)
+{
+	return open_stream(&(stream_info_t){
+		.cache = nullptr,
+		.reader = reader,
+		.stream = nullptr,
+		.read_mutex = nullptr,
+		.offset = offset,
+		.size = size,
+		.current = 0,
+		.read_end = 0,
+	});
+}
+
+SDL_IOStream *asset_stream_open_cached(block_cache_t *cache,
+	const Sint64 offset, const Sint64 size)
+{
+	return open_stream(&(stream_info_t){
+		.cache = cache,
+		.reader = {},
+		.stream = nullptr,
+		.read_mutex = nullptr,
+		.offset = offset,
+		.size = size,
+		.current = 0,
+		.read_end = 0,
+	});
+}
+
+typedef struct
+{
+	SDL_IOStream *source;
+	Uint32 raw_size;
+	Uint32 block_size;
+	Uint32 block_count;
+	Uint32 *block_ends;
+	Sint64 data_offset;
+	Uint8 *compressed;
+	Uint8 *block;
+	Sint64 block_index;
+	Sint64 current;
+} compressed_info_t;
+
+static Sint64 compressed_size(void *userdata)
+{
+	return ((compressed_info_t*) userdata)->raw_size;
+}
+
+static Sint64 compressed_seek(void *userdata, const Sint64 offset, const SDL_IOWhence whence)
+{
+	compressed_info_t *info = userdata;
+
+	switch (whence)
+	{
+		case SDL_IO_SEEK_SET:
+			info->current = offset;
+			break;
+
+		case SDL_IO_SEEK_CUR:
+			info->current += offset;
+			break;
+
+		case SDL_IO_SEEK_END:
+			info->current = info->raw_size + offset;
+			break;
+	}
+
+	return info->current;
+}
+
+[[nodiscard]]
+static bool decode_block(compressed_info_t *info, const Uint32 index)
+{
+	if (info->block_index == index)
+	{
+		return true;
+	}
+
+	// Block contents are undefined until fully decoded
+	info->block_index = -1;
+
+	const Uint32 start = index > 0 ? info->block_ends[index - 1] : 0;
+	const Uint32 stored_size = info->block_ends[index] - start;
+	const Uint32 raw_size = SDL_min(info->raw_size - (index * info->block_size), info->block_size);
+
+	if (SDL_SeekIO(info->source, info->data_offset + start, SDL_IO_SEEK_SET) < 0)
+	{
+		return false;
+	}
+
+	// Blocks that didn't compress are stored as-is
+	if (stored_size == raw_size)
+	{
+		if (SDL_ReadIO(info->source, info->block, raw_size) != raw_size)
+		{
+			return false;
+		}
+	}
+	else if (SDL_ReadIO(info->source, info->compressed, stored_size) != stored_size
+		|| !decompress_block(info->compressed, stored_size, info->block, raw_size))
+	{
+		return false;
+	}
+
+	info->block_index = index;
+	return true;
+}
+
+static size_t compressed_read(void *userdata, void *ptr, const size_t size, SDL_IOStatus *status)
+{
+	compressed_info_t *info = userdata;
+
+	if (info->current < 0)
+	{
+		*status = SDL_IO_STATUS_ERROR;
+		return 0;
+	}
+
+	if (info->current >= info->raw_size)
+	{
+		*status = SDL_IO_STATUS_EOF;
+		return 0;
+	}
+
+	Uint8 *dst = ptr;
+	size_t read = 0;
+
+	while (read < size && info->current < info->raw_size)
+	{
+		const Uint32 index = (Uint32) (info->current / info->block_size);
+		if (!decode_block(info, index))
+		{
+			*status = SDL_IO_STATUS_ERROR;
+			return read;
+		}
+
+		const Sint64 block_start = (Sint64) index * info->block_size;
+		const Sint64 block_end = SDL_min(block_start + info->block_size, (Sint64) info->raw_size);
+		const size_t available = (size_t) (block_end - info->current);
+		const size_t count = SDL_min(available, size - read);
+
+		SDL_memcpy(dst + read, info->block + (info->current - block_start), count);
+		read += count;
+		info->current += (Sint64) count;
+	}
+
+	return read;
+}
+
+static bool compressed_close(void *userdata)
+{
+	compressed_info_t *info = userdata;
+
+	const bool result = SDL_CloseIO(info->source);
+	SDL_free(info->block_ends);
+	SDL_free(info->compressed);
+	SDL_free(info->block);
+	SDL_free(info);
+
+	return result;
+}
+
+[[nodiscard]]
+static bool read_compressed_header(SDL_IOStream *source, compressed_info_t *info)
+{
+	if (!SDL_ReadU32LE(source, &info->raw_size)
+		|| !SDL_ReadU32LE(source, &info->block_size)
+		|| !SDL_ReadU32LE(source, &info->block_count))
+	{
+		return SDL_SetError("Failed to read compression header");
+	}
+
+	if (info->block_size == 0
+		|| info->block_count != (info->raw_size + (Uint64) info->block_size - 1) / info->block_size)
+	{
+		return SDL_SetError("Invalid compression header");
+	}
+
+	info->block_ends = SDL_malloc(sizeof(Uint32) * SDL_max(info->block_count, 1));
+	if (info->block_ends == nullptr)
+	{
+		return false;
+	}
+
+	const Sint64 source_size = SDL_GetIOSize(source);
+	info->data_offset = (Sint64) (compress_header_size + (sizeof(Uint32) * info->block_count));
+
+	Uint32 previous_end = 0;
+	Uint32 largest_block = 0;
+
+	for (Uint32 i = 0; i < info->block_count; i++)
+	{
+		if (!SDL_ReadU32LE(source, info->block_ends + i))
+		{
+			return SDL_SetError("Failed to read compressed block table");
+		}
+
+		if (info->block_ends[i] < previous_end
+			|| (source_size >= 0 && info->data_offset + info->block_ends[i] > source_size))
+		{
+			return SDL_SetError("Compressed block %u is out of bounds", i);
+		}
+
+		largest_block = SDL_max(largest_block, info->block_ends[i] - previous_end);
+		previous_end = info->block_ends[i];
+	}
+
+	info->block = SDL_malloc(SDL_max(info->block_size, 1));
+	info->compressed = SDL_malloc(SDL_max(largest_block, 1));
+
+	return info->block != nullptr && info->compressed != nullptr;
+}
+
+SDL_IOStream *asset_stream_open_compressed(SDL_IOStream *source)
+{
+	if (source == nullptr)
+	{
+		return nullptr;
+	}
+
+	const SDL_IOStreamInterface interface = {
+		.version = sizeof(interface),
+		.size = compressed_size,
+		.seek = compressed_seek,
+		.read = compressed_read,
+		.write = stream_write,
+		.flush = stream_flush,
+		.close = compressed_close,
+	};
+
+	compressed_info_t *info = SDL_calloc(1, sizeof(compressed_info_t));
+	if (info == nullptr)
+	{
+		SDL_CloseIO(source);
+		return nullptr;
+	}
+
+	info->source = source;
+	info->block_index = -1;
+
+	if (!read_compressed_header(source, info))
+	{
+		compressed_close(info);
+		return nullptr;
+	}
+
+	SDL_IOStream *stream = SDL_OpenIO(&interface, info);
+	if (stream == nullptr)
+	{
+		compressed_close(info);
+	}
 
-	return SDL_OpenIO(&interface, info);
+	return stream;
 }
@@ -0,0 +1,199 @@
+#include "chirp/assettrace.h"
+#include "chirp/filemap.h"
+#include "chirp/filereader.h"
+#include "chirp/logcategory.h"
+
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+
+#include <stddef.h>
+
+struct asset_trace
+{
+	SDL_IOStream *stream;
+	SDL_Mutex *mutex;
+	Uint64 start;
+};
+
+struct asset_readahead
+{
+	file_map_t map;
+	file_reader_t reader;
+
+	asset_range_t *ranges;
+	size_t range_count;
+
+	SDL_AtomicInt stop;
+	SDL_Thread *thread;
+};
+
+asset_trace_t *asset_trace_create(const char *path)
+{
+	asset_trace_t *trace = SDL_calloc(1, sizeof(asset_trace_t));
+	if (trace == nullptr)
+	{
+		return nullptr;
+	}
+
+	trace->stream = SDL_IOFromFile(path, "w");
+	trace->mutex = SDL_CreateMutex();
+	trace->start = SDL_GetTicksNS();
+
+	if (trace->stream == nullptr || trace->mutex == nullptr
+		|| !SDL_IOprintf(trace->stream, "# name\toffset\tsize\tmicroseconds\n"))
+	{
+		asset_trace_destroy(trace);
+		return nullptr;
+	}
+
+	SDL_LogDebug(LOG_CATEGORY_ASSETS, "Recording asset trace to %s", path);
+	return trace;
+}
+
+void asset_trace_destroy(asset_trace_t *trace)
+{
+	if (trace == nullptr)
+	{
+		return;
+	}
+
+	SDL_CloseIO(trace->stream);
+	SDL_DestroyMutex(trace->mutex);
+	SDL_free(trace);
+}
+
+void asset_trace_add(asset_trace_t *trace, const char *name, const Uint64 offset, const Uint64 size)
+{
+	const Uint64 time = (SDL_GetTicksNS() - trace->start) / SDL_NS_PER_US;
+
+	SDL_LockMutex(trace->mutex);
+
+	// Losing a line only makes readahead less effective
+	SDL_IOprintf(trace->stream, "%s\t%" SDL_PRIu64 "\t%" SDL_PRIu64 "\t%" SDL_PRIu64 "\n",
+		name, offset, size, time);
+
+	SDL_UnlockMutex(trace->mutex);
+}
+
+bool asset_trace_parse(const char *text, const size_t size,
+	const asset_trace_callback_t callback, void *userdata)
+{
+	size_t start = 0;
+
+	while (start < size)
+	{
+		size_t end = start;
+		while (end < size && text[end] != '\n')
+		{
+			end++;
+		}
+
+		// Name is everything up to the first tab, or the entire line
+		size_t length = 0;
+		while (start + length < end && text[start + length] != '\t' && text[start + length] != '\r')
+		{
+			length++;
+		}
+
+		if (length > 0 && text[start] != '#')
+		{
+			char *name = SDL_strndup(text + start, length);
+			if (name == nullptr)
+			{
+				return false;
+			}
+
+			callback(name, userdata);
+			SDL_free(name);
+		}
+
+		start = end + 1;
+	}
+
+	return true;
+}
+
+static int run_readahead(void *data)
+{
+	asset_readahead_t *readahead = data;
+
+	const Uint64 begin = SDL_GetTicks();
+	size_t count = 0;
+
+	for (; count < readahead->range_count; count++)
+	{
+		if (SDL_GetAtomicInt(&readahead->stop) != 0)
+		{
+			break;
+		}
+
+		const asset_range_t *range = readahead->ranges + count;
+
+		if (readahead->map.data != nullptr)
+		{
+			file_map_prefetch(&readahead->map, (size_t) range->offset, (size_t) range->size);
+		}
+		else
+		{
+			file_reader_prefetch(&readahead->reader, range->offset, range->size);
+		}
+	}
+
+	SDL_LogDebug(LOG_CATEGORY_ASSETS, "Prefetched %zu ranges in %lu ms",
+		count, SDL_GetTicks() - begin);
+
+	return 0;
+}
+
+asset_readahead_t *asset_readahead_start(const file_map_t *map, const file_reader_t *reader,
+	asset_range_t *ranges, const size_t range_count)
+{
+	if (map->data == nullptr && !reader->is_open)
+	{
+		SDL_free(ranges);
+		SDL_SetError("Archive can't be prefetched");
+		return nullptr;
+	}
+
+	asset_readahead_t *readahead = SDL_calloc(1, sizeof(asset_readahead_t));
+	if (readahead == nullptr)
+	{
+		SDL_free(ranges);
+		return nullptr;
+	}
+
+	readahead->map = *map;
+	readahead->reader = *reader;
+	readahead->ranges = ranges;
+	readahead->range_count = range_count;
+
+	readahead->thread = SDL_CreateThread(run_readahead, "readahead", readahead);
+	if (readahead->thread == nullptr)
+	{
+		SDL_free(ranges);
+		SDL_free(readahead);
+		return nullptr;
+	}
+
+	return readahead;
+}
+
+void asset_readahead_stop(asset_readahead_t *readahead)
+{
+	if (readahead == nullptr)
+	{
+		return;
+	}
+
+	SDL_SetAtomicInt(&readahead->stop, 1);
+	SDL_WaitThread(readahead->thread, nullptr);
+
+	SDL_free(readahead->ranges);
+	SDL_free(readahead);
+}
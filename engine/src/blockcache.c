@@ -0,0 +1,319 @@
+#include "chirp/blockcache.h"
+#include "chirp/logcategory.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+// Blocks are spread over shards by index, so neighbouring blocks use different locks
+static constexpr size_t shard_count = 8;
+
+// Most blocks read at once when reading ahead
+static constexpr Uint64 max_readahead_blocks = 8;
+
+typedef struct cache_block
+{
+	Uint64 index;
+	Uint64 last_used;
+	Uint8 *data;
+	size_t size;
+	bool used;
+} cache_block_t;
+
+typedef struct cache_shard
+{
+	SDL_Mutex *mutex;
+	cache_block_t *blocks;
+	size_t block_count;
+
+	// Increased on every access, used to find the least recently used block
+	Uint64 clock;
+
+	block_cache_stats_t stats;
+} cache_shard_t;
+
+struct block_cache
+{
+	size_t block_size;
+	Uint64 file_size;
+
+	block_cache_read_t read;
+	void *userdata;
+
+	Uint8 *memory;
+	cache_shard_t shards[shard_count];
+};
+
+block_cache_t *block_cache_create(const size_t block_size, const size_t block_count,
+	const Uint64 file_size, const block_cache_read_t read, void *userdata)
+{
+	if (block_size == 0 || (block_size & (block_size - 1)) != 0)
+	{
+		SDL_free(userdata);
+		SDL_SetError("Block size is not a power of two: %zu", block_size);
+		return nullptr;
+	}
+
+	block_cache_t *cache = SDL_calloc(1, sizeof(block_cache_t));
+	if (cache == nullptr)
+	{
+		SDL_free(userdata);
+		return nullptr;
+	}
+
+	cache->block_size = block_size;
+	cache->file_size = file_size;
+	cache->read = read;
+	cache->userdata = userdata;
+
+	const size_t shard_blocks = SDL_max((block_count + shard_count - 1) / shard_count, 1);
+
+	cache->memory = SDL_malloc(block_size * shard_blocks * shard_count);
+	if (cache->memory == nullptr)
+	{
+		block_cache_destroy(cache);
+		return nullptr;
+	}
+
+	for (size_t i = 0; i < shard_count; i++)
+	{
+		cache_shard_t *shard = cache->shards + i;
+
+		shard->mutex = SDL_CreateMutex();
+		shard->blocks = SDL_calloc(shard_blocks, sizeof(cache_block_t));
+
+		if (shard->mutex == nullptr || shard->blocks == nullptr)
+		{
+			block_cache_destroy(cache);
+			return nullptr;
+		}
+
+		shard->block_count = shard_blocks;
+
+		for (size_t j = 0; j < shard_blocks; j++)
+		{
+			shard->blocks[j].data = cache->memory + (block_size * ((i * shard_blocks) + j));
+		}
+	}
+
+	SDL_LogDebug(LOG_CATEGORY_ASSETS, "Created block cache with %zu blocks of %zu bytes",
+		shard_blocks * shard_count, block_size);
+
+	return cache;
+}
+
+void block_cache_destroy(block_cache_t *cache)
+{
+	if (cache == nullptr)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < shard_count; i++)
+	{
+		SDL_DestroyMutex(cache->shards[i].mutex);
+		SDL_free(cache->shards[i].blocks);
+	}
+
+	SDL_free(cache->memory);
+	SDL_free(cache->userdata);
+	SDL_free(cache);
+}
+
+[[nodiscard]]
+static cache_shard_t *block_shard(block_cache_t *cache, const Uint64 index)
+{
+	return cache->shards + (index % shard_count);
+}
+
+[[nodiscard]]
+static cache_block_t *find_block(const cache_shard_t *shard, const Uint64 index)
+{
+	for (size_t i = 0; i < shard->block_count; i++)
+	{
+		cache_block_t *block = shard->blocks + i;
+		if (block->used && block->index == index)
+		{
+			return block;
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+ * Copy part of a block if it's cached
+ */
+[[nodiscard]]
+static bool copy_cached(block_cache_t *cache, const Uint64 index,
+	const size_t start, void *dst, const size_t size)
+{
+	cache_shard_t *shard = block_shard(cache, index);
+
+	SDL_LockMutex(shard->mutex);
+
+	cache_block_t *block = find_block(shard, index);
+	const bool found = block != nullptr && start + size <= block->size;
+
+	if (found)
+	{
+		SDL_memcpy(dst, block->data + start, size);
+		block->last_used = ++shard->clock;
+		shard->stats.hits++;
+	}
+	else
+	{
+		shard->stats.misses++;
+	}
+
+	SDL_UnlockMutex(shard->mutex);
+	return found;
+}
+
+static void insert_block(block_cache_t *cache, const Uint64 index,
+	const Uint8 *data, const size_t size, const bool readahead)
+{
+	cache_shard_t *shard = block_shard(cache, index);
+
+	SDL_LockMutex(shard->mutex);
+
+	// Another thread might have read the same block at the same time
+	if (find_block(shard, index) == nullptr)
+	{
+		cache_block_t *oldest = shard->blocks;
+
+		for (size_t i = 0; i < shard->block_count && oldest->used; i++)
+		{
+			cache_block_t *block = shard->blocks + i;
+			if (!block->used || block->last_used < oldest->last_used)
+			{
+				oldest = block;
+			}
+		}
+
+		SDL_memcpy(oldest->data, data, size);
+		oldest->index = index;
+		oldest->size = size;
+		oldest->used = true;
+		oldest->last_used = ++shard->clock;
+
+		if (readahead)
+		{
+			shard->stats.readahead++;
+		}
+	}
+
+	SDL_UnlockMutex(shard->mutex);
+}
+
+/**
+ * Read a missing block, together with the following blocks up to readahead_end,
+ * in a single read, then copy the requested part of the first block
+ */
+[[nodiscard]]
+static bool fill_blocks(block_cache_t *cache, const Uint64 index, const Uint64 readahead_end,
+	const size_t start, void *dst, const size_t size)
+{
+	const Uint64 block_size = cache->block_size;
+	const Uint64 last_block = (SDL_min(readahead_end, cache->file_size) + block_size - 1) / block_size;
+	const Uint64 count = SDL_clamp(last_block - SDL_min(last_block, index), 1, max_readahead_blocks);
+
+	const Uint64 offset = index * block_size;
+	const size_t read_size = (size_t) SDL_min(count * block_size, cache->file_size - offset);
+
+	Uint8 *buffer = SDL_malloc(read_size);
+	if (buffer == nullptr)
+	{
+		return false;
+	}
+
+	if (cache->read(cache->userdata, buffer, read_size, offset) != read_size)
+	{
+		SDL_free(buffer);
+		return false;
+	}
+
+	for (Uint64 i = 0; i < count; i++)
+	{
+		const size_t block_start = (size_t) (i * block_size);
+		if (block_start >= read_size)
+		{
+			break;
+		}
+
+		insert_block(cache, index + i, buffer + block_start,
+			SDL_min(block_size, read_size - block_start), i > 0);
+	}
+
+	SDL_memcpy(dst, buffer + start, size);
+	SDL_free(buffer);
+
+	return true;
+}
+
+size_t block_cache_read(block_cache_t *cache, void *dst, size_t size,
+	const Uint64 offset, const Uint64 readahead_end)
+{
+	if (offset >= cache->file_size)
+	{
+		return 0;
+	}
+
+	size = (size_t) SDL_min(size, cache->file_size - offset);
+
+	// Would only evict everything else
+	if (size >= cache->block_size)
+	{
+		cache_shard_t *shard = block_shard(cache, offset / cache->block_size);
+
+		SDL_LockMutex(shard->mutex);
+		shard->stats.direct++;
+		SDL_UnlockMutex(shard->mutex);
+
+		return cache->read(cache->userdata, dst, size, offset);
+	}
+
+	Uint8 *bytes = dst;
+	size_t read = 0;
+
+	while (read < size)
+	{
+		const Uint64 position = offset + read;
+		const Uint64 index = position / cache->block_size;
+		const size_t start = (size_t) (position % cache->block_size);
+		const size_t count = SDL_min(cache->block_size - start, size - read);
+
+		if (!copy_cached(cache, index, start, bytes + read, count)
+			&& !fill_blocks(cache, index, SDL_max(readahead_end, offset + size),
+				start, bytes + read, count))
+		{
+			break;
+		}
+
+		read += count;
+	}
+
+	return read;
+}
+
+block_cache_stats_t block_cache_stats(block_cache_t *cache)
+{
+	block_cache_stats_t stats = {};
+
+	for (size_t i = 0; i < shard_count; i++)
+	{
+		cache_shard_t *shard = cache->shards + i;
+
+		SDL_LockMutex(shard->mutex);
+		stats.hits += shard->stats.hits;
+		stats.misses += shard->stats.misses;
+		stats.readahead += shard->stats.readahead;
+		stats.direct += shard->stats.direct;
+		SDL_UnlockMutex(shard->mutex);
+	}
+
+	return stats;
+}
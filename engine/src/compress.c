@@ -0,0 +1,310 @@
+#include "chirp/compress.h"
+
+#include <SDL3/SDL_endian.h>
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+// Smallest match that can be encoded
+static constexpr size_t min_match = 4;
+
+// Last bytes of a block are always literals
+static constexpr size_t last_literals = 5;
+
+// Last match must start at least this far from the end of a block
+static constexpr size_t match_limit = 12;
+
+static constexpr size_t max_offset = 65535;
+
+static constexpr int hash_bits = 12;
+
+[[nodiscard]]
+static Uint32 read_u32(const Uint8 *data)
+{
+	Uint32 value;
+	SDL_memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static void write_u32_le(Uint8 *data, const Uint32 value)
+{
+	const Uint32 value_le = SDL_Swap32LE(value);
+	SDL_memcpy(data, &value_le, sizeof(value_le));
+}
+
+[[nodiscard]]
+static Uint32 hash_sequence(const Uint32 sequence)
+{
+	return (sequence * 2654435761U) >> (32 - hash_bits);
+}
+
+[[nodiscard]]
+static Uint8 *write_length(Uint8 *dst, size_t length)
+{
+	while (length >= 255)
+	{
+		*dst++ = 255;
+		length -= 255;
+	}
+
+	*dst++ = (Uint8) length;
+	return dst;
+}
+
+size_t compress_bound(const size_t size)
+{
+	return size + (size / 255) + 16;
+}
+
+size_t compress_block(const void *src, const size_t src_size, void *dst, const size_t dst_capacity)
+{
+	const Uint8 *in = src;
+	Uint8 *out = dst;
+	const Uint8 *out_end = out + dst_capacity;
+
+	size_t anchor = 0;
+
+	if (src_size > match_limit)
+	{
+		// Positions are stored off by one, so zero means empty
+		Uint32 table[1 << hash_bits];
+		SDL_zeroa(table);
+
+		const size_t search_end = src_size - match_limit;
+		const size_t match_end = src_size - last_literals;
+		size_t pos = 0;
+
+		while (pos < search_end)
+		{
+			const Uint32 sequence = read_u32(in + pos);
+			const Uint32 hash = hash_sequence(sequence);
+			size_t ref = table[hash];
+			table[hash] = (Uint32) pos + 1;
+
+			if (ref == 0 || pos - (ref - 1) > max_offset || read_u32(in + ref - 1) != sequence)
+			{
+				pos++;
+				continue;
+			}
+			ref--;
+
+			while (pos > anchor && ref > 0 && in[pos - 1] == in[ref - 1])
+			{
+				pos--;
+				ref--;
+			}
+
+			size_t length = min_match;
+			while (pos + length < match_end && in[pos + length] == in[ref + length])
+			{
+				length++;
+			}
+
+			const size_t literal_length = pos - anchor;
+			const size_t match_length = length - min_match;
+
+			if ((size_t) (out_end - out) < 1 + (literal_length / 255) + 1 + literal_length
+				+ 2 + (match_length / 255) + 1)
+			{
+				return 0;
+			}
+
+			Uint8 *token = out++;
+			*token = (Uint8) ((literal_length < 15 ? literal_length : 15) << 4);
+			if (literal_length >= 15)
+			{
+				out = write_length(out, literal_length - 15);
+			}
+
+			SDL_memcpy(out, in + anchor, literal_length);
+			out += literal_length;
+
+			const size_t offset = pos - ref;
+			*out++ = (Uint8) (offset & 0xff);
+			*out++ = (Uint8) (offset >> 8);
+
+			*token |= (Uint8) (match_length < 15 ? match_length : 15);
+			if (match_length >= 15)
+			{
+				out = write_length(out, match_length - 15);
+			}
+
+			pos += length;
+			anchor = pos;
+		}
+	}
+
+	const size_t literal_length = src_size - anchor;
+	if ((size_t) (out_end - out) < 1 + (literal_length / 255) + 1 + literal_length)
+	{
+		return 0;
+	}
+
+	*out++ = (Uint8) ((literal_length < 15 ? literal_length : 15) << 4);
+	if (literal_length >= 15)
+	{
+		out = write_length(out, literal_length - 15);
+	}
+
+	SDL_memcpy(out, in + anchor, literal_length);
+	out += literal_length;
+
+	return (size_t) (out - (Uint8*) dst);
+}
+
+[[nodiscard]]
+static bool read_length(const Uint8 **src, const Uint8 *src_end, size_t *length)
+{
+	Uint8 value;
+	do
+	{
+		if (*src >= src_end)
+		{
+			return false;
+		}
+
+		value = *(*src)++;
+		*length += value;
+	}
+	while (value == 255);
+
+	return true;
+}
+
+bool decompress_block(const void *src, const size_t src_size, void *dst, const size_t dst_size)
+{
+	const Uint8 *in = src;
+	const Uint8 *in_end = in + src_size;
+	Uint8 *out = dst;
+	const Uint8 *out_end = out + dst_size;
+
+	while (true)
+	{
+		if (in >= in_end)
+		{
+			return SDL_SetError("Compressed data is truncated");
+		}
+
+		const Uint8 token = *in++;
+
+		size_t literal_length = token >> 4;
+		if (literal_length == 15 && !read_length(&in, in_end, &literal_length))
+		{
+			return SDL_SetError("Compressed data is truncated");
+		}
+
+		if (literal_length > (size_t) (in_end - in)
+			|| literal_length > (size_t) (out_end - out))
+		{
+			return SDL_SetError("Literals out of bounds");
+		}
+
+		SDL_memcpy(out, in, literal_length);
+		in += literal_length;
+		out += literal_length;
+
+		// Last sequence only contains literals
+		if (in == in_end)
+		{
+			break;
+		}
+
+		if (in_end - in < 2)
+		{
+			return SDL_SetError("Compressed data is truncated");
+		}
+
+		const size_t offset = in[0] | (in[1] << 8);
+		in += 2;
+
+		if (offset == 0 || offset > (size_t) (out - (Uint8*) dst))
+		{
+			return SDL_SetError("Match offset out of bounds");
+		}
+
+		size_t length = token & 0xf;
+		if (length == 15 && !read_length(&in, in_end, &length))
+		{
+			return SDL_SetError("Compressed data is truncated");
+		}
+		length += min_match;
+
+		if (length > (size_t) (out_end - out))
+		{
+			return SDL_SetError("Match out of bounds");
+		}
+
+		const Uint8 *match = out - offset;
+
+		if (offset >= length)
+		{
+			SDL_memcpy(out, match, length);
+			out += length;
+		}
+		else
+		{
+			// Overlapping matches repeat the most recent bytes
+			for (size_t i = 0; i < length; i++)
+			{
+				*out++ = *match++;
+			}
+		}
+	}
+
+	if (out != out_end)
+	{
+		return SDL_SetError("Decompressed size mismatch, expected %zu but got %zu",
+			dst_size, (size_t) (out - (Uint8*) dst));
+	}
+
+	return true;
+}
+
+void *compress_chunked(const void *data, const size_t size, size_t *compressed_size)
+{
+	if (size > SDL_MAX_UINT32)
+	{
+		SDL_SetError("Data too large to compress: %zu", size);
+		return nullptr;
+	}
+
+	const Uint32 block_count = (Uint32) ((size + compress_block_size - 1) / compress_block_size);
+	const size_t table_size = sizeof(Uint32) * block_count;
+
+	// Blocks are never larger than their raw size
+	Uint8 *result = SDL_malloc(compress_header_size + table_size + size);
+	if (result == nullptr)
+	{
+		return nullptr;
+	}
+
+	write_u32_le(result, (Uint32) size);
+	write_u32_le(result + 4, compress_block_size);
+	write_u32_le(result + 8, block_count);
+
+	Uint8 *table = result + compress_header_size;
+	Uint8 *blocks = table + table_size;
+	size_t blocks_size = 0;
+
+	for (Uint32 i = 0; i < block_count; i++)
+	{
+		const size_t offset = (size_t) i * compress_block_size;
+		const size_t raw_size = SDL_min(size - offset, compress_block_size);
+		const Uint8 *raw = (const Uint8*) data + offset;
+
+		// Only keep the compressed block if it's smaller
+		size_t block_size = compress_block(raw, raw_size, blocks + blocks_size, raw_size - 1);
+		if (block_size == 0)
+		{
+			SDL_memcpy(blocks + blocks_size, raw, raw_size);
+			block_size = raw_size;
+		}
+
+		blocks_size += block_size;
+		write_u32_le(table + ((size_t) i * sizeof(Uint32)), (Uint32) blocks_size);
+	}
+
+	*compressed_size = compress_header_size + table_size + blocks_size;
+	return result;
+}
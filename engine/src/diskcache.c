@@ -0,0 +1,280 @@
+#include "chirp/diskcache.h"
+#include "chirp/assets.h"
+#include "chirp/filemap.h"
+#include "chirp/logcategory.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_thread.h>
+
+#include <stddef.h>
+
+/*
+ * Each entry is a file named after the hash of its key, little endian:
+ *
+ * u32 magic, u32 format version, u32 signature, u64 data size,
+ * string version, string key, padding to data alignment, data
+ *
+ * Strings are stored as u16 length followed by the characters, without a terminator
+ */
+
+struct disk_cache
+{
+	char *path;
+	char *version;
+};
+
+static constexpr Uint32 cache_magic = SDL_FOURCC('c', 'h', 'c', 'a');
+static constexpr Uint32 cache_version = 1;
+
+// Data is aligned, so it can be used directly from the mapping
+static constexpr size_t data_alignment = 16;
+
+disk_cache_t *disk_cache_create(const char *path, const char *version)
+{
+	if (!SDL_CreateDirectory(path))
+	{
+		return nullptr;
+	}
+
+	disk_cache_t *cache = SDL_calloc(1, sizeof(disk_cache_t));
+	if (cache == nullptr)
+	{
+		return nullptr;
+	}
+
+	cache->path = SDL_strdup(path);
+	cache->version = SDL_strdup(version);
+
+	if (cache->path == nullptr || cache->version == nullptr)
+	{
+		disk_cache_destroy(cache);
+		return nullptr;
+	}
+
+	SDL_LogDebug(LOG_CATEGORY_ASSETS, "Using disk cache in %s", path);
+	return cache;
+}
+
+void disk_cache_destroy(disk_cache_t *cache)
+{
+	if (cache == nullptr)
+	{
+		return;
+	}
+
+	SDL_free(cache->path);
+	SDL_free(cache->version);
+	SDL_free(cache);
+}
+
+[[nodiscard]]
+static char *entry_path(const disk_cache_t *cache, const char *key)
+{
+	char *path = nullptr;
+	if (SDL_asprintf(&path, "%s/%08x", cache->path, assets_hash(key)) < 0)
+	{
+		return nullptr;
+	}
+
+	return path;
+}
+
+[[nodiscard]]
+static size_t align_offset(const size_t offset)
+{
+	return (offset + data_alignment - 1) & ~(data_alignment - 1);
+}
+
+[[nodiscard]]
+static bool read_string_equals(SDL_IOStream *stream, const char *str)
+{
+	Uint16 length;
+	if (!SDL_ReadU16LE(stream, &length) || length != SDL_strlen(str))
+	{
+		return false;
+	}
+
+	char *read = SDL_malloc(length + 1);
+	if (read == nullptr)
+	{
+		return false;
+	}
+
+	const bool equals = SDL_ReadIO(stream, read, length) == length
+		&& SDL_memcmp(read, str, length) == 0;
+
+	SDL_free(read);
+	return equals;
+}
+
+/**
+ * @returns Offset of the data, or 0 if the header doesn't match
+ */
+[[nodiscard]]
+static size_t validate_header(const disk_cache_t *cache, const char *key,
+	const Uint32 signature, const Uint8 *data, const size_t size)
+{
+	SDL_IOStream *stream = SDL_IOFromConstMem(data, size);
+	if (stream == nullptr)
+	{
+		return 0;
+	}
+
+	Uint32 magic;
+	Uint32 version;
+	Uint32 entry_signature;
+	Uint64 data_size;
+
+	const bool valid = SDL_ReadU32LE(stream, &magic)
+		&& SDL_ReadU32LE(stream, &version)
+		&& SDL_ReadU32LE(stream, &entry_signature)
+		&& SDL_ReadU64LE(stream, &data_size)
+		&& magic == cache_magic
+		&& version == cache_version
+		&& entry_signature == signature
+		&& read_string_equals(stream, cache->version)
+		&& read_string_equals(stream, key);
+
+	const size_t offset = valid ? align_offset((size_t) SDL_TellIO(stream)) : 0;
+	SDL_CloseIO(stream);
+
+	// Truncated files are treated the same as outdated ones
+	return offset > 0 && offset <= size && data_size == size - offset ? offset : 0;
+}
+
+bool disk_cache_open(const disk_cache_t *cache, const char *key, const Uint32 signature,
+	disk_cache_entry_t *entry)
+{
+	*entry = (disk_cache_entry_t){};
+
+	char *path = entry_path(cache, key);
+	if (path == nullptr)
+	{
+		return false;
+	}
+
+	if (!SDL_GetPathInfo(path, nullptr))
+	{
+		SDL_free(path);
+		return false;
+	}
+
+	const Uint8 *data = nullptr;
+	size_t size = 0;
+
+	if (file_map_open(path, &entry->map))
+	{
+		data = entry->map.data;
+		size = entry->map.size;
+	}
+	else
+	{
+		entry->buffer = SDL_LoadFile(path, &size);
+		data = entry->buffer;
+	}
+
+	SDL_free(path);
+
+	if (data == nullptr)
+	{
+		return false;
+	}
+
+	const size_t offset = validate_header(cache, key, signature, data, size);
+	if (offset == 0)
+	{
+		disk_cache_close(entry);
+		*entry = (disk_cache_entry_t){};
+		return SDL_SetError("Outdated cache entry: %s", key);
+	}
+
+	entry->data = data + offset;
+	entry->size = size - offset;
+
+	return true;
+}
+
+void disk_cache_close(const disk_cache_entry_t *entry)
+{
+	file_map_close(&entry->map);
+	SDL_free(entry->buffer);
+}
+
+[[nodiscard]]
+static bool write_string(SDL_IOStream *stream, const char *str)
+{
+	const size_t length = SDL_strlen(str);
+	if (length > SDL_MAX_UINT16)
+	{
+		return SDL_SetError("Key too long: %s", str);
+	}
+
+	return SDL_WriteU16LE(stream, (Uint16) length)
+		&& SDL_WriteIO(stream, str, length) == length;
+}
+
+[[nodiscard]]
+static bool write_entry(SDL_IOStream *stream, const disk_cache_t *cache, const char *key,
+	const Uint32 signature, const void *data, const size_t size)
+{
+	static constexpr Uint8 zeros[data_alignment] = {};
+
+	if (!SDL_WriteU32LE(stream, cache_magic)
+		|| !SDL_WriteU32LE(stream, cache_version)
+		|| !SDL_WriteU32LE(stream, signature)
+		|| !SDL_WriteU64LE(stream, size)
+		|| !write_string(stream, cache->version)
+		|| !write_string(stream, key))
+	{
+		return false;
+	}
+
+	const size_t position = (size_t) SDL_TellIO(stream);
+	const size_t padding = align_offset(position) - position;
+
+	return SDL_WriteIO(stream, zeros, padding) == padding
+		&& SDL_WriteIO(stream, data, size) == size;
+}
+
+bool disk_cache_store(const disk_cache_t *cache, const char *key, const Uint32 signature,
+	const void *data, const size_t size)
+{
+	char *path = entry_path(cache, key);
+	if (path == nullptr)
+	{
+		return false;
+	}
+
+	// Written to a temporary file first, so a crash never leaves a partial entry behind
+	char *temp_path = nullptr;
+	if (SDL_asprintf(&temp_path, "%s.%" SDL_PRIu64 ".tmp", path, SDL_GetCurrentThreadID()) < 0)
+	{
+		SDL_free(path);
+		return false;
+	}
+
+	SDL_IOStream *stream = SDL_IOFromFile(temp_path, "wb");
+	bool result = stream != nullptr
+		&& write_entry(stream, cache, key, signature, data, size);
+
+	if (stream != nullptr && !SDL_CloseIO(stream))
+	{
+		result = false;
+	}
+
+	result = result && SDL_RenamePath(temp_path, path);
+
+	if (!result)
+	{
+		SDL_RemovePath(temp_path);
+	}
+
+	SDL_free(temp_path);
+	SDL_free(path);
+
+	return result;
+}
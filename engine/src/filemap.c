@@ -0,0 +1,166 @@
+#include "chirp/filemap.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_stdinc.h>
+
+#ifdef SDL_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef SDL_PLATFORM_WINDOWS
+
+bool file_map_open(const char *path, file_map_t *map)
+{
+	const int path_len = MultiByteToWideChar(CP_UTF8, 0, path, -1, nullptr, 0);
+	if (path_len <= 0)
+	{
+		return SDL_SetError("Invalid path: %s", path);
+	}
+
+	wchar_t *wpath = SDL_malloc(sizeof(wchar_t) * path_len);
+	if (wpath == nullptr)
+	{
+		return false;
+	}
+	MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, path_len);
+
+	const HANDLE file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	SDL_free(wpath);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return SDL_SetError("Failed to open file: %lu", GetLastError());
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return SDL_SetError("Failed to get file size");
+	}
+
+	const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+
+	if (mapping == nullptr)
+	{
+		return SDL_SetError("Failed to map file: %lu", GetLastError());
+	}
+
+	const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr)
+	{
+		CloseHandle(mapping);
+		return SDL_SetError("Failed to map view of file: %lu", GetLastError());
+	}
+
+	map->data = data;
+	map->size = (size_t) file_size.QuadPart;
+	map->handle = mapping;
+
+	return true;
+}
+
+void file_map_close(const file_map_t *map)
+{
+	if (map == nullptr || map->data == nullptr)
+	{
+		return;
+	}
+
+	UnmapViewOfFile(map->data);
+	CloseHandle(map->handle);
+}
+
+void file_map_prefetch(const file_map_t *map, const size_t offset, const size_t size)
+{
+	if (offset >= map->size)
+	{
+		return;
+	}
+
+	SYSTEM_INFO system_info;
+	GetSystemInfo(&system_info);
+
+	// Touching a single byte is enough to fault in the entire page
+	const volatile Uint8 *data = map->data;
+	const size_t end = SDL_min(offset + size, map->size);
+
+	for (size_t i = offset; i < end; i += system_info.dwPageSize)
+	{
+		(void) data[i];
+	}
+}
+
+#else
+
+bool file_map_open(const char *path, file_map_t *map)
+{
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return SDL_SetError("Failed to open file: %s", strerror(errno));
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0)
+	{
+		close(fd);
+		return SDL_SetError("Failed to get file size");
+	}
+
+	const size_t size = (size_t) file_stat.st_size;
+	void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// Mapping keeps its own reference to the file
+	close(fd);
+
+	if (data == MAP_FAILED)
+	{
+		return SDL_SetError("Failed to map file: %s", strerror(errno));
+	}
+
+	map->data = data;
+	map->size = size;
+	map->handle = nullptr;
+
+	return true;
+}
+
+void file_map_close(const file_map_t *map)
+{
+	if (map == nullptr || map->data == nullptr)
+	{
+		return;
+	}
+
+	munmap((void*) map->data, map->size);
+}
+
+void file_map_prefetch(const file_map_t *map, const size_t offset, const size_t size)
+{
+	if (offset >= map->size)
+	{
+		return;
+	}
+
+	// Start address has to be page aligned
+	const size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+	const size_t start = offset - (offset % page_size);
+	const size_t end = SDL_min(offset + size, map->size);
+
+	posix_madvise((void*) (map->data + start), end - start, POSIX_MADV_WILLNEED);
+}
+
+#endif
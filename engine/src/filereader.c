@@ -0,0 +1,222 @@
+#include "chirp/filereader.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_stdinc.h>
+
+#ifdef SDL_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(SDL_PLATFORM_WINDOWS) || !(defined(SDL_PLATFORM_LINUX) \
+	|| defined(SDL_PLATFORM_ANDROID) || defined(SDL_PLATFORM_APPLE))
+
+static constexpr size_t prefetch_chunk_size = 64 * 1024;
+
+/**
+ * Without a way to hint the OS, read the range so it ends up in the file cache
+ */
+static void read_range(const file_reader_t *reader, const Uint64 offset, const Uint64 size)
+{
+	Uint8 *buffer = SDL_malloc(prefetch_chunk_size);
+	if (buffer == nullptr)
+	{
+		return;
+	}
+
+	for (Uint64 position = offset; position < offset + size; position += prefetch_chunk_size)
+	{
+		const size_t chunk = (size_t) SDL_min(offset + size - position, prefetch_chunk_size);
+		if (file_reader_read_at(reader, buffer, chunk, position) != chunk)
+		{
+			break;
+		}
+	}
+
+	SDL_free(buffer);
+}
+
+#endif
+
+#ifdef SDL_PLATFORM_WINDOWS
+
+bool file_reader_open(const char *path, file_reader_t *reader)
+{
+	const int path_len = MultiByteToWideChar(CP_UTF8, 0, path, -1, nullptr, 0);
+	if (path_len <= 0)
+	{
+		return SDL_SetError("Invalid path: %s", path);
+	}
+
+	wchar_t *wpath = SDL_malloc(sizeof(wchar_t) * path_len);
+	if (wpath == nullptr)
+	{
+		return false;
+	}
+	MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, path_len);
+
+	const HANDLE file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	SDL_free(wpath);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return SDL_SetError("Failed to open file: %lu", GetLastError());
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size))
+	{
+		CloseHandle(file);
+		return SDL_SetError("Failed to get file size");
+	}
+
+	reader->handle = (Sint64) (intptr_t) file;
+	reader->size = (Uint64) file_size.QuadPart;
+	reader->is_open = true;
+
+	return true;
+}
+
+void file_reader_close(const file_reader_t *reader)
+{
+	if (reader == nullptr || !reader->is_open)
+	{
+		return;
+	}
+
+	CloseHandle((HANDLE) (intptr_t) reader->handle);
+}
+
+size_t file_reader_read_at(const file_reader_t *reader, void *ptr, const size_t size, const Uint64 offset)
+{
+	const HANDLE file = (HANDLE) (intptr_t) reader->handle;
+	size_t total = 0;
+
+	while (total < size)
+	{
+		const Uint64 position = offset + total;
+		OVERLAPPED overlapped = {
+			.Offset = (DWORD) (position & 0xFFFFFFFF),
+			.OffsetHigh = (DWORD) (position >> 32),
+		};
+
+		const DWORD chunk = (DWORD) SDL_min(size - total, 0x40000000);
+		DWORD read = 0;
+
+		if (!ReadFile(file, (Uint8*) ptr + total, chunk, &read, &overlapped))
+		{
+			if (GetLastError() == ERROR_HANDLE_EOF)
+			{
+				break;
+			}
+			SDL_SetError("Failed to read file: %lu", GetLastError());
+			break;
+		}
+
+		if (read == 0)
+		{
+			break;
+		}
+
+		total += read;
+	}
+
+	return total;
+}
+
+#else
+
+bool file_reader_open(const char *path, file_reader_t *reader)
+{
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return SDL_SetError("Failed to open file: %s", strerror(errno));
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0)
+	{
+		close(fd);
+		return SDL_SetError("Failed to get file size");
+	}
+
+	reader->handle = fd;
+	reader->size = (Uint64) file_stat.st_size;
+	reader->is_open = true;
+
+	return true;
+}
+
+void file_reader_close(const file_reader_t *reader)
+{
+	if (reader == nullptr || !reader->is_open)
+	{
+		return;
+	}
+
+	close((int) reader->handle);
+}
+
+size_t file_reader_read_at(const file_reader_t *reader, void *ptr, const size_t size, const Uint64 offset)
+{
+	size_t total = 0;
+
+	while (total < size)
+	{
+		const ssize_t read = pread((int) reader->handle, (Uint8*) ptr + total,
+			size - total, (off_t) (offset + total));
+
+		if (read < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			SDL_SetError("Failed to read file: %s", strerror(errno));
+			break;
+		}
+
+		if (read == 0)
+		{
+			break;
+		}
+
+		total += (size_t) read;
+	}
+
+	return total;
+}
+
+#endif
+
+void file_reader_prefetch(const file_reader_t *reader, const Uint64 offset, const Uint64 size)
+{
+	if (offset >= reader->size)
+	{
+		return;
+	}
+
+	const Uint64 length = SDL_min(size, reader->size - offset);
+
+#if defined(SDL_PLATFORM_LINUX) || defined(SDL_PLATFORM_ANDROID)
+	posix_fadvise((int) reader->handle, (off_t) offset, (off_t) length, POSIX_FADV_WILLNEED);
+#elif defined(SDL_PLATFORM_APPLE)
+	struct radvisory advisory = {
+		.ra_offset = (off_t) offset,
+		.ra_count = (int) SDL_min(length, SDL_MAX_SINT32),
+	};
+	fcntl((int) reader->handle, F_RDADVISE, &advisory);
+#else
+	read_range(reader, offset, length);
+#endif
+}
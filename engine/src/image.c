@@ -18,14 +18,10 @@
 
 static constexpr auto channels = 4;
 
-SDL_Surface *load_qoi(SDL_IOStream *source, const bool close_io)
+SDL_Surface *load_qoi_mem(const void *data, const size_t size)
 {
-	size_t size = 0;
-	void *data = SDL_LoadFile_IO(source, &size, close_io);
-
 	qoi_desc desc;
 	void *pixels = qoi_decode(data, (int) size, &desc, channels);
-	SDL_free(data);
 
 	if (pixels == nullptr)
 	{
@@ -39,3 +35,18 @@ SDL_Surface *load_qoi(SDL_IOStream *source, const bool close_io)
 	surface->flags &= SDL_SURFACE_PREALLOCATED;
 	return surface;
 }
+
+SDL_Surface *load_qoi(SDL_IOStream *source, const bool close_io)
+{
+	size_t size = 0;
+	void *data = SDL_LoadFile_IO(source, &size, close_io);
+	if (data == nullptr)
+	{
+		return nullptr;
+	}
+
+	SDL_Surface *surface = load_qoi_mem(data, size);
+	SDL_free(data);
+
+	return surface;
+}
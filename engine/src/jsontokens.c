@@ -0,0 +1,648 @@
+#include "chirp/json.h"
+
+#include <SDL3/SDL_bits.h>
+#include <SDL3/SDL_stdinc.h>
+
+#ifdef SIMD_ENABLED
+#include <SDL3/SDL_intrin.h>
+#endif
+
+#include <stddef.h>
+
+/*
+ * Two stages, similar to simdjson:
+ *
+ * 1. Classify 32 bytes at a time into bitmasks, and use them to find strings,
+ *    then record the position of every structural character, quote and primitive outside of them
+ * 2. Walk the recorded positions using the same rules as jsmn in cgltf (strict, with parent links),
+ *    so the tokens are identical to json_parse
+ */
+
+typedef struct block_masks
+{
+	Uint32 quote;
+	Uint32 backslash;
+	Uint32 structural;
+	// Opening brackets, also included in structural
+	Uint32 open;
+	Uint32 whitespace;
+	Uint32 zero;
+} block_masks_t;
+
+typedef struct position_list
+{
+	Uint32 *items;
+	size_t count;
+	size_t capacity;
+} position_list_t;
+
+typedef struct json_index
+{
+	// Structural characters, quotes and the first character of each primitive
+	position_list_t structurals;
+	// Backslashes starting an escape sequence inside a string
+	position_list_t escapes;
+	// Upper bound of the number of tokens, from opening brackets, quotes and primitives
+	size_t token_count;
+} json_index_t;
+
+static constexpr size_t block_size = 32;
+static constexpr size_t half_block_size = 16;
+
+#if defined(SIMD_ENABLED) && defined(SDL_SSE2_INTRINSICS)
+
+static void classify_half(const char *data, const int shift, block_masks_t *masks)
+{
+	const __m128i chunk = _mm_loadu_si128((const __m128i*) data);
+
+	// '[' and ']' only differ from '{' and '}' by one bit
+	const __m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+
+	const __m128i open = _mm_cmpeq_epi8(lower, _mm_set1_epi8('{'));
+
+	const __m128i structural = _mm_or_si128(
+		_mm_or_si128(open, _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+		_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(':')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8(','))));
+
+	const __m128i whitespace = _mm_or_si128(
+		_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+		_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))));
+
+	masks->quote |= (Uint32) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'))) << shift;
+	masks->backslash |= (Uint32) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))) << shift;
+	masks->structural |= (Uint32) _mm_movemask_epi8(structural) << shift;
+	masks->open |= (Uint32) _mm_movemask_epi8(open) << shift;
+	masks->whitespace |= (Uint32) _mm_movemask_epi8(whitespace) << shift;
+	masks->zero |= (Uint32) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_setzero_si128())) << shift;
+}
+
+#elif defined(SIMD_ENABLED) && defined(SDL_NEON_INTRINSICS)
+
+/**
+ * Equivalent of _mm_movemask_epi8, for comparison results where each byte is all ones or zeros
+ */
+[[nodiscard]]
+static Uint32 movemask(const uint8x16_t mask)
+{
+	static const Uint8 bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+
+	const uint8x16_t masked = vandq_u8(mask, vld1q_u8(bits));
+
+	uint8x8_t sum = vpadd_u8(vget_low_u8(masked), vget_high_u8(masked));
+	sum = vpadd_u8(sum, sum);
+	sum = vpadd_u8(sum, sum);
+
+	return vget_lane_u16(vreinterpret_u16_u8(sum), 0);
+}
+
+static void classify_half(const char *data, const int shift, block_masks_t *masks)
+{
+	const uint8x16_t chunk = vld1q_u8((const Uint8*) data);
+
+	// '[' and ']' only differ from '{' and '}' by one bit
+	const uint8x16_t lower = vorrq_u8(chunk, vdupq_n_u8(0x20));
+
+	const uint8x16_t open = vceqq_u8(lower, vdupq_n_u8('{'));
+
+	const uint8x16_t structural = vorrq_u8(
+		vorrq_u8(open, vceqq_u8(lower, vdupq_n_u8('}'))),
+		vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(':')), vceqq_u8(chunk, vdupq_n_u8(','))));
+
+	const uint8x16_t whitespace = vorrq_u8(
+		vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(' ')), vceqq_u8(chunk, vdupq_n_u8('\t'))),
+		vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('\n')), vceqq_u8(chunk, vdupq_n_u8('\r'))));
+
+	masks->quote |= movemask(vceqq_u8(chunk, vdupq_n_u8('"'))) << shift;
+	masks->backslash |= movemask(vceqq_u8(chunk, vdupq_n_u8('\\'))) << shift;
+	masks->structural |= movemask(structural) << shift;
+	masks->open |= movemask(open) << shift;
+	masks->whitespace |= movemask(whitespace) << shift;
+	masks->zero |= movemask(vceqq_u8(chunk, vdupq_n_u8(0))) << shift;
+}
+
+#else
+
+static void classify_half(const char *data, const int shift, block_masks_t *masks)
+{
+	for (int i = 0; i < (int) half_block_size; i++)
+	{
+		const Uint32 bit = (Uint32) 1 << (shift + i);
+
+		switch (data[i])
+		{
+			case '"':
+				masks->quote |= bit;
+				break;
+
+			case '\\':
+				masks->backslash |= bit;
+				break;
+
+			case '{':
+			case '[':
+				masks->structural |= bit;
+				masks->open |= bit;
+				break;
+
+			case '}':
+			case ']':
+			case ':':
+			case ',':
+				masks->structural |= bit;
+				break;
+
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				masks->whitespace |= bit;
+				break;
+
+			case '\0':
+				masks->zero |= bit;
+				break;
+
+			default:
+				break;
+		}
+	}
+}
+
+#endif
+
+static void classify_block(const char *data, block_masks_t *masks)
+{
+	*masks = (block_masks_t){};
+
+	classify_half(data, 0, masks);
+	classify_half(data + half_block_size, (int) half_block_size, masks);
+}
+
+[[nodiscard]]
+static int lowest_bit(const Uint32 mask)
+{
+	return SDL_MostSignificantBitIndex32(mask & (~mask + 1));
+}
+
+[[nodiscard]]
+static size_t count_bits(Uint32 mask)
+{
+	mask = mask - ((mask >> 1) & 0x55555555);
+	mask = (mask & 0x33333333) + ((mask >> 2) & 0x33333333);
+	return (((mask + (mask >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+/**
+ * Each bit is set if there's an odd number of bits set up to and including it
+ */
+[[nodiscard]]
+static Uint32 prefix_xor(Uint32 mask)
+{
+	mask ^= mask << 1;
+	mask ^= mask << 2;
+	mask ^= mask << 4;
+	mask ^= mask << 8;
+	mask ^= mask << 16;
+	return mask;
+}
+
+/**
+ * Find characters escaped by a backslash, which can be a backslash itself
+ * @param escape_next First character is escaped, updated for the next block
+ */
+[[nodiscard]]
+static Uint32 find_escaped(Uint32 backslash, bool *escape_next)
+{
+	Uint32 escaped = 0;
+
+	if (*escape_next)
+	{
+		escaped = 1;
+		backslash &= ~(Uint32) 1;
+	}
+
+	*escape_next = false;
+
+	while (backslash != 0)
+	{
+		const int bit = lowest_bit(backslash);
+		if (bit == (int) block_size - 1)
+		{
+			*escape_next = true;
+			break;
+		}
+
+		escaped |= (Uint32) 2 << bit;
+		backslash &= ~((Uint32) 3 << bit);
+	}
+
+	return escaped;
+}
+
+[[nodiscard]]
+static bool reserve_positions(position_list_t *list, const size_t count)
+{
+	if (list->count + count <= list->capacity)
+	{
+		return true;
+	}
+
+	const size_t capacity = SDL_max(list->capacity * 2, list->count + count);
+
+	Uint32 *items = SDL_realloc(list->items, sizeof(Uint32) * capacity);
+	if (items == nullptr)
+	{
+		return false;
+	}
+
+	list->items = items;
+	list->capacity = capacity;
+
+	return true;
+}
+
+static void add_positions(position_list_t *list, const size_t offset, Uint32 mask)
+{
+	while (mask != 0)
+	{
+		list->items[list->count++] = (Uint32) (offset + lowest_bit(mask));
+		mask &= mask - 1;
+	}
+}
+
+/**
+ * First stage, everything after the first null character is ignored, like jsmn does
+ * @param json_len Updated to where the document ends
+ */
+[[nodiscard]]
+static bool find_structurals(const char *json, size_t *json_len, json_index_t *index)
+{
+	size_t len = *json_len;
+
+	// Usually about one structural character every 8 bytes in glTF files
+	if (!reserve_positions(&index->structurals, (len / 8) + block_size))
+	{
+		return false;
+	}
+
+	// All ones while inside a string
+	Uint32 string_carry = 0;
+	// Last character of the previous block was part of a primitive
+	Uint32 primitive_carry = 0;
+	bool escape_next = false;
+
+	for (size_t offset = 0; offset < len; offset += block_size)
+	{
+		if (!reserve_positions(&index->structurals, block_size))
+		{
+			return false;
+		}
+
+		block_masks_t masks;
+
+		if (len - offset >= block_size)
+		{
+			classify_block(json + offset, &masks);
+		}
+		else
+		{
+			// Padded with whitespace, which is ignored
+			char tail[block_size];
+			SDL_memset(tail, ' ', block_size);
+			SDL_memcpy(tail, json + offset, len - offset);
+			classify_block(tail, &masks);
+		}
+
+		Uint32 valid = SDL_MAX_UINT32;
+		if (masks.zero != 0)
+		{
+			const int end = lowest_bit(masks.zero);
+			valid = end == 0 ? 0 : SDL_MAX_UINT32 >> (block_size - end);
+			len = offset + end;
+		}
+
+		const Uint32 backslash = masks.backslash & valid;
+		const Uint32 escaped = backslash != 0 || escape_next
+			? find_escaped(backslash, &escape_next)
+			: 0;
+
+		const Uint32 quote = masks.quote & ~escaped & valid;
+
+		// From the opening quote up to, but not including, the closing quote
+		const Uint32 in_string = prefix_xor(quote) ^ string_carry;
+		string_carry = (in_string >> (block_size - 1)) != 0 ? SDL_MAX_UINT32 : 0;
+
+		const Uint32 structural = masks.structural & ~in_string & valid;
+		const Uint32 primitive = ~(masks.structural | masks.whitespace | quote | in_string) & valid;
+		const Uint32 primitive_start = primitive & ~((primitive << 1) | primitive_carry);
+		primitive_carry = primitive >> (block_size - 1);
+
+		add_positions(&index->structurals, offset, structural | quote | primitive_start);
+
+		// Opening quotes are the only ones inside the string mask
+		index->token_count += count_bits((quote & in_string) | primitive_start | (masks.open & structural));
+
+		const Uint32 escape_start = backslash & ~escaped & in_string;
+		if (escape_start != 0)
+		{
+			if (!reserve_positions(&index->escapes, block_size))
+			{
+				return false;
+			}
+			add_positions(&index->escapes, offset, escape_start);
+		}
+	}
+
+	*json_len = len;
+	return true;
+}
+
+[[nodiscard]]
+static bool is_hex(const char c)
+{
+	return (c >= '0' && c <= '9')
+		|| (c >= 'A' && c <= 'F')
+		|| (c >= 'a' && c <= 'f');
+}
+
+[[nodiscard]]
+static bool valid_escape(const char *json, const size_t pos, const size_t end)
+{
+	if (pos + 1 >= end)
+	{
+		return false;
+	}
+
+	switch (json[pos + 1])
+	{
+		case '"':
+		case '/':
+		case '\\':
+		case 'b':
+		case 'f':
+		case 'r':
+		case 'n':
+		case 't':
+			return true;
+
+		case 'u':
+			if (pos + 6 > end)
+			{
+				return false;
+			}
+
+			for (size_t i = pos + 2; i < pos + 6; i++)
+			{
+				if (!is_hex(json[i]))
+				{
+					return false;
+				}
+			}
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+[[nodiscard]]
+static bool is_primitive_start(const char c)
+{
+	return c == '-'
+		|| (c >= '0' && c <= '9')
+		|| c == 't' || c == 'f' || c == 'n';
+}
+
+[[nodiscard]]
+static bool is_primitive_end(const char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n'
+		|| c == ',' || c == ']' || c == '}';
+}
+
+static json_token_t *add_token(json_token_t *tokens, int *next, const json_type_t type,
+	const ptrdiff_t start, const ptrdiff_t end, const int parent)
+{
+	json_token_t *token = tokens + (*next)++;
+
+	*token = (json_token_t){
+		.type = type,
+		.start = start,
+		.end = end,
+		.size = 0,
+		.parent = parent,
+	};
+
+	return token;
+}
+
+/**
+ * Second stage, each branch matches jsmn_parse
+ * @param tokens Has room for at least index->token_count tokens
+ */
+[[nodiscard]]
+static int build_tokens(const char *json, const size_t len, const json_index_t *index,
+	json_token_t *tokens)
+{
+	int next = 0;
+	int super = -1;
+	size_t escape = 0;
+
+	for (size_t i = 0; i < index->structurals.count; i++)
+	{
+		const size_t pos = index->structurals.items[i];
+		const char c = json[pos];
+
+		switch (c)
+		{
+			case '{':
+			case '[':
+			{
+				json_token_t *token = add_token(tokens, &next,
+					c == '{' ? JSON_OBJECT : JSON_ARRAY, (ptrdiff_t) pos, -1, -1);
+
+				if (super != -1)
+				{
+					tokens[super].size++;
+					token->parent = super;
+				}
+
+				super = next - 1;
+				break;
+			}
+
+			case '}':
+			case ']':
+			{
+				const json_type_t type = c == '}' ? JSON_OBJECT : JSON_ARRAY;
+				if (next < 1)
+				{
+					return JSON_ERROR_INVALID;
+				}
+
+				json_token_t *token = tokens + next - 1;
+				for (;;)
+				{
+					if (token->start != -1 && token->end == -1)
+					{
+						if (token->type != type)
+						{
+							return JSON_ERROR_INVALID;
+						}
+
+						token->end = (ptrdiff_t) pos + 1;
+						super = token->parent;
+						break;
+					}
+
+					if (token->parent == -1)
+					{
+						if (token->type != type || super == -1)
+						{
+							return JSON_ERROR_INVALID;
+						}
+						break;
+					}
+
+					token = tokens + token->parent;
+				}
+				break;
+			}
+
+			case '"':
+			{
+				// Closing quote is always next
+				if (i + 1 == index->structurals.count)
+				{
+					return JSON_ERROR_INCOMPLETE;
+				}
+
+				const size_t end = index->structurals.items[++i];
+
+				for (; escape < index->escapes.count && index->escapes.items[escape] < end; escape++)
+				{
+					if (!valid_escape(json, index->escapes.items[escape], end))
+					{
+						return JSON_ERROR_INVALID;
+					}
+				}
+
+				add_token(tokens, &next, JSON_STRING, (ptrdiff_t) pos + 1, (ptrdiff_t) end, super);
+
+				if (super != -1)
+				{
+					tokens[super].size++;
+				}
+				break;
+			}
+
+			case ':':
+				super = next - 1;
+				break;
+
+			case ',':
+				if (super != -1
+					&& tokens[super].type != JSON_ARRAY
+					&& tokens[super].type != JSON_OBJECT)
+				{
+					super = tokens[super].parent;
+				}
+				break;
+
+			default:
+			{
+				// Only numbers, booleans and null, which can't be keys
+				if (!is_primitive_start(c))
+				{
+					return JSON_ERROR_INVALID;
+				}
+
+				if (super != -1 && (tokens[super].type == JSON_OBJECT
+					|| (tokens[super].type == JSON_STRING && tokens[super].size != 0)))
+				{
+					return JSON_ERROR_INVALID;
+				}
+
+				size_t end = pos;
+				for (; end < len && !is_primitive_end(json[end]); end++)
+				{
+					// Stricter than jsmn, which allows quotes and brackets inside primitives
+					if (json[end] < 32 || json[end] >= 127 || json[end] == '"'
+						|| json[end] == '{' || json[end] == '[' || json[end] == ':')
+					{
+						return JSON_ERROR_INVALID;
+					}
+				}
+
+				// Has to be followed by something, like in jsmn
+				if (end == len)
+				{
+					return JSON_ERROR_INCOMPLETE;
+				}
+
+				add_token(tokens, &next, JSON_PRIMITIVE, (ptrdiff_t) pos, (ptrdiff_t) end, super);
+
+				if (super != -1)
+				{
+					tokens[super].size++;
+				}
+				break;
+			}
+		}
+	}
+
+	for (int i = next - 1; i >= 0; i--)
+	{
+		// Unmatched opened object or array
+		if (tokens[i].start != -1 && tokens[i].end == -1)
+		{
+			return JSON_ERROR_INCOMPLETE;
+		}
+	}
+
+	return next;
+}
+
+int json_tokenize(const char *json, size_t json_len, json_token_t **tokens)
+{
+	*tokens = nullptr;
+
+	// Positions are stored as 32-bit
+	if (json_len > SDL_MAX_UINT32)
+	{
+		return JSON_ERROR_OOM;
+	}
+
+	json_index_t index = {};
+	if (!find_structurals(json, &json_len, &index))
+	{
+		SDL_free(index.structurals.items);
+		SDL_free(index.escapes.items);
+		return JSON_ERROR_OOM;
+	}
+
+	json_token_t *items = SDL_malloc(sizeof(json_token_t) * SDL_max(index.token_count, 1));
+	if (items == nullptr)
+	{
+		SDL_free(index.structurals.items);
+		SDL_free(index.escapes.items);
+		return JSON_ERROR_OOM;
+	}
+
+	const int count = build_tokens(json, json_len, &index, items);
+
+	SDL_free(index.structurals.items);
+	SDL_free(index.escapes.items);
+
+	if (count < 0)
+	{
+		SDL_free(items);
+		return count;
+	}
+
+	// Only shrinks, so the original is still valid if it fails
+	json_token_t *shrunk = SDL_realloc(items, sizeof(json_token_t) * SDL_max(count, 1));
+	*tokens = shrunk != nullptr ? shrunk : items;
+
+	return count;
+}
@@ -0,0 +1,364 @@
+#include "chirp/meshlet.h"
+#include "chirp/logcategory.h"
+#include "chirp/matrix.h"
+#include "chirp/meshopt.h"
+#include "chirp/modelinfo.h"
+#include "chirp/vector.h"
+
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct frustum_plane
+{
+	vector3f_t normal;
+	float distance;
+} frustum_plane_t;
+
+static void cluster_sphere(const Uint32 *indices, const size_t index_count,
+	const primitive_vertex_t *vertices, mesh_cluster_t *cluster)
+{
+	vector3f_t min = vertices[indices[0]].position;
+	vector3f_t max = min;
+
+	for (size_t i = 1; i < index_count; i++)
+	{
+		const vector3f_t position = vertices[indices[i]].position;
+
+		min.x = SDL_min(min.x, position.x);
+		min.y = SDL_min(min.y, position.y);
+		min.z = SDL_min(min.z, position.z);
+
+		max.x = SDL_max(max.x, position.x);
+		max.y = SDL_max(max.y, position.y);
+		max.z = SDL_max(max.z, position.z);
+	}
+
+	cluster->center = vector3f_scale(vector3f_add(min, max), 0.5F);
+
+	float radius_squared = 0.F;
+
+	for (size_t i = 0; i < index_count; i++)
+	{
+		const vector3f_t offset = vector3f_sub(vertices[indices[i]].position, cluster->center);
+		radius_squared = SDL_max(radius_squared, vector3f_dot(offset, offset));
+	}
+
+	cluster->radius = SDL_sqrtf(radius_squared);
+}
+
+[[nodiscard]]
+static bool triangle_normal(const Uint32 *triangle, const primitive_vertex_t *vertices, vector3f_t *normal)
+{
+	const vector3f_t p0 = vertices[triangle[0]].position;
+
+	const vector3f_t cross = vector3f_cross(vector3f_sub(vertices[triangle[1]].position, p0),
+		vector3f_sub(vertices[triangle[2]].position, p0));
+	const float length = SDL_sqrtf(vector3f_dot(cross, cross));
+
+	// Degenerate triangles are never drawn, so they can face anywhere
+	if (length <= 0.F)
+	{
+		return false;
+	}
+
+	*normal = vector3f_scale(cross, 1.F / length);
+	return true;
+}
+
+static void cluster_cone(const Uint32 *indices, const size_t index_count,
+	const primitive_vertex_t *vertices, mesh_cluster_t *cluster)
+{
+	// Never culled, unless all triangles face about the same way
+	cluster->cone_axis = vector3f_zero();
+	cluster->cone_cutoff = 1.F;
+
+	vector3f_t sum = vector3f_zero();
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		vector3f_t normal;
+		if (triangle_normal(indices + i, vertices, &normal))
+		{
+			sum = vector3f_add(sum, normal);
+		}
+	}
+
+	const float length = SDL_sqrtf(vector3f_dot(sum, sum));
+	if (length <= 0.F)
+	{
+		return;
+	}
+
+	const vector3f_t axis = vector3f_scale(sum, 1.F / length);
+	float min_dot = 1.F;
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		vector3f_t normal;
+		if (triangle_normal(indices + i, vertices, &normal))
+		{
+			min_dot = SDL_min(min_dot, vector3f_dot(axis, normal));
+		}
+	}
+
+	// Wider than a half sphere, some triangle always faces the camera
+	if (min_dot <= 0.F)
+	{
+		return;
+	}
+
+	cluster->cone_axis = axis;
+	cluster->cone_cutoff = SDL_sqrtf(1.F - (min_dot * min_dot));
+}
+
+bool mesh_primitive_build_clusters(mesh_primitive_t *primitive)
+{
+	SDL_free(primitive->clusters);
+	primitive->clusters = nullptr;
+	primitive->cluster_count = 0;
+
+	if (primitive->indices == nullptr
+		|| primitive->vertices == nullptr
+		|| primitive->index_count <= mesh_cluster_max_triangles * 3
+		|| primitive->index_count % 3 != 0)
+	{
+		return true;
+	}
+
+	Uint32 *indices = mesh_primitive_widen_indices(primitive);
+
+	// Index of the last cluster using each vertex
+	Uint32 *vertex_cluster = SDL_malloc(sizeof(Uint32) * primitive->vertex_count);
+
+	// At least a triangle per cluster
+	mesh_cluster_t *clusters = SDL_malloc(sizeof(mesh_cluster_t) * (primitive->index_count / 3));
+
+	if (indices == nullptr || vertex_cluster == nullptr || clusters == nullptr)
+	{
+		SDL_free(indices);
+		SDL_free(vertex_cluster);
+		SDL_free(clusters);
+		return false;
+	}
+
+	for (size_t i = 0; i < primitive->vertex_count; i++)
+	{
+		vertex_cluster[i] = SDL_MAX_UINT32;
+	}
+
+	size_t cluster_count = 0;
+	size_t cluster_vertex_count = 0;
+
+	clusters[0] = (mesh_cluster_t){};
+
+	for (size_t i = 0; i < primitive->index_count; i += 3)
+	{
+		const Uint32 *triangle = indices + i;
+		mesh_cluster_t *cluster = clusters + cluster_count;
+
+		size_t new_vertex_count = 0;
+		size_t distinct_count = 0;
+
+		for (size_t j = 0; j < 3; j++)
+		{
+			// Vertices used twice by a degenerate triangle are only counted once
+			if ((j < 1 || triangle[j] != triangle[0])
+				&& (j < 2 || triangle[j] != triangle[1]))
+			{
+				distinct_count++;
+				new_vertex_count += vertex_cluster[triangle[j]] != cluster_count ? 1 : 0;
+			}
+		}
+
+		if (cluster_vertex_count + new_vertex_count > mesh_cluster_max_vertices
+			|| cluster->index_count >= mesh_cluster_max_triangles * 3)
+		{
+			cluster_count++;
+			cluster_vertex_count = 0;
+			new_vertex_count = distinct_count;
+
+			cluster = clusters + cluster_count;
+			*cluster = (mesh_cluster_t){
+				.index_offset = i,
+			};
+		}
+
+		for (size_t j = 0; j < 3; j++)
+		{
+			vertex_cluster[triangle[j]] = (Uint32) cluster_count;
+		}
+
+		cluster_vertex_count += new_vertex_count;
+		cluster->index_count += 3;
+	}
+
+	cluster_count++;
+	SDL_free(vertex_cluster);
+
+	for (size_t i = 0; i < cluster_count; i++)
+	{
+		mesh_cluster_t *cluster = clusters + i;
+		const Uint32 *cluster_indices = indices + cluster->index_offset;
+
+		cluster_sphere(cluster_indices, cluster->index_count, primitive->vertices, cluster);
+		cluster_cone(cluster_indices, cluster->index_count, primitive->vertices, cluster);
+	}
+
+	SDL_free(indices);
+
+	// Shrink to what's actually used, keeping the larger array if that fails
+	mesh_cluster_t *used_clusters = SDL_realloc(clusters, sizeof(mesh_cluster_t) * cluster_count);
+	primitive->clusters = used_clusters != nullptr ? used_clusters : clusters;
+	primitive->cluster_count = cluster_count;
+
+	SDL_LogDebug(LOG_CATEGORY_MODEL, "Split %zu triangles into %zu clusters",
+		primitive->index_count / 3, cluster_count);
+
+	return true;
+}
+
+/**
+ * Planes of the view frustum in model space, pointing inwards and normalized,
+ * so the distance to a plane can be compared with the radius of a sphere
+ */
+static void frustum_planes(const matrix4x4_t *mvp, frustum_plane_t *planes)
+{
+	const float *m = mvp->m;
+
+	// Columns of clip space x, y, z and w, positions are transformed as row vectors
+	const vector4f_t x = {m[0], m[4], m[8], m[12]};
+	const vector4f_t y = {m[1], m[5], m[9], m[13]};
+	const vector4f_t z = {m[2], m[6], m[10], m[14]};
+	const vector4f_t w = {m[3], m[7], m[11], m[15]};
+
+	// Depth is from 0 to w
+	const vector4f_t clip_planes[] = {
+		{w.x + x.x, w.y + x.y, w.z + x.z, w.w + x.w},
+		{w.x - x.x, w.y - x.y, w.z - x.z, w.w - x.w},
+		{w.x + y.x, w.y + y.y, w.z + y.z, w.w + y.w},
+		{w.x - y.x, w.y - y.y, w.z - y.z, w.w - y.w},
+		z,
+		{w.x - z.x, w.y - z.y, w.z - z.z, w.w - z.w},
+	};
+
+	for (size_t i = 0; i < SDL_arraysize(clip_planes); i++)
+	{
+		const vector4f_t plane = clip_planes[i];
+		const vector3f_t normal = {plane.x, plane.y, plane.z};
+		const float length = SDL_sqrtf(vector3f_dot(normal, normal));
+
+		planes[i] = length > 0.F
+			? (frustum_plane_t){vector3f_scale(normal, 1.F / length), plane.w / length}
+			: (frustum_plane_t){vector3f_zero(), 0.F};
+	}
+}
+
+/**
+ * Camera position in model space, the point projected to x = y = w = 0
+ * @returns false if there is no such point, as for orthographic projections
+ */
+[[nodiscard]]
+static bool camera_position(const matrix4x4_t *mvp, vector3f_t *position)
+{
+	const float *m = mvp->m;
+
+	const vector3f_t rows[] = {
+		{m[0], m[4], m[8]},
+		{m[1], m[5], m[9]},
+		{m[3], m[7], m[11]},
+	};
+	const vector3f_t values = {-m[12], -m[13], -m[15]};
+
+	const vector3f_t cross12 = vector3f_cross(rows[1], rows[2]);
+	const vector3f_t cross20 = vector3f_cross(rows[2], rows[0]);
+	const vector3f_t cross01 = vector3f_cross(rows[0], rows[1]);
+
+	// Exactly zero if w doesn't depend on the position
+	const float determinant = vector3f_dot(rows[0], cross12);
+	if (determinant == 0.F)
+	{
+		return false;
+	}
+
+	*position = vector3f_scale(vector3f_add(vector3f_add(
+		vector3f_scale(cross12, values.x),
+		vector3f_scale(cross20, values.y)),
+		vector3f_scale(cross01, values.z)), 1.F / determinant);
+
+	return true;
+}
+
+[[nodiscard]]
+static bool cluster_visible(const mesh_cluster_t *cluster, const frustum_plane_t *planes,
+	const size_t plane_count, const bool has_camera, const vector3f_t camera)
+{
+	for (size_t i = 0; i < plane_count; i++)
+	{
+		if (vector3f_dot(planes[i].normal, cluster->center) + planes[i].distance < -cluster->radius)
+		{
+			return false;
+		}
+	}
+
+	if (!has_camera)
+	{
+		return true;
+	}
+
+	// Every point of the sphere sees all triangles from behind
+	const vector3f_t to_center = vector3f_sub(cluster->center, camera);
+	const float distance = SDL_sqrtf(vector3f_dot(to_center, to_center));
+
+	return vector3f_dot(to_center, cluster->cone_axis) <= (cluster->cone_cutoff * distance) + cluster->radius;
+}
+
+size_t mesh_primitive_cull_clusters(const mesh_primitive_t *primitive, const matrix4x4_t *mvp,
+	mesh_lod_t *ranges)
+{
+	if (primitive->cluster_count == 0)
+	{
+		ranges[0] = (mesh_lod_t){
+			.index_offset = 0,
+			.index_count = primitive->index_count,
+		};
+		return 1;
+	}
+
+	frustum_plane_t planes[6];
+	frustum_planes(mvp, planes);
+
+	vector3f_t camera = vector3f_zero();
+	const bool has_camera = camera_position(mvp, &camera);
+
+	size_t range_count = 0;
+
+	for (size_t i = 0; i < primitive->cluster_count; i++)
+	{
+		const mesh_cluster_t *cluster = primitive->clusters + i;
+
+		if (!cluster_visible(cluster, planes, SDL_arraysize(planes), has_camera, camera))
+		{
+			continue;
+		}
+
+		// Draw neighbouring clusters together
+		if (range_count > 0)
+		{
+			mesh_lod_t *previous = ranges + range_count - 1;
+			if (previous->index_offset + previous->index_count == cluster->index_offset)
+			{
+				previous->index_count += cluster->index_count;
+				continue;
+			}
+		}
+
+		ranges[range_count++] = (mesh_lod_t){
+			.index_offset = cluster->index_offset,
+			.index_count = cluster->index_count,
+		};
+	}
+
+	return range_count;
+}
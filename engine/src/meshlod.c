@@ -0,0 +1,737 @@
+#include "chirp/meshlod.h"
+#include "chirp/logcategory.h"
+#include "chirp/matrix.h"
+#include "chirp/meshopt.h"
+#include "chirp/modelinfo.h"
+#include "chirp/vector.h"
+
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+/**
+ * Sum of squared distances to planes, weighted by the area of the triangle each plane is from,
+ * as the upper triangle of a symmetric 4x4 matrix
+ */
+typedef struct quadric
+{
+	float a2, ab, ac, ad;
+	float b2, bc, bd;
+	float c2, cd;
+	float d2;
+
+	float weight;
+} quadric_t;
+
+typedef struct edge_collapse
+{
+	Uint32 from;
+	Uint32 to;
+
+	// Distance to the original surface, relative to the radius of the mesh
+	float error;
+} edge_collapse_t;
+
+typedef struct sorted_position
+{
+	vector3f_t position;
+	Uint32 vertex;
+} sorted_position_t;
+
+typedef struct simplify_state
+{
+	// Scaled to fit in a unit sphere, so errors are relative
+	vector3f_t *positions;
+	quadric_t *quadrics;
+
+	// Vertices on borders and seams, moving them would open holes
+	Uint8 *locked;
+
+	// Vertices near a collapse in the current pass, their triangles may already have changed
+	Uint8 *touched;
+	Uint32 *remap;
+
+	edge_collapse_t *collapses;
+	mesh_vertex_triangles_t adjacency;
+} simplify_state_t;
+
+static void quadric_add_plane(quadric_t *quadric, const vector3f_t normal, const float distance,
+	const float weight)
+{
+	quadric->a2 += weight * normal.x * normal.x;
+	quadric->ab += weight * normal.x * normal.y;
+	quadric->ac += weight * normal.x * normal.z;
+	quadric->ad += weight * normal.x * distance;
+	quadric->b2 += weight * normal.y * normal.y;
+	quadric->bc += weight * normal.y * normal.z;
+	quadric->bd += weight * normal.y * distance;
+	quadric->c2 += weight * normal.z * normal.z;
+	quadric->cd += weight * normal.z * distance;
+	quadric->d2 += weight * distance * distance;
+	quadric->weight += weight;
+}
+
+static void quadric_add(quadric_t *quadric, const quadric_t *other)
+{
+	quadric->a2 += other->a2;
+	quadric->ab += other->ab;
+	quadric->ac += other->ac;
+	quadric->ad += other->ad;
+	quadric->b2 += other->b2;
+	quadric->bc += other->bc;
+	quadric->bd += other->bd;
+	quadric->c2 += other->c2;
+	quadric->cd += other->cd;
+	quadric->d2 += other->d2;
+	quadric->weight += other->weight;
+}
+
+/**
+ * Weighted average of squared distances from the position to all planes
+ */
+[[nodiscard]]
+static float quadric_error(const quadric_t *quadric, const vector3f_t position)
+{
+	if (quadric->weight <= 0.F)
+	{
+		return 0.F;
+	}
+
+	const float x = position.x;
+	const float y = position.y;
+	const float z = position.z;
+
+	const float error = (quadric->a2 * x * x) + (quadric->b2 * y * y) + (quadric->c2 * z * z)
+		+ (2.F * ((quadric->ab * x * y) + (quadric->ac * x * z) + (quadric->bc * y * z)))
+		+ (2.F * ((quadric->ad * x) + (quadric->bd * y) + (quadric->cd * z)))
+		+ quadric->d2;
+
+	// Rounding can make it slightly negative
+	return SDL_max(error, 0.F) / quadric->weight;
+}
+
+static void free_simplify_state(const simplify_state_t *state)
+{
+	SDL_free(state->positions);
+	SDL_free(state->quadrics);
+	SDL_free(state->locked);
+	SDL_free(state->touched);
+	SDL_free(state->remap);
+	SDL_free(state->collapses);
+	mesh_free_vertex_triangles(&state->adjacency);
+}
+
+[[nodiscard]]
+static bool create_simplify_state(const size_t index_count, const size_t vertex_count,
+	simplify_state_t *state)
+{
+	*state = (simplify_state_t){
+		.positions = SDL_malloc(sizeof(vector3f_t) * vertex_count),
+		.quadrics = SDL_calloc(vertex_count, sizeof(quadric_t)),
+		.locked = SDL_calloc(vertex_count, sizeof(Uint8)),
+		.touched = SDL_malloc(sizeof(Uint8) * vertex_count),
+		.remap = SDL_malloc(sizeof(Uint32) * vertex_count),
+		.collapses = SDL_malloc(sizeof(edge_collapse_t) * SDL_max(index_count, 1)),
+	};
+
+	return state->positions != nullptr
+		&& state->quadrics != nullptr
+		&& state->locked != nullptr
+		&& state->touched != nullptr
+		&& state->remap != nullptr
+		&& state->collapses != nullptr;
+}
+
+static void scale_positions(const primitive_vertex_t *vertices, const size_t vertex_count,
+	vector3f_t *positions)
+{
+	vector3f_t min = vertices[0].position;
+	vector3f_t max = min;
+
+	for (size_t i = 1; i < vertex_count; i++)
+	{
+		const vector3f_t position = vertices[i].position;
+
+		min.x = SDL_min(min.x, position.x);
+		min.y = SDL_min(min.y, position.y);
+		min.z = SDL_min(min.z, position.z);
+
+		max.x = SDL_max(max.x, position.x);
+		max.y = SDL_max(max.y, position.y);
+		max.z = SDL_max(max.z, position.z);
+	}
+
+	const vector3f_t center = vector3f_scale(vector3f_add(min, max), 0.5F);
+	const vector3f_t extent = vector3f_sub(max, center);
+	const float radius = SDL_sqrtf(vector3f_dot(extent, extent));
+	const float scale = radius > 0.F ? 1.F / radius : 1.F;
+
+	for (size_t i = 0; i < vertex_count; i++)
+	{
+		positions[i] = vector3f_scale(vector3f_sub(vertices[i].position, center), scale);
+	}
+}
+
+static void add_triangle_quadrics(const Uint32 *indices, const size_t index_count,
+	const vector3f_t *positions, quadric_t *quadrics)
+{
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		const vector3f_t p0 = positions[indices[i + 0]];
+		const vector3f_t p1 = positions[indices[i + 1]];
+		const vector3f_t p2 = positions[indices[i + 2]];
+
+		const vector3f_t normal = vector3f_cross(vector3f_sub(p1, p0), vector3f_sub(p2, p0));
+		const float length = SDL_sqrtf(vector3f_dot(normal, normal));
+
+		if (length <= 0.F)
+		{
+			continue;
+		}
+
+		const vector3f_t unit_normal = vector3f_scale(normal, 1.F / length);
+		const float distance = -vector3f_dot(unit_normal, p0);
+
+		// Length of the cross product is twice the area
+		for (size_t j = 0; j < 3; j++)
+		{
+			quadric_add_plane(quadrics + indices[i + j], unit_normal, distance, length * 0.5F);
+		}
+	}
+}
+
+static int compare_edges(const void *a, const void *b)
+{
+	const Uint64 edge_a = *(const Uint64*) a;
+	const Uint64 edge_b = *(const Uint64*) b;
+	return edge_a < edge_b ? -1 : (edge_a > edge_b ? 1 : 0);
+}
+
+/**
+ * Lock vertices on edges that aren't shared by exactly two triangles,
+ * which includes seams, as vertices there are split
+ */
+[[nodiscard]]
+static bool lock_border_vertices(const Uint32 *indices, const size_t index_count, Uint8 *locked)
+{
+	Uint64 *edges = SDL_malloc(sizeof(Uint64) * SDL_max(index_count, 1));
+	if (edges == nullptr)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < index_count; i++)
+	{
+		const Uint32 a = indices[i];
+		const Uint32 b = indices[(i % 3) == 2 ? i - 2 : i + 1];
+
+		edges[i] = ((Uint64) SDL_min(a, b) << 32) | SDL_max(a, b);
+	}
+
+	SDL_qsort(edges, index_count, sizeof(Uint64), compare_edges);
+
+	for (size_t i = 0; i < index_count;)
+	{
+		size_t count = 1;
+		while (i + count < index_count && edges[i + count] == edges[i])
+		{
+			count++;
+		}
+
+		if (count != 2)
+		{
+			locked[edges[i] >> 32] = 1;
+			locked[edges[i] & SDL_MAX_UINT32] = 1;
+		}
+
+		i += count;
+	}
+
+	SDL_free(edges);
+	return true;
+}
+
+static int compare_positions(const void *a, const void *b)
+{
+	const vector3f_t position_a = ((const sorted_position_t*) a)->position;
+	const vector3f_t position_b = ((const sorted_position_t*) b)->position;
+
+	if (position_a.x != position_b.x)
+	{
+		return position_a.x < position_b.x ? -1 : 1;
+	}
+
+	if (position_a.y != position_b.y)
+	{
+		return position_a.y < position_b.y ? -1 : 1;
+	}
+
+	if (position_a.z != position_b.z)
+	{
+		return position_a.z < position_b.z ? -1 : 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Lock vertices sharing a position with another vertex, moving only one of them opens a crack
+ */
+[[nodiscard]]
+static bool lock_split_vertices(const primitive_vertex_t *vertices, const size_t vertex_count,
+	Uint8 *locked)
+{
+	sorted_position_t *sorted = SDL_malloc(sizeof(sorted_position_t) * vertex_count);
+	if (sorted == nullptr)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < vertex_count; i++)
+	{
+		sorted[i] = (sorted_position_t){
+			.position = vertices[i].position,
+			.vertex = (Uint32) i,
+		};
+	}
+
+	SDL_qsort(sorted, vertex_count, sizeof(sorted_position_t), compare_positions);
+
+	for (size_t i = 1; i < vertex_count; i++)
+	{
+		if (compare_positions(sorted + i - 1, sorted + i) == 0)
+		{
+			locked[sorted[i - 1].vertex] = 1;
+			locked[sorted[i].vertex] = 1;
+		}
+	}
+
+	SDL_free(sorted);
+	return true;
+}
+
+[[nodiscard]]
+static float collapse_error(const simplify_state_t *state, const Uint32 from, const Uint32 to)
+{
+	quadric_t quadric = state->quadrics[from];
+	quadric_add(&quadric, state->quadrics + to);
+
+	return SDL_sqrtf(quadric_error(&quadric, state->positions[to]));
+}
+
+/**
+ * Cheapest direction to collapse each edge in, edges are only added from the triangle
+ * where the first vertex has the lower index, so shared edges are only added once
+ */
+[[nodiscard]]
+static size_t find_collapses(const simplify_state_t *state, const Uint32 *indices,
+	const size_t index_count)
+{
+	size_t collapse_count = 0;
+
+	for (size_t i = 0; i < index_count; i++)
+	{
+		const Uint32 a = indices[i];
+		const Uint32 b = indices[(i % 3) == 2 ? i - 2 : i + 1];
+
+		if (a >= b || (state->locked[a] != 0 && state->locked[b] != 0))
+		{
+			continue;
+		}
+
+		// Only vertices that aren't locked can move
+		const bool a_moves = state->locked[a] == 0;
+		const bool b_moves = state->locked[b] == 0;
+
+		const float error_ab = a_moves ? collapse_error(state, a, b) : 0.F;
+		const float error_ba = b_moves ? collapse_error(state, b, a) : 0.F;
+
+		state->collapses[collapse_count++] = a_moves && (!b_moves || error_ab <= error_ba)
+			? (edge_collapse_t){.from = a, .to = b, .error = error_ab}
+			: (edge_collapse_t){.from = b, .to = a, .error = error_ba};
+	}
+
+	return collapse_count;
+}
+
+static int compare_collapses(const void *a, const void *b)
+{
+	const float error_a = ((const edge_collapse_t*) a)->error;
+	const float error_b = ((const edge_collapse_t*) b)->error;
+	return error_a < error_b ? -1 : (error_a > error_b ? 1 : 0);
+}
+
+/**
+ * Moving from onto to shouldn't turn any remaining triangle around, or flatten it into a line
+ */
+[[nodiscard]]
+static bool collapse_flips(const simplify_state_t *state, const Uint32 *indices,
+	const Uint32 from, const Uint32 to)
+{
+	const mesh_vertex_triangles_t *adjacency = &state->adjacency;
+
+	for (Uint32 i = adjacency->offsets[from]; i < adjacency->offsets[from + 1]; i++)
+	{
+		const Uint32 *triangle = indices + ((size_t) adjacency->triangles[i] * 3);
+
+		// Removed by the collapse
+		if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+		{
+			continue;
+		}
+
+		vector3f_t before[3];
+		vector3f_t after[3];
+
+		for (size_t j = 0; j < 3; j++)
+		{
+			before[j] = state->positions[triangle[j]];
+			after[j] = state->positions[triangle[j] == from ? to : triangle[j]];
+		}
+
+		const vector3f_t normal_before = vector3f_cross(vector3f_sub(before[1], before[0]),
+			vector3f_sub(before[2], before[0]));
+		const vector3f_t normal_after = vector3f_cross(vector3f_sub(after[1], after[0]),
+			vector3f_sub(after[2], after[0]));
+
+		// Collinear vertices don't always give exactly zero after rounding
+		if (vector3f_dot(normal_before, normal_after) <= 0.01F * vector3f_dot(normal_before, normal_before))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Collapse the cheapest edges that don't touch each other, cheapest first
+ * @returns Number of indices left
+ */
+[[nodiscard]]
+static size_t simplify_pass(simplify_state_t *state, Uint32 *indices, const size_t index_count,
+	const size_t vertex_count, const size_t target_index_count, const float target_error,
+	float *result_error)
+{
+	const size_t collapse_count = find_collapses(state, indices, index_count);
+	SDL_qsort(state->collapses, collapse_count, sizeof(edge_collapse_t), compare_collapses);
+
+	for (size_t i = 0; i < vertex_count; i++)
+	{
+		state->touched[i] = 0;
+		state->remap[i] = (Uint32) i;
+	}
+
+	const mesh_vertex_triangles_t *adjacency = &state->adjacency;
+	size_t triangle_count = index_count / 3;
+	size_t collapsed = 0;
+
+	for (size_t i = 0; i < collapse_count; i++)
+	{
+		const edge_collapse_t *collapse = state->collapses + i;
+
+		if (collapse->error > target_error || triangle_count * 3 <= target_index_count)
+		{
+			break;
+		}
+
+		if (state->touched[collapse->from] != 0
+			|| state->touched[collapse->to] != 0
+			|| collapse_flips(state, indices, collapse->from, collapse->to))
+		{
+			continue;
+		}
+
+		for (Uint32 j = adjacency->offsets[collapse->from]; j < adjacency->offsets[collapse->from + 1]; j++)
+		{
+			const Uint32 *triangle = indices + ((size_t) adjacency->triangles[j] * 3);
+
+			for (size_t k = 0; k < 3; k++)
+			{
+				state->touched[triangle[k]] = 1;
+			}
+
+			if (triangle[0] == collapse->to || triangle[1] == collapse->to || triangle[2] == collapse->to)
+			{
+				triangle_count--;
+			}
+		}
+
+		state->remap[collapse->from] = collapse->to;
+		quadric_add(state->quadrics + collapse->to, state->quadrics + collapse->from);
+
+		*result_error = SDL_max(*result_error, collapse->error);
+		collapsed++;
+	}
+
+	if (collapsed == 0)
+	{
+		return index_count;
+	}
+
+	size_t result_count = 0;
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		const Uint32 a = state->remap[indices[i + 0]];
+		const Uint32 b = state->remap[indices[i + 1]];
+		const Uint32 c = state->remap[indices[i + 2]];
+
+		if (a == b || b == c || c == a)
+		{
+			continue;
+		}
+
+		indices[result_count++] = a;
+		indices[result_count++] = b;
+		indices[result_count++] = c;
+	}
+
+	return result_count;
+}
+
+bool mesh_simplify(Uint32 *destination, const Uint32 *indices, const size_t index_count,
+	const primitive_vertex_t *vertices, const size_t vertex_count, const size_t target_index_count,
+	const float target_error, size_t *result_count, float *result_error)
+{
+	if (destination != indices)
+	{
+		SDL_memcpy(destination, indices, sizeof(Uint32) * index_count);
+	}
+
+	*result_count = index_count;
+	*result_error = 0.F;
+
+	if (index_count <= target_index_count || vertex_count == 0)
+	{
+		return true;
+	}
+
+	simplify_state_t state;
+	if (!create_simplify_state(index_count, vertex_count, &state)
+		|| !lock_border_vertices(destination, index_count, state.locked)
+		|| !lock_split_vertices(vertices, vertex_count, state.locked))
+	{
+		free_simplify_state(&state);
+		return false;
+	}
+
+	scale_positions(vertices, vertex_count, state.positions);
+	add_triangle_quadrics(destination, index_count, state.positions, state.quadrics);
+
+	size_t count = index_count;
+
+	while (count > target_index_count)
+	{
+		mesh_free_vertex_triangles(&state.adjacency);
+		if (!mesh_build_vertex_triangles(destination, count, vertex_count, &state.adjacency))
+		{
+			free_simplify_state(&state);
+			return false;
+		}
+
+		const size_t pass_count = simplify_pass(&state, destination, count, vertex_count,
+			target_index_count, target_error, result_error);
+
+		// Nothing left that can be collapsed without too much error
+		if (pass_count == count)
+		{
+			break;
+		}
+
+		count = pass_count;
+	}
+
+	free_simplify_state(&state);
+
+	*result_count = count;
+	return true;
+}
+
+bool mesh_primitive_generate_lods(mesh_primitive_t *primitive, const float *ratios,
+	const size_t ratio_count)
+{
+	primitive->lod_count = 0;
+
+	if (ratio_count == 0
+		|| primitive->indices == nullptr
+		|| primitive->vertices == nullptr
+		|| primitive->index_count < mesh_lod_min_triangles * 3
+		|| primitive->index_count % 3 != 0)
+	{
+		return true;
+	}
+
+	const size_t level_count = SDL_min(ratio_count, mesh_max_lods);
+
+	Uint32 *indices = mesh_primitive_widen_indices(primitive);
+	Uint32 *lod_indices = SDL_malloc(sizeof(Uint32) * primitive->index_count * level_count);
+
+	if (indices == nullptr || lod_indices == nullptr)
+	{
+		SDL_free(indices);
+		SDL_free(lod_indices);
+		return false;
+	}
+
+	const Uint32 *source = indices;
+	size_t source_count = primitive->index_count;
+	size_t lod_index_count = 0;
+
+	for (size_t i = 0; i < level_count; i++)
+	{
+		const size_t target_count = (size_t) ((float) (primitive->index_count / 3) * ratios[i]) * 3;
+		Uint32 *target = lod_indices + lod_index_count;
+
+		size_t count;
+		float error;
+
+		if (!mesh_simplify(target, source, source_count, primitive->vertices, primitive->vertex_count,
+			target_count, mesh_lod_max_error, &count, &error))
+		{
+			SDL_free(indices);
+			SDL_free(lod_indices);
+			return false;
+		}
+
+		// Not worth the memory if it's barely any cheaper to draw
+		if (count * 10 > source_count * 9)
+		{
+			break;
+		}
+
+		if (!mesh_optimize_vertex_cache(target, count, primitive->vertex_count, mesh_cache_size))
+		{
+			SDL_free(indices);
+			SDL_free(lod_indices);
+			return false;
+		}
+
+		SDL_LogDebug(LOG_CATEGORY_MODEL, "Simplified level of detail %zu: %zu -> %zu triangles, "
+			"error %.4f", i + 1, primitive->index_count / 3, count / 3, (double) error);
+
+		primitive->lods[i] = (mesh_lod_t){
+			.index_offset = primitive->index_count + lod_index_count,
+			.index_count = count,
+		};
+		primitive->lod_count++;
+
+		source = target;
+		source_count = count;
+		lod_index_count += count;
+	}
+
+	SDL_free(indices);
+
+	if (primitive->lod_count == 0)
+	{
+		SDL_free(lod_indices);
+		return true;
+	}
+
+	Uint8 *all_indices = SDL_realloc(primitive->indices,
+		primitive->index_size * (primitive->index_count + lod_index_count));
+
+	if (all_indices == nullptr)
+	{
+		primitive->lod_count = 0;
+		SDL_free(lod_indices);
+		return false;
+	}
+
+	mesh_narrow_indices(lod_indices, lod_index_count, primitive->index_size,
+		all_indices + (primitive->index_size * primitive->index_count));
+	SDL_free(lod_indices);
+
+	primitive->indices = all_indices;
+	return true;
+}
+
+mesh_lod_t mesh_primitive_lod(const mesh_primitive_t *primitive, const size_t level)
+{
+	if (level == 0 || primitive->lod_count == 0)
+	{
+		return (mesh_lod_t){
+			.index_offset = 0,
+			.index_count = primitive->index_count,
+		};
+	}
+
+	return primitive->lods[SDL_min(level, primitive->lod_count) - 1];
+}
+
+float mesh_screen_size(const model_mesh_t *mesh, const matrix4x4_t *mvp)
+{
+	if (mesh->primitive_count == 0)
+	{
+		return 0.F;
+	}
+
+	vector3f_t min = mesh->primitives[0].bounds_min;
+	vector3f_t max = mesh->primitives[0].bounds_max;
+
+	for (size_t i = 1; i < mesh->primitive_count; i++)
+	{
+		const mesh_primitive_t *primitive = mesh->primitives + i;
+
+		min.x = SDL_min(min.x, primitive->bounds_min.x);
+		min.y = SDL_min(min.y, primitive->bounds_min.y);
+		min.z = SDL_min(min.z, primitive->bounds_min.z);
+
+		max.x = SDL_max(max.x, primitive->bounds_max.x);
+		max.y = SDL_max(max.y, primitive->bounds_max.y);
+		max.z = SDL_max(max.z, primitive->bounds_max.z);
+	}
+
+	const vector3f_t center = vector3f_scale(vector3f_add(min, max), 0.5F);
+	const vector3f_t extent = vector3f_sub(max, center);
+	const float radius = SDL_sqrtf(vector3f_dot(extent, extent));
+
+	const float *m = mvp->m;
+	const float w = (center.x * m[3]) + (center.y * m[7]) + (center.z * m[11]) + m[15];
+
+	// Largest change in clip space for a unit change in model space, including scale
+	const float scale_y = SDL_sqrtf((m[1] * m[1]) + (m[5] * m[5]) + (m[9] * m[9]));
+	const float scale_w = SDL_sqrtf((m[3] * m[3]) + (m[7] * m[7]) + (m[11] * m[11]));
+
+	// Camera is inside, or the mesh is behind it, either way it may cover the screen
+	if (w <= radius * scale_w)
+	{
+		return 1.F;
+	}
+
+	// Normalized device coordinates span two, as does the diameter
+	return radius * scale_y / w;
+}
+
+float mesh_lod_screen_size(const float previous, const float size)
+{
+	if (previous > 0.F
+		&& size >= previous * (1.F - mesh_lod_hysteresis)
+		&& size <= previous * (1.F + mesh_lod_hysteresis))
+	{
+		return previous;
+	}
+
+	return size;
+}
+
+size_t mesh_primitive_select_lod(const mesh_primitive_t *primitive, const float screen_size)
+{
+	size_t level = 0;
+
+	for (size_t i = 0; i < primitive->lod_count; i++)
+	{
+		// Triangles cover an area, so halving the size allows a quarter of the triangles
+		const float ratio = (float) primitive->lods[i].index_count / (float) primitive->index_count;
+		if (screen_size > mesh_lod_detail_size * SDL_sqrtf(ratio))
+		{
+			break;
+		}
+
+		level = i + 1;
+	}
+
+	return level;
+}
@@ -0,0 +1,666 @@
+#include "chirp/meshopt.h"
+#include "chirp/logcategory.h"
+#include "chirp/modelinfo.h"
+#include "chirp/vector.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+// Recommended by meshoptimizer, a few more vertex transforms for a lot less overdraw
+static constexpr float overdraw_threshold = 1.05F;
+
+/**
+ * A vertex is in the cache if it was added within the last cache_size misses,
+ * start with all timestamps zeroed, and time at cache_size + 1
+ * @returns Number of vertices that weren't in the cache
+ */
+static Uint32 update_cache(const Uint32 *triangle, const size_t cache_size,
+	Uint32 *timestamps, Uint32 *time)
+{
+	Uint32 misses = 0;
+
+	for (size_t i = 0; i < 3; i++)
+	{
+		const Uint32 vertex = triangle[i];
+
+		if (*time - timestamps[vertex] > cache_size)
+		{
+			timestamps[vertex] = (*time)++;
+			misses++;
+		}
+	}
+
+	return misses;
+}
+
+mesh_cache_stats_t mesh_analyze_vertex_cache(const Uint32 *indices, const size_t index_count,
+	const size_t vertex_count, const size_t cache_size)
+{
+	mesh_cache_stats_t stats = {};
+
+	const size_t triangle_count = index_count / 3;
+	if (triangle_count == 0)
+	{
+		return stats;
+	}
+
+	Uint32 *timestamps = SDL_calloc(vertex_count, sizeof(Uint32));
+	if (timestamps == nullptr)
+	{
+		return stats;
+	}
+
+	Uint32 time = (Uint32) cache_size + 1;
+	size_t misses = 0;
+
+	for (size_t i = 0; i < triangle_count; i++)
+	{
+		misses += update_cache(indices + (i * 3), cache_size, timestamps, &time);
+	}
+
+	// Only vertices that are used, never transformed otherwise
+	size_t used_count = 0;
+	for (size_t i = 0; i < vertex_count; i++)
+	{
+		used_count += timestamps[i] != 0 ? 1 : 0;
+	}
+
+	SDL_free(timestamps);
+
+	stats.acmr = (float) misses / (float) triangle_count;
+	stats.atvr = (float) misses / (float) used_count;
+
+	return stats;
+}
+
+bool mesh_build_vertex_triangles(const Uint32 *indices, const size_t index_count,
+	const size_t vertex_count, mesh_vertex_triangles_t *adjacency)
+{
+	adjacency->offsets = SDL_calloc(vertex_count + 1, sizeof(Uint32));
+	adjacency->triangles = SDL_malloc(sizeof(Uint32) * SDL_max(index_count, 1));
+
+	if (adjacency->offsets == nullptr || adjacency->triangles == nullptr)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < index_count; i++)
+	{
+		adjacency->offsets[indices[i] + 1]++;
+	}
+
+	for (size_t i = 0; i < vertex_count; i++)
+	{
+		adjacency->offsets[i + 1] += adjacency->offsets[i];
+	}
+
+	// Offsets are moved forward while filling, and moved back afterwards
+	for (size_t i = 0; i < index_count; i++)
+	{
+		adjacency->triangles[adjacency->offsets[indices[i]]++] = (Uint32) (i / 3);
+	}
+
+	for (size_t i = vertex_count; i > 0; i--)
+	{
+		adjacency->offsets[i] = adjacency->offsets[i - 1];
+	}
+	adjacency->offsets[0] = 0;
+
+	return true;
+}
+
+void mesh_free_vertex_triangles(const mesh_vertex_triangles_t *adjacency)
+{
+	SDL_free(adjacency->offsets);
+	SDL_free(adjacency->triangles);
+}
+
+typedef struct tipsify_state
+{
+	const Uint32 *indices;
+	size_t vertex_count;
+	size_t cache_size;
+
+	mesh_vertex_triangles_t adjacency;
+
+	// Triangles not yet emitted, for each vertex
+	Uint32 *live_count;
+	Uint32 *timestamps;
+	Uint32 time;
+
+	bool *emitted;
+
+	// Recently used vertices, to continue from when there's nothing left around the current one
+	Uint32 *dead_end;
+	size_t dead_end_size;
+
+	// Next vertex in input order to continue from, once the dead end stack is empty
+	size_t cursor;
+} tipsify_state_t;
+
+/**
+ * Prefer vertices that are still in the cache, and will stay there after emitting their triangles
+ * @param candidates Vertices of the triangles that were just emitted
+ * @returns Vertex, or -1 if all triangles have been emitted
+ */
+[[nodiscard]]
+static Sint64 next_vertex(tipsify_state_t *state, const Uint32 *candidates, const size_t candidate_count)
+{
+	Sint64 best_vertex = -1;
+	Sint64 best_priority = -1;
+
+	for (size_t i = 0; i < candidate_count; i++)
+	{
+		const Uint32 vertex = candidates[i];
+		const Uint32 live_count = state->live_count[vertex];
+
+		if (live_count == 0)
+		{
+			continue;
+		}
+
+		const Uint32 age = state->time - state->timestamps[vertex];
+		const Sint64 priority = age + (2 * live_count) <= state->cache_size ? age : 0;
+
+		if (priority > best_priority)
+		{
+			best_vertex = vertex;
+			best_priority = priority;
+		}
+	}
+
+	if (best_vertex >= 0)
+	{
+		return best_vertex;
+	}
+
+	while (state->dead_end_size > 0)
+	{
+		const Uint32 vertex = state->dead_end[--state->dead_end_size];
+		if (state->live_count[vertex] > 0)
+		{
+			return vertex;
+		}
+	}
+
+	for (; state->cursor < state->vertex_count; state->cursor++)
+	{
+		if (state->live_count[state->cursor] > 0)
+		{
+			return (Sint64) state->cursor;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * Emit all remaining triangles using the vertex
+ * @returns Number of indices written
+ */
+static size_t emit_triangles(tipsify_state_t *state, const Uint32 vertex, Uint32 *destination)
+{
+	size_t count = 0;
+
+	for (Uint32 i = state->adjacency.offsets[vertex]; i < state->adjacency.offsets[vertex + 1]; i++)
+	{
+		const Uint32 triangle = state->adjacency.triangles[i];
+		if (state->emitted[triangle])
+		{
+			continue;
+		}
+
+		for (size_t j = 0; j < 3; j++)
+		{
+			const Uint32 index = state->indices[(triangle * 3) + j];
+
+			destination[count++] = index;
+			state->dead_end[state->dead_end_size++] = index;
+			state->live_count[index]--;
+
+			if (state->time - state->timestamps[index] > state->cache_size)
+			{
+				state->timestamps[index] = state->time++;
+			}
+		}
+
+		state->emitted[triangle] = true;
+	}
+
+	return count;
+}
+
+bool mesh_optimize_vertex_cache(Uint32 *indices, const size_t index_count,
+	const size_t vertex_count, const size_t cache_size)
+{
+	if (index_count > SDL_MAX_UINT32)
+	{
+		return SDL_SetError("Too many indices: %zu", index_count);
+	}
+
+	tipsify_state_t state = {
+		.indices = indices,
+		.vertex_count = vertex_count,
+		.cache_size = cache_size,
+		.time = (Uint32) cache_size + 1,
+	};
+
+	state.live_count = SDL_calloc(vertex_count + 1, sizeof(Uint32));
+	state.timestamps = SDL_calloc(vertex_count + 1, sizeof(Uint32));
+	state.emitted = SDL_calloc((index_count / 3) + 1, sizeof(bool));
+	state.dead_end = SDL_malloc(sizeof(Uint32) * (index_count + 1));
+
+	Uint32 *result = SDL_malloc(sizeof(Uint32) * (index_count + 1));
+
+	const bool success = state.live_count != nullptr
+		&& state.timestamps != nullptr
+		&& state.emitted != nullptr
+		&& state.dead_end != nullptr
+		&& result != nullptr
+		&& mesh_build_vertex_triangles(indices, index_count, vertex_count, &state.adjacency);
+
+	if (success)
+	{
+		for (size_t i = 0; i < index_count; i++)
+		{
+			state.live_count[indices[i]]++;
+		}
+
+		size_t result_count = 0;
+		Sint64 vertex = vertex_count > 0 ? 0 : -1;
+
+		while (vertex >= 0)
+		{
+			const size_t emitted = emit_triangles(&state, (Uint32) vertex, result + result_count);
+			vertex = next_vertex(&state, result + result_count, emitted);
+			result_count += emitted;
+		}
+
+		SDL_memcpy(indices, result, sizeof(Uint32) * result_count);
+	}
+
+	mesh_free_vertex_triangles(&state.adjacency);
+	SDL_free(state.live_count);
+	SDL_free(state.timestamps);
+	SDL_free(state.emitted);
+	SDL_free(state.dead_end);
+	SDL_free(result);
+
+	return success;
+}
+
+/**
+ * Split where all vertices of a triangle miss the cache,
+ * as that's usually where a new, disconnected part of the mesh starts
+ * @returns Number of clusters
+ */
+static size_t find_hard_boundaries(const Uint32 *indices, const size_t triangle_count,
+	const size_t cache_size, Uint32 *timestamps, Uint32 *clusters)
+{
+	Uint32 time = (Uint32) cache_size + 1;
+	size_t count = 0;
+
+	for (size_t i = 0; i < triangle_count; i++)
+	{
+		const Uint32 misses = update_cache(indices + (i * 3), cache_size, timestamps, &time);
+
+		if (i == 0 || misses == 3)
+		{
+			clusters[count++] = (Uint32) i;
+		}
+	}
+
+	return count;
+}
+
+/**
+ * Split each cluster further, as soon as the cache miss ratio so far is close enough to that of the whole cluster
+ * @returns Number of clusters
+ */
+static size_t find_soft_boundaries(const Uint32 *indices, const size_t triangle_count,
+	const Uint32 *hard_clusters, const size_t hard_count, const size_t cache_size,
+	const float threshold, Uint32 *timestamps, Uint32 *clusters)
+{
+	// Timestamps are kept, but moved forward to clear the cache
+	Uint32 time = 0;
+	size_t count = 0;
+
+	for (size_t i = 0; i < hard_count; i++)
+	{
+		const size_t start = hard_clusters[i];
+		const size_t end = i + 1 < hard_count ? hard_clusters[i + 1] : triangle_count;
+
+		time += (Uint32) cache_size + 1;
+		Uint32 cluster_misses = 0;
+
+		for (size_t j = start; j < end; j++)
+		{
+			cluster_misses += update_cache(indices + (j * 3), cache_size, timestamps, &time);
+		}
+
+		const float cluster_threshold = threshold * ((float) cluster_misses / (float) (end - start));
+
+		clusters[count++] = (Uint32) start;
+
+		time += (Uint32) cache_size + 1;
+		Uint32 running_misses = 0;
+		Uint32 running_triangles = 0;
+
+		for (size_t j = start; j < end; j++)
+		{
+			running_misses += update_cache(indices + (j * 3), cache_size, timestamps, &time);
+			running_triangles++;
+
+			if ((float) running_misses / (float) running_triangles <= cluster_threshold)
+			{
+				clusters[count++] = (Uint32) (j + 1);
+
+				time += (Uint32) cache_size + 1;
+				running_misses = 0;
+				running_triangles = 0;
+			}
+		}
+
+		// Whatever is left at the end is usually a poor cluster, so it's merged with the previous one,
+		// this also removes the boundary at the end of the cluster, if there is one
+		if (clusters[count - 1] != start)
+		{
+			count--;
+		}
+	}
+
+	return count;
+}
+
+typedef struct triangle_cluster
+{
+	Uint32 start;
+	Uint32 end;
+
+	// Larger is further out, and facing away from the center
+	float sort_key;
+} triangle_cluster_t;
+
+[[nodiscard]]
+static vector3f_t mesh_centroid(const primitive_vertex_t *vertices, const size_t vertex_count)
+{
+	vector3f_t centroid = vector3f_zero();
+
+	for (size_t i = 0; i < vertex_count; i++)
+	{
+		centroid = vector3f_add(centroid, vertices[i].position);
+	}
+
+	return vertex_count > 0
+		? vector3f_scale(centroid, 1.F / (float) vertex_count)
+		: centroid;
+}
+
+/**
+ * How far out the area-weighted center of the cluster is, along its average normal
+ */
+[[nodiscard]]
+static float cluster_sort_key(const Uint32 *indices, const triangle_cluster_t *cluster,
+	const primitive_vertex_t *vertices, const vector3f_t mesh_center)
+{
+	vector3f_t center = vector3f_zero();
+	vector3f_t normal = vector3f_zero();
+	float total_area = 0.F;
+
+	for (Uint32 i = cluster->start; i < cluster->end; i++)
+	{
+		const vector3f_t p0 = vertices[indices[(i * 3) + 0]].position;
+		const vector3f_t p1 = vertices[indices[(i * 3) + 1]].position;
+		const vector3f_t p2 = vertices[indices[(i * 3) + 2]].position;
+
+		const vector3f_t cross = vector3f_cross(vector3f_sub(p1, p0), vector3f_sub(p2, p0));
+		const float area = SDL_sqrtf(vector3f_dot(cross, cross));
+
+		const vector3f_t triangle_center = vector3f_scale(vector3f_add(vector3f_add(p0, p1), p2), 1.F / 3.F);
+
+		center = vector3f_add(center, vector3f_scale(triangle_center, area));
+		normal = vector3f_add(normal, cross);
+		total_area += area;
+	}
+
+	const float normal_length = SDL_sqrtf(vector3f_dot(normal, normal));
+	if (total_area <= 0.F || normal_length <= 0.F)
+	{
+		return 0.F;
+	}
+
+	center = vector3f_scale(center, 1.F / total_area);
+	normal = vector3f_scale(normal, 1.F / normal_length);
+
+	return vector3f_dot(vector3f_sub(center, mesh_center), normal);
+}
+
+static int compare_clusters(const void *a, const void *b)
+{
+	const triangle_cluster_t *cluster_a = a;
+	const triangle_cluster_t *cluster_b = b;
+
+	// Descending, ties keep their original order
+	if (cluster_a->sort_key != cluster_b->sort_key)
+	{
+		return cluster_a->sort_key < cluster_b->sort_key ? 1 : -1;
+	}
+
+	return (cluster_a->start > cluster_b->start) - (cluster_a->start < cluster_b->start);
+}
+
+bool mesh_optimize_overdraw(Uint32 *indices, const size_t index_count,
+	const primitive_vertex_t *vertices, const size_t vertex_count, const size_t cache_size,
+	const float threshold)
+{
+	if (index_count > SDL_MAX_UINT32)
+	{
+		return SDL_SetError("Too many indices: %zu", index_count);
+	}
+
+	const size_t triangle_count = index_count / 3;
+	if (triangle_count == 0)
+	{
+		return true;
+	}
+
+	Uint32 *timestamps = SDL_calloc(vertex_count, sizeof(Uint32));
+	Uint32 *hard_clusters = SDL_malloc(sizeof(Uint32) * triangle_count);
+	Uint32 *soft_clusters = SDL_malloc(sizeof(Uint32) * (triangle_count + 1));
+	triangle_cluster_t *clusters = SDL_malloc(sizeof(triangle_cluster_t) * (triangle_count + 1));
+	Uint32 *result = SDL_malloc(sizeof(Uint32) * index_count);
+
+	const bool success = timestamps != nullptr
+		&& hard_clusters != nullptr
+		&& soft_clusters != nullptr
+		&& clusters != nullptr
+		&& result != nullptr;
+
+	if (success)
+	{
+		const size_t hard_count = find_hard_boundaries(indices, triangle_count, cache_size,
+			timestamps, hard_clusters);
+
+		SDL_memset(timestamps, 0, sizeof(Uint32) * vertex_count);
+
+		const size_t cluster_count = find_soft_boundaries(indices, triangle_count, hard_clusters,
+			hard_count, cache_size, threshold, timestamps, soft_clusters);
+
+		const vector3f_t center = mesh_centroid(vertices, vertex_count);
+
+		for (size_t i = 0; i < cluster_count; i++)
+		{
+			triangle_cluster_t *cluster = clusters + i;
+			cluster->start = soft_clusters[i];
+			cluster->end = i + 1 < cluster_count ? soft_clusters[i + 1] : (Uint32) triangle_count;
+			cluster->sort_key = cluster_sort_key(indices, cluster, vertices, center);
+		}
+
+		SDL_qsort(clusters, cluster_count, sizeof(triangle_cluster_t), compare_clusters);
+
+		size_t offset = 0;
+		for (size_t i = 0; i < cluster_count; i++)
+		{
+			const size_t size = (size_t) (clusters[i].end - clusters[i].start) * 3;
+			SDL_memcpy(result + offset, indices + ((size_t) clusters[i].start * 3), sizeof(Uint32) * size);
+			offset += size;
+		}
+
+		SDL_memcpy(indices, result, sizeof(Uint32) * offset);
+	}
+
+	SDL_free(timestamps);
+	SDL_free(hard_clusters);
+	SDL_free(soft_clusters);
+	SDL_free(clusters);
+	SDL_free(result);
+
+	return success;
+}
+
+bool mesh_optimize_vertex_fetch(primitive_vertex_t *destination, const primitive_vertex_t *vertices,
+	const size_t vertex_count, Uint32 *indices, const size_t index_count, size_t *used_count)
+{
+	Uint32 *remap = SDL_malloc(sizeof(Uint32) * SDL_max(vertex_count, 1));
+	if (remap == nullptr)
+	{
+		return false;
+	}
+
+	SDL_memset(remap, 0xff, sizeof(Uint32) * vertex_count);
+
+	Uint32 next = 0;
+
+	for (size_t i = 0; i < index_count; i++)
+	{
+		const Uint32 index = indices[i];
+
+		if (remap[index] == SDL_MAX_UINT32)
+		{
+			remap[index] = next;
+			destination[next] = vertices[index];
+			next++;
+		}
+
+		indices[i] = remap[index];
+	}
+
+	SDL_free(remap);
+
+	*used_count = next;
+	return true;
+}
+
+Uint32 *mesh_primitive_widen_indices(const mesh_primitive_t *primitive)
+{
+	Uint32 *indices = SDL_malloc(sizeof(Uint32) * primitive->index_count);
+	if (indices == nullptr)
+	{
+		return nullptr;
+	}
+
+	for (size_t i = 0; i < primitive->index_count; i++)
+	{
+		const Uint32 index = primitive->index_size == sizeof(Uint16)
+			? ((const Uint16*) primitive->indices)[i]
+			: ((const Uint32*) primitive->indices)[i];
+
+		if (index >= primitive->vertex_count)
+		{
+			SDL_free(indices);
+			SDL_SetError("Index out of range: %u", index);
+			return nullptr;
+		}
+
+		indices[i] = index;
+	}
+
+	return indices;
+}
+
+void mesh_narrow_indices(const Uint32 *indices, const size_t index_count,
+	const size_t index_size, void *target)
+{
+	for (size_t i = 0; i < index_count; i++)
+	{
+		if (index_size == sizeof(Uint16))
+		{
+			((Uint16*) target)[i] = (Uint16) indices[i];
+		}
+		else
+		{
+			((Uint32*) target)[i] = indices[i];
+		}
+	}
+}
+
+bool mesh_primitive_optimize(mesh_primitive_t *primitive)
+{
+	if (primitive->indices == nullptr
+		|| primitive->vertices == nullptr
+		|| primitive->index_count == 0
+		|| primitive->index_count % 3 != 0)
+	{
+		return true;
+	}
+
+	Uint32 *indices = mesh_primitive_widen_indices(primitive);
+	if (indices == nullptr)
+	{
+		return false;
+	}
+
+	primitive_vertex_t *vertices = SDL_malloc(sizeof(primitive_vertex_t) * primitive->vertex_count);
+	if (vertices == nullptr)
+	{
+		SDL_free(indices);
+		return false;
+	}
+
+	const mesh_cache_stats_t before = mesh_analyze_vertex_cache(indices, primitive->index_count,
+		primitive->vertex_count, mesh_cache_size);
+
+	size_t vertex_count = 0;
+
+	const bool result = mesh_optimize_vertex_cache(indices, primitive->index_count,
+			primitive->vertex_count, mesh_cache_size)
+		&& mesh_optimize_overdraw(indices, primitive->index_count, primitive->vertices,
+			primitive->vertex_count, mesh_cache_size, overdraw_threshold)
+		&& mesh_optimize_vertex_fetch(vertices, primitive->vertices, primitive->vertex_count,
+			indices, primitive->index_count, &vertex_count);
+
+	// Fewer vertices may allow smaller indices
+	const size_t index_size = mesh_primitive_index_size(vertex_count);
+	void *target = result ? SDL_malloc(index_size * primitive->index_count) : nullptr;
+
+	if (target == nullptr)
+	{
+		SDL_free(indices);
+		SDL_free(vertices);
+		return false;
+	}
+
+	const mesh_cache_stats_t after = mesh_analyze_vertex_cache(indices, primitive->index_count,
+		vertex_count, mesh_cache_size);
+
+	SDL_LogDebug(LOG_CATEGORY_MODEL, "Optimized %zu triangles, %zu vertices (%zu unused): "
+		"ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+		primitive->index_count / 3, vertex_count, primitive->vertex_count - vertex_count,
+		(double) before.acmr, (double) after.acmr, (double) before.atvr, (double) after.atvr);
+
+	mesh_narrow_indices(indices, primitive->index_count, index_size, target);
+	SDL_free(indices);
+
+	SDL_free(primitive->vertices);
+	primitive->vertices = vertices;
+	primitive->vertex_count = vertex_count;
+
+	SDL_free(primitive->indices);
+	primitive->indices = target;
+	primitive->index_size = index_size;
+
+	return true;
+}
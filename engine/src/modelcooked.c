@@ -0,0 +1,691 @@
+#include "chirp/modelcooked.h"
+#include "chirp/assets.h"
+#include "chirp/logcategory.h"
+#include "chirp/modelinfo.h"
+
+#include <SDL3/SDL_endian.h>
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_timer.h>
+
+#include <stddef.h>
+
+/*
+ * Everything is little endian and written field by field,
+ * as struct layout and pointer sizes differ between targets:
+ *
+ * u32 magic, u32 version, u32 mesh count, u32 node count, u32 camera count
+ * meshes: u32 primitive count, primitives: u32 vertex count, u32 index count,
+ *         u32 level of detail count, u32[count] level of detail index counts,
+ *         u32 cluster count, clusters: u32 index count, f32[4] sphere, f32[4] cone,
+ *         f32[4] colour, f32[3] bounds min, f32[3] bounds max
+ * nodes: string name, f32[16] world transform, f32[3] translation, u32 mesh index
+ * cameras: string name
+ *
+ * Vertices and indices are either separate assets, one per primitive,
+ * or follow the cameras directly, in the same order as the primitives,
+ * indices of each level of detail follow the full detail ones, indices are 16-bit
+ * if the vertex count allows it, otherwise 32-bit
+ *
+ * Clusters and levels of detail are consecutive ranges of indices, so only their counts are stored
+ *
+ * Strings are stored as u16 length followed by the characters, without a terminator
+ */
+
+static constexpr Uint32 cooked_magic = SDL_FOURCC('c', 'm', 'd', 'l');
+static constexpr Uint32 cooked_version = 5;
+
+// Mesh index of nodes without a mesh
+static constexpr Uint32 no_mesh = SDL_MAX_UINT32;
+
+// Smallest possible node, used to validate counts before allocating
+static constexpr size_t min_node_size = sizeof(Uint16) + (sizeof(float) * 19) + sizeof(Uint32);
+
+// Smallest possible primitive, the counts, colour and bounds
+static constexpr size_t primitive_size = (sizeof(Uint32) * 4) + (sizeof(float) * 10);
+
+// Index count, bounding sphere and normal cone
+static constexpr size_t cluster_size = sizeof(Uint32) + (sizeof(float) * 8);
+
+// Vertices and indices are written as is, in the layout of float GPU buffers
+static_assert(sizeof(primitive_vertex_t) == sizeof(float) * 8);
+static_assert(SDL_BYTEORDER == SDL_LIL_ENDIAN);
+
+char *model_cooked_name(const char *name)
+{
+	char *cooked_name = nullptr;
+	if (SDL_asprintf(&cooked_name, "models/cooked/%s", name) < 0)
+	{
+		return nullptr;
+	}
+
+	return cooked_name;
+}
+
+char *model_cooked_mesh_name(const char *name, const size_t index)
+{
+	char *mesh_name = nullptr;
+	if (SDL_asprintf(&mesh_name, "models/cooked/%s/%zu", name, index) < 0)
+	{
+		return nullptr;
+	}
+
+	return mesh_name;
+}
+
+[[nodiscard]]
+static bool write_floats(SDL_IOStream *stream, const float *values, const size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		Uint32 value;
+		SDL_memcpy(&value, values + i, sizeof(Uint32));
+
+		if (!SDL_WriteU32LE(stream, value))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+[[nodiscard]]
+static bool write_string(SDL_IOStream *stream, const char *str)
+{
+	const size_t length = str != nullptr ? SDL_strlen(str) : 0;
+	if (length > SDL_MAX_UINT16)
+	{
+		return SDL_SetError("Name too long: %s", str);
+	}
+
+	return SDL_WriteU16LE(stream, (Uint16) length)
+		&& SDL_WriteIO(stream, str, length) == length;
+}
+
+[[nodiscard]]
+static bool write_mesh_info(SDL_IOStream *stream, const model_mesh_t *mesh)
+{
+	if (!SDL_WriteU32LE(stream, (Uint32) mesh->primitive_count))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < mesh->primitive_count; i++)
+	{
+		const mesh_primitive_t *primitive = mesh->primitives + i;
+
+		if (!SDL_WriteU32LE(stream, (Uint32) primitive->vertex_count)
+			|| !SDL_WriteU32LE(stream, (Uint32) primitive->index_count)
+			|| !SDL_WriteU32LE(stream, (Uint32) primitive->lod_count))
+		{
+			return false;
+		}
+
+		for (size_t j = 0; j < primitive->lod_count; j++)
+		{
+			if (!SDL_WriteU32LE(stream, (Uint32) primitive->lods[j].index_count))
+			{
+				return false;
+			}
+		}
+
+		if (!SDL_WriteU32LE(stream, (Uint32) primitive->cluster_count))
+		{
+			return false;
+		}
+
+		for (size_t j = 0; j < primitive->cluster_count; j++)
+		{
+			const mesh_cluster_t *cluster = primitive->clusters + j;
+
+			if (!SDL_WriteU32LE(stream, (Uint32) cluster->index_count)
+				|| !write_floats(stream, (const float*) &cluster->center, 3)
+				|| !write_floats(stream, &cluster->radius, 1)
+				|| !write_floats(stream, (const float*) &cluster->cone_axis, 3)
+				|| !write_floats(stream, &cluster->cone_cutoff, 1))
+			{
+				return false;
+			}
+		}
+
+		if (!write_floats(stream, (const float*) &primitive->color, 4)
+			|| !write_floats(stream, (const float*) &primitive->bounds_min, 3)
+			|| !write_floats(stream, (const float*) &primitive->bounds_max, 3))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+[[nodiscard]]
+static bool write_node(SDL_IOStream *stream, const model_info_t *model, const model_node_t *node)
+{
+	const Uint32 mesh_index = node->mesh != nullptr
+		? (Uint32) (node->mesh - model->meshes)
+		: no_mesh;
+
+	return write_string(stream, node->name)
+		&& write_floats(stream, node->world_transform.m, matrix4x4_size)
+		&& write_floats(stream, (const float*) &node->translation, 3)
+		&& SDL_WriteU32LE(stream, mesh_index);
+}
+
+bool model_cooked_write(const model_info_t *model, SDL_IOStream *stream)
+{
+	if (!SDL_WriteU32LE(stream, cooked_magic)
+		|| !SDL_WriteU32LE(stream, cooked_version)
+		|| !SDL_WriteU32LE(stream, (Uint32) model->mesh_count)
+		|| !SDL_WriteU32LE(stream, (Uint32) model->node_count)
+		|| !SDL_WriteU32LE(stream, (Uint32) model->camera_count))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < model->mesh_count; i++)
+	{
+		if (!write_mesh_info(stream, model->meshes + i))
+		{
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < model->node_count; i++)
+	{
+		if (!write_node(stream, model, model->nodes + i))
+		{
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < model->camera_count; i++)
+	{
+		if (!write_string(stream, model_camera_name(model, i)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool model_cooked_write_mesh(const mesh_primitive_t *primitive, SDL_IOStream *stream)
+{
+	const size_t vertex_size = sizeof(primitive_vertex_t) * primitive->vertex_count;
+	const size_t index_size = primitive->index_size * mesh_primitive_stored_index_count(primitive);
+
+	if (primitive->vertices == nullptr || primitive->indices == nullptr)
+	{
+		return SDL_SetError("Primitive has no vertex data");
+	}
+
+	return SDL_WriteIO(stream, primitive->vertices, vertex_size) == vertex_size
+		&& SDL_WriteIO(stream, primitive->indices, index_size) == index_size;
+}
+
+bool model_cooked_write_all(const model_info_t *model, SDL_IOStream *stream)
+{
+	if (!model_cooked_write(model, stream))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < model->mesh_count; i++)
+	{
+		const model_mesh_t *mesh = model->meshes + i;
+
+		for (size_t j = 0; j < mesh->primitive_count; j++)
+		{
+			if (!model_cooked_write_mesh(mesh->primitives + j, stream))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool model_cooked_exists(const assets_t *assets, const char *name)
+{
+	char *cooked_name = model_cooked_name(name);
+	if (cooked_name == nullptr)
+	{
+		return false;
+	}
+
+	const bool exists = assets_exists(assets, cooked_name);
+	SDL_free(cooked_name);
+
+	return exists;
+}
+
+[[nodiscard]]
+static bool read_floats(SDL_IOStream *stream, float *values, const size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		Uint32 value;
+		if (!SDL_ReadU32LE(stream, &value))
+		{
+			return false;
+		}
+
+		SDL_memcpy(values + i, &value, sizeof(float));
+	}
+
+	return true;
+}
+
+[[nodiscard]]
+static char *read_string(SDL_IOStream *stream)
+{
+	Uint16 length;
+	if (!SDL_ReadU16LE(stream, &length))
+	{
+		return nullptr;
+	}
+
+	char *str = SDL_malloc(length + 1);
+	if (str == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (SDL_ReadIO(stream, str, length) != length)
+	{
+		SDL_free(str);
+		return nullptr;
+	}
+
+	str[length] = '\0';
+	return str;
+}
+
+[[nodiscard]]
+static bool read_clusters(SDL_IOStream *stream, const size_t index_count, mesh_primitive_t *primitive)
+{
+	Uint32 cluster_count;
+	if (!SDL_ReadU32LE(stream, &cluster_count))
+	{
+		return false;
+	}
+
+	if (cluster_count > (SDL_GetIOSize(stream) - SDL_TellIO(stream)) / cluster_size)
+	{
+		return SDL_SetError("Invalid cluster count: %u", cluster_count);
+	}
+
+	if (cluster_count == 0)
+	{
+		return true;
+	}
+
+	primitive->clusters = SDL_calloc(cluster_count, sizeof(mesh_cluster_t));
+	if (primitive->clusters == nullptr)
+	{
+		return false;
+	}
+
+	primitive->cluster_count = cluster_count;
+	size_t cluster_offset = 0;
+
+	for (Uint32 i = 0; i < cluster_count; i++)
+	{
+		mesh_cluster_t *cluster = primitive->clusters + i;
+
+		Uint32 cluster_index_count;
+		if (!SDL_ReadU32LE(stream, &cluster_index_count)
+			|| !read_floats(stream, (float*) &cluster->center, 3)
+			|| !read_floats(stream, &cluster->radius, 1)
+			|| !read_floats(stream, (float*) &cluster->cone_axis, 3)
+			|| !read_floats(stream, &cluster->cone_cutoff, 1))
+		{
+			return false;
+		}
+
+		cluster->index_offset = cluster_offset;
+		cluster->index_count = cluster_index_count;
+		cluster_offset += cluster_index_count;
+	}
+
+	// Drawn as ranges of the full detail indices, so they can't go past them
+	if (cluster_offset != index_count)
+	{
+		return SDL_SetError("Invalid cluster index count: %zu", cluster_offset);
+	}
+
+	return true;
+}
+
+[[nodiscard]]
+static bool read_mesh_info(SDL_IOStream *stream, const char *name,
+	size_t *mesh_index, model_mesh_t *mesh)
+{
+	Uint32 primitive_count;
+	if (!SDL_ReadU32LE(stream, &primitive_count))
+	{
+		return false;
+	}
+
+	if (primitive_count > (SDL_GetIOSize(stream) - SDL_TellIO(stream)) / primitive_size)
+	{
+		return SDL_SetError("Invalid primitive count: %u", primitive_count);
+	}
+
+	mesh->primitives = SDL_calloc(primitive_count, sizeof(mesh_primitive_t));
+	if (mesh->primitives == nullptr && primitive_count > 0)
+	{
+		return false;
+	}
+
+	for (Uint32 i = 0; i < primitive_count; i++)
+	{
+		mesh_primitive_t *primitive = mesh->primitives + i;
+		mesh->primitive_count++;
+
+		Uint32 vertex_count;
+		Uint32 index_count;
+		Uint32 lod_count;
+
+		if (!SDL_ReadU32LE(stream, &vertex_count)
+			|| !SDL_ReadU32LE(stream, &index_count)
+			|| !SDL_ReadU32LE(stream, &lod_count))
+		{
+			return false;
+		}
+
+		if (lod_count > mesh_max_lods)
+		{
+			return SDL_SetError("Invalid level of detail count: %u", lod_count);
+		}
+
+		// Only counts are stored, as each level starts where the previous one ends
+		size_t lod_offset = index_count;
+
+		for (Uint32 j = 0; j < lod_count; j++)
+		{
+			Uint32 lod_index_count;
+			if (!SDL_ReadU32LE(stream, &lod_index_count))
+			{
+				return false;
+			}
+
+			primitive->lods[j] = (mesh_lod_t){
+				.index_offset = lod_offset,
+				.index_count = lod_index_count,
+			};
+
+			lod_offset += lod_index_count;
+		}
+
+		if (!read_clusters(stream, index_count, primitive))
+		{
+			return false;
+		}
+
+		if (!read_floats(stream, (float*) &primitive->color, 4)
+			|| !read_floats(stream, (float*) &primitive->bounds_min, 3)
+			|| !read_floats(stream, (float*) &primitive->bounds_max, 3))
+		{
+			return false;
+		}
+
+		primitive->vertex_count = vertex_count;
+		primitive->index_count = index_count;
+		primitive->lod_count = lod_count;
+		primitive->index_size = mesh_primitive_index_size(vertex_count);
+
+		// Read right after the model instead
+		if (name == nullptr)
+		{
+			continue;
+		}
+
+		primitive->gpu_asset = model_cooked_mesh_name(name, (*mesh_index)++);
+		if (primitive->gpu_asset == nullptr)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+[[nodiscard]]
+static bool read_node(SDL_IOStream *stream, const model_info_t *model, model_node_t *node)
+{
+	node->name = read_string(stream);
+	if (node->name == nullptr)
+	{
+		return false;
+	}
+
+	Uint32 mesh_index;
+
+	if (!read_floats(stream, (float*) node->world_transform.m, matrix4x4_size)
+		|| !read_floats(stream, (float*) &node->translation, 3)
+		|| !SDL_ReadU32LE(stream, &mesh_index))
+	{
+		return false;
+	}
+
+	if (mesh_index == no_mesh)
+	{
+		return true;
+	}
+
+	if (mesh_index >= model->mesh_count)
+	{
+		return SDL_SetError("Invalid mesh index: %u", mesh_index);
+	}
+
+	node->mesh = model->meshes + mesh_index;
+	return true;
+}
+
+[[nodiscard]]
+static bool read_model(SDL_IOStream *stream, const char *name, model_info_t *model)
+{
+	Uint32 magic;
+	Uint32 version;
+	Uint32 mesh_count;
+	Uint32 node_count;
+	Uint32 camera_count;
+
+	if (!SDL_ReadU32LE(stream, &magic)
+		|| !SDL_ReadU32LE(stream, &version))
+	{
+		return false;
+	}
+
+	if (magic != cooked_magic)
+	{
+		return SDL_SetError("Not a cooked model");
+	}
+
+	if (version != cooked_version)
+	{
+		return SDL_SetError("Unsupported cooked model version: %u", version);
+	}
+
+	if (!SDL_ReadU32LE(stream, &mesh_count)
+		|| !SDL_ReadU32LE(stream, &node_count)
+		|| !SDL_ReadU32LE(stream, &camera_count))
+	{
+		return false;
+	}
+
+	// Each mesh needs at least its primitive count
+	if (mesh_count > (SDL_GetIOSize(stream) - SDL_TellIO(stream)) / sizeof(Uint32))
+	{
+		return SDL_SetError("Invalid mesh count: %u", mesh_count);
+	}
+
+	model->meshes = SDL_calloc(mesh_count, sizeof(model_mesh_t));
+	if (model->meshes == nullptr && mesh_count > 0)
+	{
+		return false;
+	}
+
+	size_t mesh_index = 0;
+
+	for (Uint32 i = 0; i < mesh_count; i++)
+	{
+		// Counted first, so partially read meshes are freed on failure
+		model->mesh_count++;
+
+		if (!read_mesh_info(stream, name, &mesh_index, model->meshes + i))
+		{
+			return false;
+		}
+	}
+
+	if (node_count > (SDL_GetIOSize(stream) - SDL_TellIO(stream)) / min_node_size)
+	{
+		return SDL_SetError("Invalid node count: %u", node_count);
+	}
+
+	model->nodes = SDL_calloc(node_count, sizeof(model_node_t));
+	if (model->nodes == nullptr && node_count > 0)
+	{
+		return false;
+	}
+
+	for (Uint32 i = 0; i < node_count; i++)
+	{
+		model->node_count++;
+
+		if (!read_node(stream, model, model->nodes + i))
+		{
+			return false;
+		}
+	}
+
+	for (Uint32 i = 0; i < camera_count; i++)
+	{
+		char *camera_name = read_string(stream);
+		if (camera_name == nullptr)
+		{
+			return false;
+		}
+
+		const bool result = model_info_add_camera(model, camera_name);
+		SDL_free(camera_name);
+
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+[[nodiscard]]
+static bool read_mesh(SDL_IOStream *stream, mesh_primitive_t *primitive)
+{
+	const size_t vertex_size = sizeof(primitive_vertex_t) * primitive->vertex_count;
+	const size_t index_size = primitive->index_size * mesh_primitive_stored_index_count(primitive);
+
+	if (vertex_size + index_size > (Uint64) (SDL_GetIOSize(stream) - SDL_TellIO(stream)))
+	{
+		return SDL_SetError("Missing vertex data");
+	}
+
+	primitive->vertices = SDL_malloc(vertex_size);
+	primitive->indices = SDL_malloc(index_size);
+
+	return primitive->vertices != nullptr
+		&& primitive->indices != nullptr
+		&& SDL_ReadIO(stream, primitive->vertices, vertex_size) == vertex_size
+		&& SDL_ReadIO(stream, primitive->indices, index_size) == index_size;
+}
+
+[[nodiscard]]
+static bool read_meshes(SDL_IOStream *stream, const model_info_t *model)
+{
+	for (size_t i = 0; i < model->mesh_count; i++)
+	{
+		const model_mesh_t *mesh = model->meshes + i;
+
+		for (size_t j = 0; j < mesh->primitive_count; j++)
+		{
+			if (!read_mesh(stream, mesh->primitives + j))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool model_info_create_cooked_mem(const assets_t *assets, const void *data,
+	const size_t size, model_info_t *model)
+{
+	*model = (model_info_t){
+		.assets = assets,
+	};
+
+	SDL_IOStream *stream = SDL_IOFromConstMem(data, size);
+	if (stream == nullptr)
+	{
+		return false;
+	}
+
+	const bool result = read_model(stream, nullptr, model)
+		&& read_meshes(stream, model);
+
+	SDL_CloseIO(stream);
+
+	if (!result)
+	{
+		model_info_destroy(model);
+		*model = (model_info_t){};
+	}
+
+	return result;
+}
+
+bool model_info_create_cooked(const assets_t *assets, const char *name, model_info_t *model)
+{
+	*model = (model_info_t){
+		.assets = assets,
+	};
+
+	const Uint64 begin = SDL_GetTicks();
+
+	char *cooked_name = model_cooked_name(name);
+	if (cooked_name == nullptr)
+	{
+		return false;
+	}
+
+	SDL_IOStream *stream = assets_load(assets, cooked_name);
+	SDL_free(cooked_name);
+
+	if (stream == nullptr)
+	{
+		return false;
+	}
+
+	const bool result = read_model(stream, name, model);
+	SDL_CloseIO(stream);
+
+	if (!result)
+	{
+		model_info_destroy(model);
+		*model = (model_info_t){};
+		return false;
+	}
+
+	SDL_LogDebug(LOG_CATEGORY_MODEL, "Loaded cooked model %s in %lu ms",
+		name, SDL_GetTicks() - begin);
+
+	return true;
+}
@@ -0,0 +1,293 @@
+#include "chirp/modeldeps.h"
+#include "chirp/assets.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+/*
+ * Little endian, like cooked models:
+ *
+ * u32 magic, u32 version, u32 dependency count
+ * dependencies: u8 type, u64 size, string asset name, string uri
+ *
+ * Strings are stored as u16 length followed by the characters, without a terminator
+ */
+
+static constexpr Uint32 deps_magic = SDL_FOURCC('m', 'd', 'e', 'p');
+static constexpr Uint32 deps_version = 1;
+
+// Smallest possible dependency, used to validate the count before allocating
+static constexpr size_t min_dependency_size = sizeof(Uint8) + sizeof(Uint64) + (sizeof(Uint16) * 2);
+
+char *model_deps_name(const char *name)
+{
+	char *deps_name = nullptr;
+	if (SDL_asprintf(&deps_name, "models/deps/%s", name) < 0)
+	{
+		return nullptr;
+	}
+
+	return deps_name;
+}
+
+char *model_dependency_asset_name(const char *uri)
+{
+	const char *ext = SDL_strrchr(uri, '.');
+	if (ext == nullptr)
+	{
+		SDL_SetError("Unknown file type: %s", uri);
+		return nullptr;
+	}
+
+	const bool is_buffer = model_dependency_type(uri) == MODEL_DEPENDENCY_BUFFER;
+
+	char *asset_name = nullptr;
+	if (SDL_asprintf(&asset_name, "models/%s/%.*s",
+		is_buffer ? "buffers" : "images",
+		(int) (ext - uri), uri) < 0)
+	{
+		return nullptr;
+	}
+
+	return asset_name;
+}
+
+model_dependency_type_t model_dependency_type(const char *uri)
+{
+	const char *ext = SDL_strrchr(uri, '.');
+
+	return ext != nullptr && SDL_strcmp(ext, ".bin") == 0
+		? MODEL_DEPENDENCY_BUFFER
+		: MODEL_DEPENDENCY_IMAGE;
+}
+
+bool model_deps_add(model_deps_t *deps, const model_dependency_type_t type,
+	char *asset_name, char *uri, const Uint64 size)
+{
+	model_dependency_t *items = SDL_realloc(deps->items, sizeof(model_dependency_t) * (deps->count + 1));
+	if (items == nullptr)
+	{
+		SDL_free(asset_name);
+		SDL_free(uri);
+		return false;
+	}
+
+	deps->items = items;
+	deps->items[deps->count++] = (model_dependency_t){
+		.type = type,
+		.asset_name = asset_name,
+		.uri = uri,
+		.size = size,
+	};
+
+	return true;
+}
+
+[[nodiscard]]
+static bool write_string(SDL_IOStream *stream, const char *str)
+{
+	const size_t length = SDL_strlen(str);
+	if (length > SDL_MAX_UINT16)
+	{
+		return SDL_SetError("Name too long: %s", str);
+	}
+
+	return SDL_WriteU16LE(stream, (Uint16) length)
+		&& SDL_WriteIO(stream, str, length) == length;
+}
+
+bool model_deps_write(const model_deps_t *deps, SDL_IOStream *stream)
+{
+	if (!SDL_WriteU32LE(stream, deps_magic)
+		|| !SDL_WriteU32LE(stream, deps_version)
+		|| !SDL_WriteU32LE(stream, (Uint32) deps->count))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < deps->count; i++)
+	{
+		const model_dependency_t *dependency = deps->items + i;
+
+		if (!SDL_WriteU8(stream, dependency->type)
+			|| !SDL_WriteU64LE(stream, dependency->size)
+			|| !write_string(stream, dependency->asset_name)
+			|| !write_string(stream, dependency->uri))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+[[nodiscard]]
+static char *read_string(SDL_IOStream *stream)
+{
+	Uint16 length;
+	if (!SDL_ReadU16LE(stream, &length))
+	{
+		return nullptr;
+	}
+
+	char *str = SDL_malloc(length + 1);
+	if (str == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (SDL_ReadIO(stream, str, length) != length)
+	{
+		SDL_free(str);
+		return nullptr;
+	}
+
+	str[length] = '\0';
+	return str;
+}
+
+[[nodiscard]]
+static bool read_dependency(SDL_IOStream *stream, model_deps_t *deps)
+{
+	Uint8 type;
+	Uint64 size;
+
+	if (!SDL_ReadU8(stream, &type)
+		|| !SDL_ReadU64LE(stream, &size))
+	{
+		return false;
+	}
+
+	if (type > MODEL_DEPENDENCY_IMAGE)
+	{
+		return SDL_SetError("Unknown dependency type: %u", type);
+	}
+
+	char *asset_name = read_string(stream);
+	char *uri = asset_name != nullptr ? read_string(stream) : nullptr;
+
+	if (uri == nullptr)
+	{
+		SDL_free(asset_name);
+		return false;
+	}
+
+	return model_deps_add(deps, type, asset_name, uri, size);
+}
+
+[[nodiscard]]
+static bool read_deps(SDL_IOStream *stream, model_deps_t *deps)
+{
+	Uint32 magic;
+	Uint32 version;
+	Uint32 count;
+
+	if (!SDL_ReadU32LE(stream, &magic)
+		|| !SDL_ReadU32LE(stream, &version)
+		|| !SDL_ReadU32LE(stream, &count))
+	{
+		return false;
+	}
+
+	if (magic != deps_magic)
+	{
+		return SDL_SetError("Not a dependency list");
+	}
+
+	if (version != deps_version)
+	{
+		return SDL_SetError("Unsupported dependency list version: %u", version);
+	}
+
+	if (count > (SDL_GetIOSize(stream) - SDL_TellIO(stream)) / min_dependency_size)
+	{
+		return SDL_SetError("Invalid dependency count: %u", count);
+	}
+
+	for (Uint32 i = 0; i < count; i++)
+	{
+		if (!read_dependency(stream, deps))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool model_deps_load(const assets_t *assets, const char *name, model_deps_t *deps)
+{
+	*deps = (model_deps_t){};
+
+	char *deps_name = model_deps_name(name);
+	if (deps_name == nullptr)
+	{
+		return false;
+	}
+
+	SDL_IOStream *stream = assets_load(assets, deps_name);
+	SDL_free(deps_name);
+
+	if (stream == nullptr)
+	{
+		return false;
+	}
+
+	const bool result = read_deps(stream, deps);
+	SDL_CloseIO(stream);
+
+	if (!result)
+	{
+		model_deps_destroy(deps);
+		*deps = (model_deps_t){};
+	}
+
+	return result;
+}
+
+bool model_deps_exists(const assets_t *assets, const char *name)
+{
+	char *deps_name = model_deps_name(name);
+	if (deps_name == nullptr)
+	{
+		return false;
+	}
+
+	const bool exists = assets_exists(assets, deps_name);
+	SDL_free(deps_name);
+
+	return exists;
+}
+
+bool model_deps_signature(const assets_t *assets, const model_deps_t *deps, Uint32 *signature)
+{
+	Uint32 result = 0;
+
+	for (size_t i = 0; i < deps->count; i++)
+	{
+		Uint32 hash;
+		if (!assets_content_hash(assets, deps->items[i].asset_name, &hash))
+		{
+			return false;
+		}
+
+		result = SDL_murmur3_32(&hash, sizeof(hash), result);
+	}
+
+	*signature = result;
+	return true;
+}
+
+void model_deps_destroy(const model_deps_t *deps)
+{
+	for (size_t i = 0; i < deps->count; i++)
+	{
+		SDL_free(deps->items[i].asset_name);
+		SDL_free(deps->items[i].uri);
+	}
+
+	SDL_free(deps->items);
+}
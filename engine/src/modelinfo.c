@@ -2,14 +2,22 @@
 #include "chirp/assets.h"
 #include "chirp/logcategory.h"
 #include "chirp/matrix.h"
+#include "chirp/meshlet.h"
+#include "chirp/meshlod.h"
+#include "chirp/meshopt.h"
+#include "chirp/modeldeps.h"
+#include "chirp/threadpool.h"
 #include "chirp/vector.h"
 
 #include "cgltf.h"
 
 #include <SDL3/SDL_assert.h>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_cpuinfo.h>
 #include <SDL3/SDL_error.h>
 #include <SDL3/SDL_iostream.h>
 #include <SDL3/SDL_log.h>
+#include <SDL3/SDL_mutex.h>
 #include <SDL3/SDL_pixels.h>
 #include <SDL3/SDL_stdinc.h>
 #include <SDL3/SDL_timer.h>
@@ -20,7 +28,6 @@
 #define prop_vertex_position  cgltf_attribute_type_position
 #define prop_vertex_normal    cgltf_attribute_type_normal
 #define prop_vertex_tex_coord cgltf_attribute_type_texcoord
-#define prop_index            cgltf_attribute_type_custom
 
 typedef struct material
 {
@@ -33,6 +40,40 @@ typedef struct scene_camera
 	char *name;
 } scene_camera_t;
 
+typedef struct primitive_job
+{
+	const cgltf_primitive *gltf_primitive;
+	mesh_primitive_t *primitive;
+} primitive_job_t;
+
+/**
+ * Primitives decoded by the calling thread and helpers on the import pool,
+ * freed by whoever releases it last, as helpers may start after everything is decoded
+ */
+typedef struct primitive_batch
+{
+	const model_info_t *model;
+	const primitive_job_t *jobs;
+	size_t job_count;
+
+	SDL_AtomicInt next_job;
+	SDL_AtomicInt refs;
+
+	SDL_Mutex *mutex;
+	SDL_Condition *finished;
+	size_t finished_count;
+
+	// Errors are per thread, so the first one is copied to the calling thread
+	char *error;
+} primitive_batch_t;
+
+// thread_pool_t, read by loading threads
+static void *import_pool;
+static size_t import_min_vertex_count = model_parallel_min_vertices;
+
+static float lod_ratios[mesh_max_lods] = {0.5F, 0.25F, 0.125F};
+static size_t lod_ratio_count = 3;
+
 static void *gltf_alloc([[maybe_unused]] void *user,
 	const cgltf_size size)
 {
@@ -47,21 +88,16 @@ static void gltf_free([[maybe_unused]] void *user, void *ptr)
 static cgltf_result gltf_read([[maybe_unused]] const cgltf_memory_options *memory_options,
 	const cgltf_file_options *file_options, const char *path, cgltf_size *size, void **data)
 {
-	const char *ext = SDL_strrchr(path, '.');
-	if (ext == nullptr)
+	char *asset_name = model_dependency_asset_name(path);
+	if (asset_name == nullptr)
 	{
 		return cgltf_result_unknown_format;
 	}
 
-	const bool is_buffer = SDL_strcmp(ext, ".bin") == 0;
-	char *asset_name = nullptr;
-	SDL_asprintf(&asset_name, "models/%s/%.*s",
-		(int) is_buffer ? "buffers" : "images",
-		(int) (ext - path), path
-	);
-
 	const assets_t *assets = file_options->user_data;
 	SDL_IOStream *stream = assets_load(assets, asset_name);
+	SDL_free(asset_name);
+
 	if (stream == nullptr)
 	{
 		return cgltf_result_file_not_found;
@@ -71,6 +107,148 @@ static cgltf_result gltf_read([[maybe_unused]] const cgltf_memory_options *memor
 	return cgltf_result_success;
 }
 
+[[nodiscard]]
+static bool is_external_buffer(const cgltf_buffer *buffer)
+{
+	return buffer->data == nullptr
+		&& buffer->uri != nullptr
+		&& SDL_strncmp(buffer->uri, "data:", 5) != 0;
+}
+
+/**
+ * Point buffers directly into the mapped archive,
+ * cgltf then skips them when loading the remaining buffers
+ */
+static bool map_buffers(const assets_t *assets, const cgltf_data *gltf_data)
+{
+	if (assets->map.data == nullptr)
+	{
+		return true;
+	}
+
+	for (cgltf_size i = 0; i < gltf_data->buffers_count; i++)
+	{
+		cgltf_buffer *buffer = gltf_data->buffers + i;
+		if (!is_external_buffer(buffer))
+		{
+			continue;
+		}
+
+		char *asset_name = model_dependency_asset_name(buffer->uri);
+		if (asset_name == nullptr)
+		{
+			continue;
+		}
+
+		asset_view_t view;
+		const bool found = assets_view(assets, asset_name, &view);
+		SDL_free(asset_name);
+
+		// Compressed buffers can't be viewed, they're decompressed when loaded instead
+		if (!found)
+		{
+			SDL_ClearError();
+			continue;
+		}
+
+		if (view.size < buffer->size)
+		{
+			return SDL_SetError("Buffer too small, found %zu but expected %zu",
+				view.size, buffer->size);
+		}
+
+		buffer->data = (void*) view.data;
+		buffer->data_free_method = cgltf_data_free_method_none;
+	}
+
+	return true;
+}
+
+static void free_reads(asset_read_t *reads, const size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		SDL_free((char*) reads[i].name);
+		SDL_free(reads[i].dst);
+	}
+
+	SDL_free(reads);
+}
+
+/**
+ * Read all buffers not already mapped as a single batch,
+ * instead of one at a time as cgltf asks for them
+ */
+[[nodiscard]]
+static bool read_buffers(const assets_t *assets, const cgltf_data *gltf_data)
+{
+	asset_read_t *reads = SDL_calloc(gltf_data->buffers_count, sizeof(asset_read_t));
+	if (reads == nullptr)
+	{
+		return false;
+	}
+
+	// Index of the buffer each read is for
+	cgltf_size *buffer_indices = SDL_malloc(sizeof(cgltf_size) * gltf_data->buffers_count);
+	if (buffer_indices == nullptr)
+	{
+		SDL_free(reads);
+		return false;
+	}
+
+	size_t count = 0;
+	bool result = true;
+
+	for (cgltf_size i = 0; i < gltf_data->buffers_count && result; i++)
+	{
+		const cgltf_buffer *buffer = gltf_data->buffers + i;
+		if (!is_external_buffer(buffer))
+		{
+			continue;
+		}
+
+		asset_read_t *read = reads + count;
+
+		read->name = model_dependency_asset_name(buffer->uri);
+		result = read->name != nullptr
+			&& assets_size(assets, read->name, &read->size);
+
+		if (result && read->size < buffer->size)
+		{
+			result = SDL_SetError("Buffer too small, found %zu but expected %zu",
+				read->size, buffer->size);
+		}
+
+		if (result)
+		{
+			read->dst = SDL_malloc(read->size);
+			result = read->dst != nullptr;
+		}
+
+		buffer_indices[count++] = i;
+	}
+
+	result = result && assets_read_batch(assets, reads, count);
+
+	if (result)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			cgltf_buffer *buffer = gltf_data->buffers + buffer_indices[i];
+			buffer->data = reads[i].dst;
+			buffer->data_free_method = cgltf_data_free_method_memory_free;
+
+			// Now owned by cgltf
+			reads[i].dst = nullptr;
+		}
+	}
+
+	free_reads(reads, count);
+	SDL_free(buffer_indices);
+
+	return result;
+}
+
 [[nodiscard]]
 static const char *cgltf_error_string(const cgltf_result result)
 {
@@ -267,28 +445,110 @@ static bool load_materials(model_info_t *model, const cgltf_data *gltf_data)
 	return true;
 }
 
+/**
+ * Copy float components straight from the buffer view into the interleaved vertices,
+ * skipping the temporary array cgltf_accessor_unpack_floats needs
+ * @param field_offset Offset of the attribute in primitive_vertex_t
+ * @returns false if the accessor has to be unpacked by cgltf instead
+ */
+[[nodiscard]]
+static bool copy_float_attribute(const cgltf_accessor *accessor, primitive_vertex_t *vertices,
+	const size_t field_offset)
+{
+	// Sparse accessors need their base values patched, and normalized ones converted
+	if (accessor->is_sparse
+		|| accessor->normalized
+		|| accessor->component_type != cgltf_component_type_r_32f
+		|| accessor->buffer_view == nullptr)
+	{
+		return false;
+	}
+
+	const Uint8 *data = cgltf_buffer_view_data(accessor->buffer_view);
+	if (data == nullptr)
+	{
+		return false;
+	}
+
+	const size_t stride = accessor->stride;
+	const size_t element_size = cgltf_num_components(accessor->type) * sizeof(cgltf_float);
+	const size_t view_size = accessor->buffer_view->size;
+
+	// Let cgltf report accessors that don't fit in their buffer view
+	if (accessor->count > 0
+		&& (stride < element_size
+			|| accessor->offset > view_size
+			|| view_size - accessor->offset < element_size
+			|| (view_size - accessor->offset - element_size) / stride < accessor->count - 1))
+	{
+		return false;
+	}
+
+	const Uint8 *source = data + accessor->offset;
+	Uint8 *target = (Uint8*) vertices + field_offset;
+
+	// Fixed sizes, so each copy is only a couple of moves
+	switch (accessor->type)
+	{
+		case cgltf_type_vec2:
+			for (size_t i = 0; i < accessor->count; i++)
+			{
+				SDL_memcpy(target + (i * sizeof(primitive_vertex_t)), source + (i * stride), sizeof(vector2f_t));
+			}
+			return true;
+
+		case cgltf_type_vec3:
+			for (size_t i = 0; i < accessor->count; i++)
+			{
+				SDL_memcpy(target + (i * sizeof(primitive_vertex_t)), source + (i * stride), sizeof(vector3f_t));
+			}
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Floats, or any of the integer types KHR_mesh_quantization allows,
+ * which are converted to floats when unpacked
+ */
+[[nodiscard]]
+static bool supported_component_type(const cgltf_accessor *accessor, const model_property_t property)
+{
+	switch (accessor->component_type)
+	{
+		case cgltf_component_type_r_32f:
+			return true;
+
+		// Normals have to be normalized, and signed so they can point in any direction
+		case cgltf_component_type_r_8:
+		case cgltf_component_type_r_16:
+			return property != prop_vertex_normal || accessor->normalized;
+
+		case cgltf_component_type_r_8u:
+		case cgltf_component_type_r_16u:
+			return property != prop_vertex_normal;
+
+		default:
+			return false;
+	}
+}
+
 static bool load_buffer_data(const cgltf_accessor *accessor, mesh_primitive_t *primitive,
 	const model_property_t property)
 {
 	cgltf_type expected_type;
-	cgltf_component_type expected_component_type;
 
 	switch (property)
 	{
-		case prop_index:
-			expected_type = cgltf_type_scalar;
-			expected_component_type = cgltf_component_type_r_16u;
-			break;
-
 		case prop_vertex_position:
 		case prop_vertex_normal:
 			expected_type = cgltf_type_vec3;
-			expected_component_type = cgltf_component_type_r_32f;
 			break;
 
 		case prop_vertex_tex_coord:
 			expected_type = cgltf_type_vec2;
-			expected_component_type = cgltf_component_type_r_32f;
 			break;
 
 		default:
@@ -296,43 +556,44 @@ static bool load_buffer_data(const cgltf_accessor *accessor, mesh_primitive_t *p
 	}
 
 	if (accessor->type != expected_type
-		|| accessor->component_type != expected_component_type)
+		|| !supported_component_type(accessor, property))
 	{
-		return SDL_SetError("Invalid accessor type: %s %s, expected %s %s",
+		return SDL_SetError("Invalid accessor type: %s %s%s, expected %s",
 			cgltf_type_string(accessor->type),
+			accessor->normalized ? "normalized " : "",
 			cgltf_component_type_string(accessor->component_type),
-			cgltf_type_string(expected_type),
-			cgltf_component_type_string(expected_component_type)
+			cgltf_type_string(expected_type)
 		);
 	}
 
-	if (property == prop_index
-		&& primitive->indices == nullptr)
-	{
-		primitive->index_count = accessor->count;
-		primitive->indices = SDL_calloc(primitive->index_count,
-			sizeof(primitive_index_t));
-	}
-
-	if (property != prop_index
-		&& primitive->vertices == nullptr)
+	if (primitive->vertices == nullptr)
 	{
 		primitive->vertex_count = accessor->count;
 		primitive->vertices = SDL_calloc(primitive->vertex_count,
 			sizeof(primitive_vertex_t));
+
+		if (primitive->vertices == nullptr)
+		{
+			return false;
+		}
 	}
 
-	if (property == prop_index)
+	if (accessor->count != primitive->vertex_count)
 	{
-		const cgltf_size count = cgltf_accessor_unpack_indices(accessor, primitive->indices,
-			sizeof(primitive_index_t), accessor->count);
+		return SDL_SetError("Invalid %s count, found %zu but expected %zu",
+			cgltf_attribute_type_string(property),
+			accessor->count, primitive->vertex_count
+		);
+	}
 
-		if (count != primitive->index_count)
-		{
-			return SDL_SetError("Invalid index count, found %zu but expected %zu",
-				count, primitive->index_count);
-		}
+	const size_t field_offset = property == prop_vertex_position
+		? offsetof(primitive_vertex_t, position)
+		: property == prop_vertex_normal
+		? offsetof(primitive_vertex_t, normal)
+		: offsetof(primitive_vertex_t, tex_coord);
 
+	if (copy_float_attribute(accessor, primitive->vertices, field_offset))
+	{
 		return true;
 	}
 
@@ -356,28 +617,84 @@ static bool load_buffer_data(const cgltf_accessor *accessor, mesh_primitive_t *p
 		);
 	}
 
+	Uint8 *target = (Uint8*) primitive->vertices + field_offset;
+
 	for (size_t i = 0; i < accessor->count; i++)
 	{
-		primitive_vertex_t *vertex = primitive->vertices + i;
-		const cgltf_float *data = out + (i * num_components);
+		SDL_memcpy(target + (i * sizeof(primitive_vertex_t)), out + (i * num_components),
+			num_components * sizeof(cgltf_float));
+	}
+
+	SDL_free(out);
+	return true;
+}
+
+/**
+ * Unpack indices into the index size of the primitive,
+ * which may be narrower than what the accessor uses
+ * @param vertex_count Indices are checked against it before they're narrowed
+ */
+[[nodiscard]]
+static bool load_indices(const cgltf_accessor *accessor, const size_t vertex_count,
+	mesh_primitive_t *primitive)
+{
+	if (accessor->type != cgltf_type_scalar
+		|| (accessor->component_type != cgltf_component_type_r_8u
+			&& accessor->component_type != cgltf_component_type_r_16u
+			&& accessor->component_type != cgltf_component_type_r_32u))
+	{
+		return SDL_SetError("Invalid index type: %s %s",
+			cgltf_type_string(accessor->type),
+			cgltf_component_type_string(accessor->component_type)
+		);
+	}
+
+	// cgltf can only widen indices, narrowing is done afterwards
+	const size_t unpack_size = SDL_max(primitive->index_size,
+		cgltf_component_size(accessor->component_type));
+
+	primitive->index_count = accessor->count;
+	primitive->indices = SDL_malloc(primitive->index_count * unpack_size);
+	if (primitive->indices == nullptr)
+	{
+		return false;
+	}
+
+	const cgltf_size count = cgltf_accessor_unpack_indices(accessor, primitive->indices,
+		unpack_size, accessor->count);
+
+	if (count != primitive->index_count)
+	{
+		return SDL_SetError("Invalid index count, found %zu but expected %zu",
+			count, primitive->index_count);
+	}
+
+	if (unpack_size == primitive->index_size)
+	{
+		return true;
+	}
 
-		if (property == prop_vertex_tex_coord)
+	// In place, each index is written to where earlier indices were read from
+	const Uint32 *source = primitive->indices;
+	Uint16 *target = primitive->indices;
+
+	for (size_t i = 0; i < primitive->index_count; i++)
+	{
+		// Would otherwise wrap around to an index that looks valid
+		if (source[i] >= vertex_count)
 		{
-			vertex->tex_coord.x = data[0];
-			vertex->tex_coord.y = data[1];
-			continue;
+			return SDL_SetError("Index out of range: %u", source[i]);
 		}
 
-		vector3f_t *target = property == prop_vertex_position
-			? &vertex->position
-			: &vertex->normal;
+		target[i] = (Uint16) source[i];
+	}
 
-		target->x = data[0];
-		target->y = data[1];
-		target->z = data[2];
+	void *indices = SDL_realloc(primitive->indices, primitive->index_count * primitive->index_size);
+	if (indices != nullptr)
+	{
+		primitive->indices = indices;
 	}
 
-	SDL_free(out);
 	return true;
 }
 
@@ -386,199 +703,465 @@ static bool supported_attribute(const cgltf_attribute_type type)
 {
 	return (bool) (type == prop_vertex_position
 		|| type == prop_vertex_normal
-		|| type == prop_vertex_tex_coord
-		|| type == prop_index);
+		|| type == prop_vertex_tex_coord);
 }
 
-static void set_primitive_material(const mesh_primitive_t *primitive,
+static void set_primitive_material(mesh_primitive_t *primitive,
 	const material_t *material)
 {
-	for (size_t j = 0; j < primitive->vertex_count; j++)
-	{
-		primitive_vertex_t *vertex = primitive->vertices + j;
-		vertex->color = *((vector4f_t*) material->color);
-	}
+	primitive->color = *((vector4f_t*) material->color);
 }
 
-static bool load_model_data(model_info_t *model, const cgltf_data *gltf_data)
+[[nodiscard]]
+static bool load_primitive(const model_info_t *model, const cgltf_primitive *gltf_primitive,
+	mesh_primitive_t *primitive)
 {
-	model->node_count = gltf_data->nodes_count;
-	model->nodes = SDL_calloc(sizeof(model_node_t), model->node_count);
-
-	for (size_t nn = 0; nn < gltf_data->nodes_count; nn++)
+	if (gltf_primitive->type != cgltf_primitive_type_triangles)
 	{
-		const cgltf_node *gltf_node = gltf_data->nodes + nn;
-		model_node_t *node = model->nodes + nn;
+		return SDL_SetError("Invalid primitive: %s",
+			cgltf_primitive_type_string(gltf_primitive->type));
+	}
 
-		if (gltf_node->name == nullptr)
-		{
-			SDL_LogWarn(LOG_CATEGORY_MODEL, "Node %zu does not have a name", nn + 1);
-			SDL_asprintf(&node->name, "node%02zu", nn);
-		}
-		else
-		{
-			SDL_LogDebug(LOG_CATEGORY_MODEL, "Found node: %s", gltf_node->name);
-			node->name = SDL_strdup(gltf_node->name);
-		}
+	if (gltf_primitive->has_draco_mesh_compression)
+	{
+		return SDL_SetError("Draco compression is not supported");
+	}
 
-		node->translation = *((vector3f_t*) gltf_node->translation);
+	primitive->vertices = nullptr;
+	primitive->vertex_count = 0;
 
-		const cgltf_mesh *gltf_mesh = gltf_node->mesh;
-		if (gltf_mesh == nullptr)
-		{
-			continue;
-		}
+	primitive->indices = nullptr;
+	primitive->index_count = 0;
 
-		cgltf_node_transform_world(gltf_node, (cgltf_float*) &node->world_transform.m);
+	// All attributes have the same count
+	const size_t vertex_count = gltf_primitive->attributes_count > 0
+		? gltf_primitive->attributes->data->count
+		: 0;
 
-		node->primitive_count = gltf_mesh->primitives_count;
-		node->primitives = SDL_calloc(node->primitive_count, sizeof(mesh_primitive_t));
+	primitive->index_size = mesh_primitive_index_size(vertex_count);
 
-		for (size_t pp = 0; pp < gltf_mesh->primitives_count; pp++)
-		{
-			const cgltf_primitive *gltf_primitive = gltf_mesh->primitives + pp;
+	if (gltf_primitive->indices != nullptr
+		&& !load_indices(gltf_primitive->indices, vertex_count, primitive))
+	{
+		return false;
+	}
 
-			if (gltf_primitive->type != cgltf_primitive_type_triangles)
-			{
-				return SDL_SetError("Invalid primitive: %s",
-					cgltf_primitive_type_string(gltf_primitive->type));
-			}
+	for (cgltf_size aa = 0; aa < gltf_primitive->attributes_count; aa++)
+	{
+		const cgltf_attribute *gltf_attribute = gltf_primitive->attributes + aa;
 
-			if (gltf_primitive->has_draco_mesh_compression)
+		if (!supported_attribute(gltf_attribute->type)
+			|| !load_buffer_data(gltf_attribute->data, primitive, gltf_attribute->type))
+		{
+			if (SDL_strlen(SDL_GetError()) > 0)
 			{
-				return SDL_SetError("Draco compression is not supported");
+				return false;
 			}
 
-			mesh_primitive_t *primitive = node->primitives + pp;
+			return SDL_SetError("Unsupported attribute: %s (%s %s)",
+				cgltf_attribute_type_string(gltf_attribute->type),
+				cgltf_type_string(gltf_attribute->data->type),
+				cgltf_component_type_string(gltf_attribute->data->component_type)
+			);
+		}
+	}
 
-			primitive->vertices = nullptr;
-			primitive->vertex_count = 0;
+	for (size_t mm = 0; mm < model->material_count; mm++)
+	{
+		const material_t *material = model->materials + mm;
+		if (SDL_strcmp(gltf_primitive->material->name, material->name) == 0)
+		{
+			set_primitive_material(primitive, material);
+			break;
+		}
+	}
 
-			primitive->indices = nullptr;
-			primitive->index_count = 0;
+	if (!mesh_primitive_optimize(primitive))
+	{
+		return false;
+	}
 
-			if (gltf_primitive->indices != nullptr
-				&& !load_buffer_data(gltf_primitive->indices, primitive, prop_index))
-			{
-				return false;
-			}
+	mesh_primitive_update_bounds(primitive);
 
-			for (cgltf_size aa = 0; aa < gltf_primitive->attributes_count; aa++)
-			{
-				const cgltf_attribute *gltf_attribute = gltf_primitive->attributes + aa;
-
-				if (!supported_attribute(gltf_attribute->type)
-					|| !load_buffer_data(gltf_attribute->data, primitive, gltf_attribute->type))
-				{
-					if (SDL_strlen(SDL_GetError()) > 0)
-					{
-						return false;
-					}
-
-					return SDL_SetError("Unsupported attribute: %s (%s %s)",
-						cgltf_attribute_type_string(gltf_attribute->type),
-						cgltf_type_string(gltf_attribute->data->type),
-						cgltf_component_type_string(gltf_attribute->data->component_type)
-					);
-				}
-			}
+	return mesh_primitive_build_clusters(primitive)
+		&& mesh_primitive_generate_lods(primitive, lod_ratios, lod_ratio_count);
+}
 
-			for (size_t mm = 0; mm < model->material_count; mm++)
-			{
-				const material_t *material = model->materials + mm;
-				if (SDL_strcmp(gltf_primitive->material->name, material->name) == 0)
-				{
-					set_primitive_material(primitive, material);
-					break;
-				}
-			}
+[[nodiscard]]
+static bool load_primitives_serial(const model_info_t *model, const primitive_job_t *jobs,
+	const size_t job_count)
+{
+	for (size_t jj = 0; jj < job_count; jj++)
+	{
+		if (!load_primitive(model, jobs[jj].gltf_primitive, jobs[jj].primitive))
+		{
+			return false;
 		}
 	}
 
 	return true;
 }
 
-static bool load_cameras(model_info_t *model, const cgltf_data *gltf_data)
+static void release_primitive_batch(primitive_batch_t *batch)
 {
-	model->camera_count = gltf_data->cameras_count;
-	if (model->camera_count == 0)
+	if (!SDL_AtomicDecRef(&batch->refs))
 	{
-		return true;
+		return;
 	}
 
-	model->cameras = SDL_calloc(model->camera_count, sizeof(scene_camera_t));
-	if (model->cameras == nullptr)
+	if (batch->finished != nullptr)
 	{
-		return false;
+		SDL_DestroyCondition(batch->finished);
 	}
 
-	for (size_t cc = 0; cc < model->camera_count; cc++)
+	if (batch->mutex != nullptr)
 	{
-		const cgltf_camera *gltf_camera = gltf_data->cameras + cc;
-		SDL_LogDebug(LOG_CATEGORY_MODEL, "Found camera: %s", gltf_camera->name);
-
-		scene_camera_t *camera = model->cameras + cc;
-		camera->name = SDL_strdup(gltf_camera->name);
+		SDL_DestroyMutex(batch->mutex);
 	}
 
-	return true;
+	SDL_free(batch->error);
+	SDL_free(batch);
 }
 
-bool model_info_create(const assets_t *assets, SDL_IOStream *stream,
-	const bool close_io, model_info_t *model)
+static void run_primitive_batch(primitive_batch_t *batch)
 {
-	size_t file_size = 0;
-	void *file_data = SDL_LoadFile_IO(stream, &file_size, close_io);
-	if (file_data == nullptr)
+	// Jobs are only read after being claimed, which can't happen once the calling thread returned
+	for (size_t jj = (size_t) SDL_AddAtomicInt(&batch->next_job, 1); jj < batch->job_count;
+		jj = (size_t) SDL_AddAtomicInt(&batch->next_job, 1))
 	{
-		return false;
-	}
+		const primitive_job_t *job = batch->jobs + jj;
 
-	model->materials = nullptr;
+		SDL_ClearError();
+		const bool success = load_primitive(batch->model, job->gltf_primitive, job->primitive);
+
+		SDL_LockMutex(batch->mutex);
+		{
+			if (!success && batch->error == nullptr)
+			{
+				batch->error = SDL_strdup(SDL_GetError());
+			}
+
+			batch->finished_count++;
+			if (batch->finished_count == batch->job_count)
+			{
+				SDL_BroadcastCondition(batch->finished);
+			}
+		}
+		SDL_UnlockMutex(batch->mutex);
+	}
+}
+
+static void primitive_batch_helper(void *userdata)
+{
+	primitive_batch_t *batch = userdata;
+	run_primitive_batch(batch);
+	release_primitive_batch(batch);
+}
+
+[[nodiscard]]
+static bool load_primitives_parallel(thread_pool_t *pool, const model_info_t *model,
+	const primitive_job_t *jobs, const size_t job_count)
+{
+	primitive_batch_t *batch = SDL_calloc(1, sizeof(primitive_batch_t));
+	if (batch == nullptr)
+	{
+		return false;
+	}
+
+	batch->model = model;
+	batch->jobs = jobs;
+	batch->job_count = job_count;
+	SDL_SetAtomicInt(&batch->refs, 1);
+
+	batch->mutex = SDL_CreateMutex();
+	batch->finished = SDL_CreateCondition();
+
+	if (batch->mutex == nullptr || batch->finished == nullptr)
+	{
+		release_primitive_batch(batch);
+		return false;
+	}
+
+	// The calling thread decodes as well, so helpers that never start don't block anything
+	const size_t core_count = (size_t) SDL_max(SDL_GetNumLogicalCPUCores(), 1);
+	const size_t helper_count = SDL_min(job_count, core_count) - 1;
+
+	for (size_t hh = 0; hh < helper_count; hh++)
+	{
+		SDL_AtomicIncRef(&batch->refs);
+		if (!thread_pool_submit(pool, primitive_batch_helper, batch))
+		{
+			SDL_AddAtomicInt(&batch->refs, -1);
+			break;
+		}
+	}
+
+	run_primitive_batch(batch);
+
+	SDL_LockMutex(batch->mutex);
+	{
+		while (batch->finished_count < batch->job_count)
+		{
+			SDL_WaitCondition(batch->finished, batch->mutex);
+		}
+	}
+	SDL_UnlockMutex(batch->mutex);
+
+	const bool success = batch->error == nullptr;
+	if (!success)
+	{
+		SDL_SetError("%s", batch->error);
+	}
+
+	release_primitive_batch(batch);
+	return success;
+}
+
+/**
+ * Decode all primitives of all meshes, in parallel when there's enough to decode
+ */
+[[nodiscard]]
+static bool load_primitives(const model_info_t *model, const cgltf_data *gltf_data)
+{
+	size_t job_count = 0;
+	size_t vertex_count = 0;
+
+	for (size_t mm = 0; mm < model->mesh_count; mm++)
+	{
+		const cgltf_mesh *gltf_mesh = gltf_data->meshes + mm;
+		if (model->meshes[mm].primitives == nullptr)
+		{
+			continue;
+		}
+
+		job_count += gltf_mesh->primitives_count;
+
+		for (size_t pp = 0; pp < gltf_mesh->primitives_count; pp++)
+		{
+			const cgltf_primitive *gltf_primitive = gltf_mesh->primitives + pp;
+			vertex_count += gltf_primitive->attributes_count > 0
+				? gltf_primitive->attributes->data->count
+				: 0;
+		}
+	}
+
+	if (job_count == 0)
+	{
+		return true;
+	}
+
+	primitive_job_t *jobs = SDL_malloc(sizeof(primitive_job_t) * job_count);
+	if (jobs == nullptr)
+	{
+		return false;
+	}
+
+	primitive_job_t *job = jobs;
+	for (size_t mm = 0; mm < model->mesh_count; mm++)
+	{
+		const cgltf_mesh *gltf_mesh = gltf_data->meshes + mm;
+		const model_mesh_t *mesh = model->meshes + mm;
+
+		for (size_t pp = 0; mesh->primitives != nullptr && pp < mesh->primitive_count; pp++)
+		{
+			*job++ = (primitive_job_t){
+				.gltf_primitive = gltf_mesh->primitives + pp,
+				.primitive = mesh->primitives + pp,
+			};
+		}
+	}
+
+	thread_pool_t *pool = SDL_GetAtomicPointer(&import_pool);
+
+	// Small models decode faster than it takes to wake up other threads
+	const bool parallel = pool != nullptr
+		&& job_count > 1
+		&& vertex_count >= import_min_vertex_count;
+
+	const Uint64 begin = SDL_GetTicks();
+
+	const bool success = parallel
+		? load_primitives_parallel(pool, model, jobs, job_count)
+		: load_primitives_serial(model, jobs, job_count);
+
+	SDL_free(jobs);
+
+	if (success)
+	{
+		SDL_LogDebug(LOG_CATEGORY_MODEL, "Decoded %zu primitives (%zu vertices) %s in %lu ms",
+			job_count, vertex_count, parallel ? "in parallel" : "serially", SDL_GetTicks() - begin);
+	}
+
+	return success;
+}
+
+static bool load_model_data(model_info_t *model, const cgltf_data *gltf_data)
+{
+	model->mesh_count = gltf_data->meshes_count;
+	model->meshes = SDL_calloc(model->mesh_count, sizeof(model_mesh_t));
+
+	model->node_count = gltf_data->nodes_count;
+	model->nodes = SDL_calloc(sizeof(model_node_t), model->node_count);
+
+	if (model->meshes == nullptr || model->nodes == nullptr)
+	{
+		return false;
+	}
+
+	for (size_t nn = 0; nn < gltf_data->nodes_count; nn++)
+	{
+		const cgltf_node *gltf_node = gltf_data->nodes + nn;
+		model_node_t *node = model->nodes + nn;
+
+		if (gltf_node->name == nullptr)
+		{
+			SDL_LogWarn(LOG_CATEGORY_MODEL, "Node %zu does not have a name", nn + 1);
+			SDL_asprintf(&node->name, "node%02zu", nn);
+		}
+		else
+		{
+			SDL_LogDebug(LOG_CATEGORY_MODEL, "Found node: %s", gltf_node->name);
+			node->name = SDL_strdup(gltf_node->name);
+		}
+
+		node->translation = *((vector3f_t*) gltf_node->translation);
+
+		const cgltf_mesh *gltf_mesh = gltf_node->mesh;
+		if (gltf_mesh == nullptr)
+		{
+			continue;
+		}
+
+		cgltf_node_transform_world(gltf_node, (cgltf_float*) &node->world_transform.m);
+
+		// Decoded once all nodes are known, other nodes using it only keep their transform
+		model_mesh_t *mesh = model->meshes + cgltf_mesh_index(gltf_data, gltf_mesh);
+		if (mesh->primitives == nullptr)
+		{
+			mesh->primitives = SDL_calloc(gltf_mesh->primitives_count, sizeof(mesh_primitive_t));
+			if (mesh->primitives == nullptr)
+			{
+				return false;
+			}
+
+			// Set first, so partially loaded meshes are freed on failure
+			mesh->primitive_count = gltf_mesh->primitives_count;
+		}
+
+		node->mesh = mesh;
+	}
+
+	return load_primitives(model, gltf_data);
+}
+
+static bool load_cameras(model_info_t *model, const cgltf_data *gltf_data)
+{
+	model->camera_count = gltf_data->cameras_count;
+	if (model->camera_count == 0)
+	{
+		return true;
+	}
+
+	model->cameras = SDL_calloc(model->camera_count, sizeof(scene_camera_t));
+	if (model->cameras == nullptr)
+	{
+		return false;
+	}
+
+	for (size_t cc = 0; cc < model->camera_count; cc++)
+	{
+		const cgltf_camera *gltf_camera = gltf_data->cameras + cc;
+		SDL_LogDebug(LOG_CATEGORY_MODEL, "Found camera: %s", gltf_camera->name);
+
+		scene_camera_t *camera = model->cameras + cc;
+		camera->name = SDL_strdup(gltf_camera->name);
+	}
+
+	return true;
+}
+
+bool model_info_create(const assets_t *assets, SDL_IOStream *stream,
+	const bool close_io, model_info_t *model)
+{
+	size_t file_size = 0;
+	void *file_data = SDL_LoadFile_IO(stream, &file_size, close_io);
+	if (file_data == nullptr)
+	{
+		return false;
+	}
+
+	const bool result = model_info_create_mem(assets, file_data, file_size, model);
+	SDL_free(file_data);
+
+	return result;
+}
+
+static void init_model_info(const assets_t *assets, model_info_t *model)
+{
+	model->assets = assets;
+
+	model->materials = nullptr;
 	model->material_count = 0;
 
+	model->meshes = nullptr;
+	model->mesh_count = 0;
+
+	model->nodes = nullptr;
+	model->node_count = 0;
+
 	model->cameras = nullptr;
 	model->camera_count = 0;
+}
 
-	const Uint64 begin = SDL_GetTicks();
-
-	const cgltf_options options = {
+[[nodiscard]]
+static cgltf_options gltf_options(const assets_t *assets)
+{
+	cgltf_options options = {
 		.type = cgltf_file_type_gltf,
 		.memory = (cgltf_memory_options){
 			.alloc_func = gltf_alloc,
 			.free_func = gltf_free,
 		},
-		.file = (cgltf_file_options){
+	};
+
+	// Without assets, files are read from disk relative to the model
+	if (assets != nullptr)
+	{
+		options.file = (cgltf_file_options){
 			.read = gltf_read,
 			.user_data = (void*) assets,
-		}
-	};
+		};
+	}
 
-	cgltf_data *gltf_data = nullptr;
+	return options;
+}
 
-	cgltf_result result = cgltf_parse(&options, file_data, file_size, &gltf_data);
-	if (result != cgltf_result_success)
+/**
+ * Load buffers and convert parsed glTF data, gltf_data is freed afterwards
+ */
+[[nodiscard]]
+static bool load_gltf(const assets_t *assets, const cgltf_options *options,
+	cgltf_data *gltf_data, const char *gltf_path, model_info_t *model)
+{
+	const Uint64 begin = SDL_GetTicks();
+
+	if (assets != nullptr
+		&& (!map_buffers(assets, gltf_data) || !read_buffers(assets, gltf_data)))
 	{
-		SDL_SetError("%s", cgltf_error_string(result));
 		cgltf_free(gltf_data);
-		SDL_free(file_data);
 		return false;
 	}
 
-	const Uint64 parse_end = SDL_GetTicks();
-	SDL_LogDebug(LOG_CATEGORY_MODEL, "Parsed model in %lu ms", parse_end - begin);
-
-	result = cgltf_load_buffers(&options, gltf_data, ".");
+	const cgltf_result result = cgltf_load_buffers(options, gltf_data, gltf_path);
 	if (result != cgltf_result_success)
 	{
 		SDL_SetError("%s", cgltf_error_string(result));
 		cgltf_free(gltf_data);
-		SDL_free(file_data);
 		return false;
 	}
 
 	const Uint64 buffer_end = SDL_GetTicks();
-	SDL_LogDebug(LOG_CATEGORY_MODEL, "Loaded buffers in %lu ms", buffer_end - parse_end);
+	SDL_LogDebug(LOG_CATEGORY_MODEL, "Loaded buffers in %lu ms", buffer_end - begin);
 
 	log_debug_info(gltf_data);
 
@@ -587,12 +1170,10 @@ bool model_info_create(const assets_t *assets, SDL_IOStream *stream,
 		|| !load_cameras(model, gltf_data))
 	{
 		cgltf_free(gltf_data);
-		SDL_free(file_data);
 		return false;
 	}
 
 	cgltf_free(gltf_data);
-	SDL_free(file_data);
 
 	const Uint64 model_end = SDL_GetTicks();
 	SDL_LogDebug(LOG_CATEGORY_MODEL, "Loaded model data in %lu ms", model_end - buffer_end);
@@ -600,6 +1181,263 @@ bool model_info_create(const assets_t *assets, SDL_IOStream *stream,
 	return true;
 }
 
+bool model_info_create_mem(const assets_t *assets, const void *file_data,
+	const size_t file_size, model_info_t *model)
+{
+	init_model_info(assets, model);
+
+	const Uint64 begin = SDL_GetTicks();
+	const cgltf_options options = gltf_options(assets);
+
+	cgltf_data *gltf_data = nullptr;
+
+	const cgltf_result result = cgltf_parse(&options, file_data, file_size, &gltf_data);
+	if (result != cgltf_result_success)
+	{
+		SDL_SetError("%s", cgltf_error_string(result));
+		cgltf_free(gltf_data);
+		return false;
+	}
+
+	const Uint64 parse_end = SDL_GetTicks();
+	SDL_LogDebug(LOG_CATEGORY_MODEL, "Parsed model in %lu ms", parse_end - begin);
+
+	return load_gltf(assets, &options, gltf_data, ".", model);
+}
+
+/**
+ * Data of each dependency, viewed directly in the archive where possible,
+ * the rest is read in a single batch
+ * @param owned Set for dependencies that were read, and have to be freed
+ */
+[[nodiscard]]
+static bool preload_dependencies(const assets_t *assets, const model_deps_t *deps,
+	const void **data, void **owned)
+{
+	asset_read_t *reads = SDL_calloc(deps->count, sizeof(asset_read_t));
+	if (reads == nullptr)
+	{
+		return false;
+	}
+
+	size_t count = 0;
+
+	for (size_t i = 0; i < deps->count; i++)
+	{
+		const model_dependency_t *dependency = deps->items + i;
+
+		// Images are loaded separately as textures
+		if (dependency->type == MODEL_DEPENDENCY_IMAGE)
+		{
+			continue;
+		}
+
+		asset_view_t view;
+		if (assets_view(assets, dependency->asset_name, &view))
+		{
+			data[i] = view.data;
+			continue;
+		}
+
+		// Not in memory, or compressed
+		SDL_ClearError();
+
+		owned[i] = SDL_malloc((size_t) dependency->size);
+		if (owned[i] == nullptr)
+		{
+			SDL_free(reads);
+			return false;
+		}
+
+		data[i] = owned[i];
+		reads[count++] = (asset_read_t){
+			.name = dependency->asset_name,
+			.dst = owned[i],
+			.size = (size_t) dependency->size,
+		};
+	}
+
+	const bool result = assets_read_batch(assets, reads, count);
+	SDL_free(reads);
+
+	return result;
+}
+
+/**
+ * Point external buffers at their preloaded data, moving ownership to cgltf
+ */
+[[nodiscard]]
+static bool use_preloaded(const cgltf_data *gltf_data, const model_deps_t *deps,
+	const void **data, void **owned)
+{
+	for (cgltf_size i = 0; i < gltf_data->buffers_count; i++)
+	{
+		cgltf_buffer *buffer = gltf_data->buffers + i;
+		if (!is_external_buffer(buffer))
+		{
+			continue;
+		}
+
+		for (size_t j = 0; j < deps->count; j++)
+		{
+			const model_dependency_t *dependency = deps->items + j;
+
+			if (dependency->type != MODEL_DEPENDENCY_BUFFER
+				|| SDL_strcmp(dependency->uri, buffer->uri) != 0)
+			{
+				continue;
+			}
+
+			if (dependency->size < buffer->size)
+			{
+				return SDL_SetError("Buffer too small, found %" SDL_PRIu64 " but expected %zu",
+					dependency->size, buffer->size);
+			}
+
+			buffer->data = (void*) data[j];
+			buffer->data_free_method = owned[j] != nullptr
+				? cgltf_data_free_method_memory_free
+				: cgltf_data_free_method_none;
+
+			owned[j] = nullptr;
+			break;
+		}
+	}
+
+	return true;
+}
+
+[[nodiscard]]
+static bool create_preloaded(const assets_t *assets, const model_deps_t *deps,
+	const void **data, void **owned, model_info_t *model)
+{
+	const Uint64 begin = SDL_GetTicks();
+
+	if (!preload_dependencies(assets, deps, data, owned))
+	{
+		return false;
+	}
+
+	size_t gltf_index = 0;
+	while (gltf_index < deps->count && deps->items[gltf_index].type != MODEL_DEPENDENCY_GLTF)
+	{
+		gltf_index++;
+	}
+
+	if (gltf_index >= deps->count)
+	{
+		return SDL_SetError("Dependencies are missing the model itself");
+	}
+
+	const Uint64 preload_end = SDL_GetTicks();
+	SDL_LogDebug(LOG_CATEGORY_MODEL, "Preloaded %zu dependencies in %lu ms",
+		deps->count, preload_end - begin);
+
+	const cgltf_options options = gltf_options(assets);
+	cgltf_data *gltf_data = nullptr;
+
+	const cgltf_result result = cgltf_parse(&options, data[gltf_index],
+		(cgltf_size) deps->items[gltf_index].size, &gltf_data);
+
+	if (result != cgltf_result_success)
+	{
+		SDL_SetError("%s", cgltf_error_string(result));
+		cgltf_free(gltf_data);
+		return false;
+	}
+
+	SDL_LogDebug(LOG_CATEGORY_MODEL, "Parsed model in %lu ms", SDL_GetTicks() - preload_end);
+
+	if (!use_preloaded(gltf_data, deps, data, owned))
+	{
+		cgltf_free(gltf_data);
+		return false;
+	}
+
+	return load_gltf(assets, &options, gltf_data, ".", model);
+}
+
+bool model_info_create_preloaded(const assets_t *assets, const char *name, model_info_t *model)
+{
+	init_model_info(assets, model);
+
+	model_deps_t deps;
+	if (!model_deps_load(assets, name, &deps))
+	{
+		return false;
+	}
+
+	const void **data = SDL_calloc(deps.count, sizeof(void*));
+	void **owned = SDL_calloc(deps.count, sizeof(void*));
+
+	const bool result = data != nullptr && owned != nullptr
+		&& create_preloaded(assets, &deps, data, owned, model);
+
+	for (size_t i = 0; owned != nullptr && i < deps.count; i++)
+	{
+		SDL_free(owned[i]);
+	}
+
+	SDL_free(owned);
+	SDL_free((void*) data);
+	model_deps_destroy(&deps);
+
+	return result;
+}
+
+bool model_info_create_file(const char *path, model_info_t *model)
+{
+	init_model_info(nullptr, model);
+
+	const cgltf_options options = gltf_options(nullptr);
+
+	cgltf_data *gltf_data = nullptr;
+
+	const cgltf_result result = cgltf_parse_file(&options, path, &gltf_data);
+	if (result != cgltf_result_success)
+	{
+		SDL_SetError("%s: %s", path, cgltf_error_string(result));
+		cgltf_free(gltf_data);
+		return false;
+	}
+
+	return load_gltf(nullptr, &options, gltf_data, path, model);
+}
+
+bool model_info_set_lod_ratios(const float *ratios, const size_t count)
+{
+	if (count > mesh_max_lods)
+	{
+		return SDL_SetError("Too many levels of detail: %zu, at most %zu", count, mesh_max_lods);
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const float previous = i > 0 ? ratios[i - 1] : 1.F;
+		if (ratios[i] <= 0.F || ratios[i] >= previous)
+		{
+			return SDL_SetError("Invalid level of detail ratio: %g", (double) ratios[i]);
+		}
+	}
+
+	SDL_memcpy(lod_ratios, ratios, sizeof(float) * count);
+	lod_ratio_count = count;
+
+	return true;
+}
+
+size_t model_info_lod_ratios(float *ratios)
+{
+	SDL_memcpy(ratios, lod_ratios, sizeof(float) * lod_ratio_count);
+	return lod_ratio_count;
+}
+
+void model_info_set_thread_pool(thread_pool_t *pool, const size_t min_vertex_count)
+{
+	import_min_vertex_count = min_vertex_count;
+	SDL_SetAtomicPointer(&import_pool, pool);
+}
+
 void model_info_destroy(model_info_t *model)
 {
 	if (model == nullptr)
@@ -619,19 +1457,90 @@ void model_info_destroy(model_info_t *model)
 	for (size_t nn = 0; nn < model->node_count; nn++)
 	{
 		const model_node_t *node = model->nodes + nn;
-
 		SDL_free(node->name);
+	}
+	SDL_free(model->nodes);
+
+	for (size_t mm = 0; mm < model->mesh_count; mm++)
+	{
+		const model_mesh_t *mesh = model->meshes + mm;
 
-		for (size_t pp = 0; pp < node->primitive_count; pp++)
+		for (size_t pp = 0; pp < mesh->primitive_count; pp++)
 		{
-			const mesh_primitive_t *primitive = node->primitives + pp;
+			const mesh_primitive_t *primitive = mesh->primitives + pp;
 
 			SDL_free(primitive->vertices);
 			SDL_free(primitive->indices);
+			SDL_free(primitive->clusters);
+			SDL_free(primitive->gpu_asset);
 		}
-		SDL_free(node->primitives);
+		SDL_free(mesh->primitives);
 	}
-	SDL_free(model->nodes);
+	SDL_free(model->meshes);
+}
+
+void model_info_free_vertices(model_info_t *model)
+{
+	for (size_t mm = 0; mm < model->mesh_count; mm++)
+	{
+		const model_mesh_t *mesh = model->meshes + mm;
+
+		for (size_t pp = 0; pp < mesh->primitive_count; pp++)
+		{
+			mesh_primitive_t *primitive = mesh->primitives + pp;
+
+			SDL_free(primitive->vertices);
+			SDL_free(primitive->indices);
+
+			primitive->vertices = nullptr;
+			primitive->indices = nullptr;
+		}
+	}
+}
+
+size_t mesh_primitive_index_size(const size_t vertex_count)
+{
+	return vertex_count <= (size_t) SDL_MAX_UINT16 + 1
+		? sizeof(Uint16)
+		: sizeof(Uint32);
+}
+
+size_t mesh_primitive_stored_index_count(const mesh_primitive_t *primitive)
+{
+	// Levels are stored in order, after the full detail indices
+	return primitive->lod_count > 0
+		? primitive->lods[primitive->lod_count - 1].index_offset
+		+ primitive->lods[primitive->lod_count - 1].index_count
+		: primitive->index_count;
+}
+
+void mesh_primitive_update_bounds(mesh_primitive_t *primitive)
+{
+	if (primitive->vertex_count == 0)
+	{
+		primitive->bounds_min = vector3f_zero();
+		primitive->bounds_max = vector3f_zero();
+		return;
+	}
+
+	vector3f_t min = primitive->vertices[0].position;
+	vector3f_t max = min;
+
+	for (size_t i = 1; i < primitive->vertex_count; i++)
+	{
+		const vector3f_t position = primitive->vertices[i].position;
+
+		min.x = SDL_min(min.x, position.x);
+		min.y = SDL_min(min.y, position.y);
+		min.z = SDL_min(min.z, position.z);
+
+		max.x = SDL_max(max.x, position.x);
+		max.y = SDL_max(max.y, position.y);
+		max.z = SDL_max(max.z, position.z);
+	}
+
+	primitive->bounds_min = min;
+	primitive->bounds_max = max;
 }
 
 const char *model_node_name(const model_info_t *model, const size_t index)
@@ -654,3 +1563,32 @@ vector3f_t model_node_translation(const model_info_t *model, const size_t index)
 	SDL_assert(index < model->node_count);
 	return model->nodes[index].translation;
 }
+
+const char *model_camera_name(const model_info_t *model, const size_t index)
+{
+	SDL_assert(model != nullptr);
+	SDL_assert(index < model->camera_count);
+	return model->cameras[index].name;
+}
+
+bool model_info_add_camera(model_info_t *model, const char *name)
+{
+	scene_camera_t *cameras = SDL_realloc(model->cameras,
+		sizeof(scene_camera_t) * (model->camera_count + 1));
+
+	if (cameras == nullptr)
+	{
+		return false;
+	}
+
+	model->cameras = cameras;
+
+	char *camera_name = SDL_strdup(name);
+	if (camera_name == nullptr)
+	{
+		return false;
+	}
+
+	model->cameras[model->camera_count++].name = camera_name;
+	return true;
+}
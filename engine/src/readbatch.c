@@ -0,0 +1,450 @@
+#include "chirp/readbatch.h"
+#include "chirp/logcategory.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_hints.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+
+#ifdef IO_URING_ENABLED
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef IO_URING_ENABLED
+
+// Most reads in flight at the same time
+static constexpr Uint32 max_queue_depth = 64;
+
+/**
+ * Rings shared with the kernel, set up using the raw system calls,
+ * to not depend on liburing
+ */
+typedef struct io_ring
+{
+	int fd;
+	Uint32 entries;
+
+	void *sq_ring;
+	size_t sq_ring_size;
+	Uint32 *sq_tail;
+	const Uint32 *sq_head;
+	const Uint32 *sq_mask;
+	Uint32 *sq_array;
+
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+
+	void *cq_ring;
+	size_t cq_ring_size;
+	Uint32 *cq_head;
+	const Uint32 *cq_tail;
+	const Uint32 *cq_mask;
+	const struct io_uring_cqe *cqes;
+
+	// Queued, but not yet passed to the kernel
+	Uint32 pending;
+	// Passed to the kernel, but not yet completed
+	Uint32 in_flight;
+} io_ring_t;
+
+#endif
+
+struct read_batch
+{
+	file_reader_t reader;
+
+	const read_request_t *requests;
+	size_t count;
+
+	// Next request to start reading
+	size_t next;
+	size_t finished;
+	bool failed;
+
+#ifdef IO_URING_ENABLED
+	// Only used if fd is valid, otherwise reads are done one at a time
+	io_ring_t ring;
+	struct iovec *iovecs;
+	// Bytes read so far, reads can finish early and have to be continued
+	size_t *progress;
+#endif
+};
+
+#ifdef IO_URING_ENABLED
+
+static void *map_ring(const int fd, const size_t size, const off_t offset)
+{
+	void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, fd, offset);
+
+	return data != MAP_FAILED ? data : nullptr;
+}
+
+static void ring_destroy(const io_ring_t *ring)
+{
+	if (ring->sq_ring != nullptr)
+	{
+		munmap(ring->sq_ring, ring->sq_ring_size);
+	}
+
+	if (ring->cq_ring != nullptr)
+	{
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	}
+
+	if (ring->sqes != nullptr)
+	{
+		munmap(ring->sqes, ring->sqes_size);
+	}
+
+	if (ring->fd >= 0)
+	{
+		close(ring->fd);
+	}
+}
+
+[[nodiscard]]
+static bool ring_create(const Uint32 entries, io_ring_t *ring)
+{
+	*ring = (io_ring_t){
+		.fd = -1,
+	};
+
+	struct io_uring_params params = {};
+
+	ring->fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+	if (ring->fd < 0)
+	{
+		return SDL_SetError("Failed to set up io_uring: %s", strerror(errno));
+	}
+
+	ring->entries = params.sq_entries;
+	ring->sq_ring_size = params.sq_off.array + (params.sq_entries * sizeof(Uint32));
+	ring->cq_ring_size = params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	ring->sq_ring = map_ring(ring->fd, ring->sq_ring_size, IORING_OFF_SQ_RING);
+	ring->cq_ring = map_ring(ring->fd, ring->cq_ring_size, IORING_OFF_CQ_RING);
+	ring->sqes = map_ring(ring->fd, ring->sqes_size, IORING_OFF_SQES);
+
+	if (ring->sq_ring == nullptr || ring->cq_ring == nullptr || ring->sqes == nullptr)
+	{
+		const int error = errno;
+		ring_destroy(ring);
+		return SDL_SetError("Failed to map io_uring: %s", strerror(error));
+	}
+
+	Uint8 *sq = ring->sq_ring;
+	ring->sq_head = (const Uint32*) (sq + params.sq_off.head);
+	ring->sq_tail = (Uint32*) (sq + params.sq_off.tail);
+	ring->sq_mask = (const Uint32*) (sq + params.sq_off.ring_mask);
+	ring->sq_array = (Uint32*) (sq + params.sq_off.array);
+
+	Uint8 *cq = ring->cq_ring;
+	ring->cq_head = (Uint32*) (cq + params.cq_off.head);
+	ring->cq_tail = (const Uint32*) (cq + params.cq_off.tail);
+	ring->cq_mask = (const Uint32*) (cq + params.cq_off.ring_mask);
+	ring->cqes = (const struct io_uring_cqe*) (cq + params.cq_off.cqes);
+
+	return true;
+}
+
+/**
+ * Queue the rest of a request, without passing it to the kernel yet
+ */
+[[nodiscard]]
+static bool ring_queue(read_batch_t *batch, const size_t index)
+{
+	io_ring_t *ring = &batch->ring;
+
+	// Only written by us, but read by the kernel
+	const Uint32 tail = *ring->sq_tail;
+	if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >= ring->entries)
+	{
+		return SDL_SetError("Submission queue is full");
+	}
+
+	const read_request_t *request = batch->requests + index;
+	struct iovec *iovec = batch->iovecs + index;
+
+	iovec->iov_base = (Uint8*) request->dst + batch->progress[index];
+	iovec->iov_len = request->size - batch->progress[index];
+
+	const Uint32 slot = tail & *ring->sq_mask;
+	struct io_uring_sqe *sqe = ring->sqes + slot;
+
+	*sqe = (struct io_uring_sqe){
+		.opcode = IORING_OP_READV,
+		.fd = (int) batch->reader.handle,
+		.off = request->offset + batch->progress[index],
+		.addr = (Uint64) (uintptr_t) iovec,
+		.len = 1,
+		.user_data = index,
+	};
+
+	ring->sq_array[slot] = slot;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	ring->pending++;
+	ring->in_flight++;
+
+	return true;
+}
+
+/**
+ * Pass queued reads to the kernel, optionally waiting for some of them to complete
+ */
+[[nodiscard]]
+static bool ring_enter(io_ring_t *ring, const Uint32 min_complete)
+{
+	while (true)
+	{
+		const int submitted = (int) syscall(__NR_io_uring_enter, ring->fd, ring->pending,
+			min_complete, min_complete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+
+		if (submitted >= 0)
+		{
+			ring->pending -= (Uint32) submitted;
+			return true;
+		}
+
+		if (errno != EINTR)
+		{
+			return SDL_SetError("Failed to submit reads: %s", strerror(errno));
+		}
+	}
+}
+
+/**
+ * @returns false if nothing has completed yet
+ */
+[[nodiscard]]
+static bool ring_complete(io_ring_t *ring, size_t *index, int *result)
+{
+	const Uint32 head = *ring->cq_head;
+	if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+	{
+		return false;
+	}
+
+	const struct io_uring_cqe *cqe = ring->cqes + (head & *ring->cq_mask);
+	*index = (size_t) cqe->user_data;
+	*result = cqe->res;
+
+	__atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+	ring->in_flight--;
+
+	return true;
+}
+
+/**
+ * Queue as many new requests as there's room for
+ */
+static void ring_fill(read_batch_t *batch)
+{
+	while (batch->next < batch->count
+		&& batch->ring.in_flight < batch->ring.entries
+		&& ring_queue(batch, batch->next))
+	{
+		batch->next++;
+	}
+}
+
+/**
+ * Stop using the ring, only safe once nothing is in flight
+ */
+static void stop_ring(read_batch_t *batch)
+{
+	ring_destroy(&batch->ring);
+	SDL_free(batch->iovecs);
+	SDL_free(batch->progress);
+
+	batch->ring = (io_ring_t){
+		.fd = -1,
+	};
+	batch->iovecs = nullptr;
+	batch->progress = nullptr;
+	batch->next = 0;
+}
+
+[[nodiscard]]
+static bool start_ring(read_batch_t *batch)
+{
+	const Uint32 entries = (Uint32) SDL_min(batch->count, max_queue_depth);
+
+	if (!ring_create(entries, &batch->ring))
+	{
+		return false;
+	}
+
+	batch->iovecs = SDL_calloc(batch->count, sizeof(struct iovec));
+	batch->progress = SDL_calloc(batch->count, sizeof(size_t));
+
+	if (batch->iovecs == nullptr || batch->progress == nullptr)
+	{
+		return false;
+	}
+
+	ring_fill(batch);
+	return ring_enter(&batch->ring, 0);
+}
+
+/**
+ * Handle the next completed read, continuing it if it finished early
+ * @param request Set if the entire request is finished
+ */
+[[nodiscard]]
+static bool wait_ring(read_batch_t *batch, const read_request_t **request)
+{
+	size_t index;
+	int result;
+
+	while (!ring_complete(&batch->ring, &index, &result))
+	{
+		ring_fill(batch);
+
+		if (!ring_enter(&batch->ring, 1))
+		{
+			return false;
+		}
+	}
+
+	if (result == -EAGAIN || result == -EINTR)
+	{
+		return ring_queue(batch, index);
+	}
+
+	if (result < 0)
+	{
+		return SDL_SetError("Failed to read file: %s", strerror(-result));
+	}
+
+	if (result == 0)
+	{
+		return SDL_SetError("Unexpected end of file");
+	}
+
+	batch->progress[index] += (size_t) result;
+
+	if (batch->progress[index] < batch->requests[index].size)
+	{
+		return ring_queue(batch, index);
+	}
+
+	batch->finished++;
+	*request = batch->requests + index;
+
+	return true;
+}
+
+#endif
+
+read_batch_t *read_batch_submit(const file_reader_t *reader,
+	const read_request_t *requests, const size_t count)
+{
+	read_batch_t *batch = SDL_calloc(1, sizeof(read_batch_t));
+	if (batch == nullptr)
+	{
+		return nullptr;
+	}
+
+	batch->reader = *reader;
+	batch->requests = requests;
+	batch->count = count;
+
+#ifdef IO_URING_ENABLED
+	batch->ring.fd = -1;
+
+	if (count > 0
+		&& SDL_GetHintBoolean(READ_BATCH_HINT_IO_URING, true)
+		&& !start_ring(batch))
+	{
+		// Most likely an older kernel, or blocked by a sandbox
+		SDL_LogDebug(LOG_CATEGORY_ASSETS, "Reading one at a time: %s", SDL_GetError());
+		SDL_ClearError();
+
+		// Nothing was passed to the kernel if starting failed
+		stop_ring(batch);
+	}
+#endif
+
+	return batch;
+}
+
+bool read_batch_wait(read_batch_t *batch, const read_request_t **request)
+{
+	*request = nullptr;
+
+	if (batch->failed)
+	{
+		return false;
+	}
+
+	while (batch->finished < batch->count && *request == nullptr)
+	{
+#ifdef IO_URING_ENABLED
+		if (batch->ring.fd >= 0)
+		{
+			if (!wait_ring(batch, request))
+			{
+				batch->failed = true;
+				return false;
+			}
+			continue;
+		}
+#endif
+
+		const read_request_t *next = batch->requests + batch->next;
+
+		if (file_reader_read_at(&batch->reader, next->dst, next->size, next->offset) != next->size)
+		{
+			batch->failed = true;
+			return SDL_SetError("Failed to read %zu bytes at %" SDL_PRIu64, next->size, next->offset);
+		}
+
+		batch->next++;
+		batch->finished++;
+		*request = next;
+	}
+
+	return true;
+}
+
+void read_batch_destroy(read_batch_t *batch)
+{
+	if (batch == nullptr)
+	{
+		return;
+	}
+
+#ifdef IO_URING_ENABLED
+	io_ring_t *ring = &batch->ring;
+
+	// Reads still in flight write into memory the caller is about to free
+	if (ring->fd >= 0)
+	{
+		size_t index;
+		int result;
+
+		while (ring->in_flight > 0)
+		{
+			if (!ring_complete(ring, &index, &result) && !ring_enter(ring, 1))
+			{
+				break;
+			}
+		}
+	}
+
+	stop_ring(batch);
+#endif
+
+	SDL_free(batch);
+}
@@ -0,0 +1,166 @@
+#include "chirp/threadpool.h"
+#include "chirp/logcategory.h"
+
+#include <SDL3/SDL_cpuinfo.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_thread.h>
+
+typedef struct thread_pool_entry
+{
+	thread_pool_job_t job;
+	void *userdata;
+	struct thread_pool_entry *next;
+} thread_pool_entry_t;
+
+struct thread_pool
+{
+	SDL_Mutex *mutex;
+	SDL_Condition *job_available;
+
+	thread_pool_entry_t *first;
+	thread_pool_entry_t *last;
+	bool quit;
+
+	SDL_Thread **threads;
+	int thread_count;
+};
+
+[[nodiscard]]
+static thread_pool_entry_t *next_entry(thread_pool_t *pool)
+{
+	SDL_LockMutex(pool->mutex);
+
+	while (pool->first == nullptr && !pool->quit)
+	{
+		SDL_WaitCondition(pool->job_available, pool->mutex);
+	}
+
+	// Remaining jobs are still finished when quitting
+	thread_pool_entry_t *entry = pool->first;
+	if (entry != nullptr)
+	{
+		pool->first = entry->next;
+		if (pool->first == nullptr)
+		{
+			pool->last = nullptr;
+		}
+	}
+
+	SDL_UnlockMutex(pool->mutex);
+	return entry;
+}
+
+static int run_worker(void *data)
+{
+	thread_pool_t *pool = data;
+
+	thread_pool_entry_t *entry;
+	while ((entry = next_entry(pool)) != nullptr)
+	{
+		entry->job(entry->userdata);
+		SDL_free(entry);
+	}
+
+	return 0;
+}
+
+[[nodiscard]]
+static int default_thread_count()
+{
+	// Leave one core for the main thread
+	const int cores = SDL_GetNumLogicalCPUCores();
+	return cores > 1 ? cores - 1 : 1;
+}
+
+thread_pool_t *thread_pool_create(const char *name, const int thread_count)
+{
+	thread_pool_t *pool = SDL_calloc(1, sizeof(thread_pool_t));
+	if (pool == nullptr)
+	{
+		return nullptr;
+	}
+
+	pool->mutex = SDL_CreateMutex();
+	pool->job_available = SDL_CreateCondition();
+
+	const int count = thread_count > 0 ? thread_count : default_thread_count();
+	pool->threads = SDL_calloc(count, sizeof(SDL_Thread*));
+
+	if (pool->mutex == nullptr || pool->job_available == nullptr || pool->threads == nullptr)
+	{
+		thread_pool_destroy(pool);
+		return nullptr;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		pool->threads[i] = SDL_CreateThread(run_worker, name, pool);
+		if (pool->threads[i] == nullptr)
+		{
+			thread_pool_destroy(pool);
+			return nullptr;
+		}
+		pool->thread_count++;
+	}
+
+	SDL_LogDebug(LOG_CATEGORY_CORE, "Created %d threads for %s", count, name);
+	return pool;
+}
+
+void thread_pool_destroy(thread_pool_t *pool)
+{
+	if (pool == nullptr)
+	{
+		return;
+	}
+
+	if (pool->mutex != nullptr)
+	{
+		SDL_LockMutex(pool->mutex);
+		pool->quit = true;
+		SDL_BroadcastCondition(pool->job_available);
+		SDL_UnlockMutex(pool->mutex);
+	}
+
+	for (int i = 0; i < pool->thread_count; i++)
+	{
+		SDL_WaitThread(pool->threads[i], nullptr);
+	}
+
+	SDL_free(pool->threads);
+	SDL_DestroyCondition(pool->job_available);
+	SDL_DestroyMutex(pool->mutex);
+	SDL_free(pool);
+}
+
+bool thread_pool_submit(thread_pool_t *pool, const thread_pool_job_t job, void *userdata)
+{
+	thread_pool_entry_t *entry = SDL_malloc(sizeof(thread_pool_entry_t));
+	if (entry == nullptr)
+	{
+		return false;
+	}
+
+	entry->job = job;
+	entry->userdata = userdata;
+	entry->next = nullptr;
+
+	SDL_LockMutex(pool->mutex);
+
+	if (pool->last != nullptr)
+	{
+		pool->last->next = entry;
+	}
+	else
+	{
+		pool->first = entry;
+	}
+	pool->last = entry;
+
+	SDL_SignalCondition(pool->job_available);
+	SDL_UnlockMutex(pool->mutex);
+
+	return true;
+}
@@ -0,0 +1,187 @@
+#include "chirp/vertexformat.h"
+#include "chirp/matrix.h"
+#include "chirp/modelinfo.h"
+#include "chirp/vector.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+size_t vertex_format_size(const vertex_format_t format)
+{
+	switch (format)
+	{
+		case VERTEX_FORMAT_QUANTIZED:
+			return sizeof(quantized_vertex_t);
+
+		case VERTEX_FORMAT_FLOAT:
+		default:
+			return sizeof(primitive_vertex_t);
+	}
+}
+
+[[nodiscard]]
+static Sint16 snorm16(const float value)
+{
+	return (Sint16) SDL_lroundf(SDL_clamp(value, -1.F, 1.F) * (float) SDL_MAX_SINT16);
+}
+
+Uint16 vertex_half_from_float(const float value)
+{
+	Uint32 bits;
+	SDL_memcpy(&bits, &value, sizeof(Uint32));
+
+	const Uint16 sign = (Uint16) ((bits >> 16) & 0x8000);
+	const Sint32 exponent = (Sint32) ((bits >> 23) & 0xff) - 127 + 15;
+	Uint32 mantissa = bits & 0x7fffff;
+
+	// Infinity or NaN
+	if ((bits & 0x7fffffff) >= 0x7f800000)
+	{
+		return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+	}
+
+	if (exponent >= 31)
+	{
+		return sign | 0x7c00;
+	}
+
+	// Denormal, or too small even for that
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+		{
+			return sign;
+		}
+
+		mantissa |= 0x800000;
+
+		const Uint32 shift = (Uint32) (14 - exponent);
+		const Uint32 remainder = mantissa & ((1U << shift) - 1);
+		const Uint32 halfway = 1U << (shift - 1);
+		Uint32 half = mantissa >> shift;
+
+		if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+		{
+			half++;
+		}
+
+		return sign | (Uint16) half;
+	}
+
+	const Uint32 remainder = mantissa & 0x1fff;
+	Uint32 half = ((Uint32) exponent << 10) | (mantissa >> 13);
+
+	// Rounding up may carry into the exponent, which is still correct
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1) != 0))
+	{
+		half++;
+	}
+
+	return sign | (Uint16) half;
+}
+
+float vertex_half_to_float(const Uint16 value)
+{
+	const Uint32 sign = (Uint32) (value & 0x8000) << 16;
+	const Uint32 exponent = (value >> 10) & 0x1f;
+	const Uint32 mantissa = value & 0x3ff;
+
+	if (exponent == 0)
+	{
+		const float result = SDL_scalbnf((float) mantissa, -24);
+		return sign != 0 ? -result : result;
+	}
+
+	const Uint32 bits = exponent == 31
+		? sign | 0x7f800000 | (mantissa << 13)
+		: sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+	float result;
+	SDL_memcpy(&result, &bits, sizeof(float));
+	return result;
+}
+
+[[nodiscard]]
+static vector3f_t bounds_center(const mesh_primitive_t *primitive)
+{
+	return vector3f_scale(vector3f_add(primitive->bounds_min, primitive->bounds_max), 0.5F);
+}
+
+[[nodiscard]]
+static vector3f_t bounds_extent(const mesh_primitive_t *primitive)
+{
+	return vector3f_scale(vector3f_sub(primitive->bounds_max, primitive->bounds_min), 0.5F);
+}
+
+[[nodiscard]]
+static float quantize_axis(const float value, const float center, const float extent)
+{
+	// Flat along this axis, so every vertex is at the center
+	return extent > 0.F ? (value - center) / extent : 0.F;
+}
+
+static void encode_quantized(const mesh_primitive_t *primitive, const primitive_vertex_t *vertices,
+	quantized_vertex_t *destination)
+{
+	const vector3f_t center = bounds_center(primitive);
+	const vector3f_t extent = bounds_extent(primitive);
+
+	for (size_t i = 0; i < primitive->vertex_count; i++)
+	{
+		const primitive_vertex_t *vertex = vertices + i;
+
+		destination[i] = (quantized_vertex_t){
+			.position = {
+				snorm16(quantize_axis(vertex->position.x, center.x, extent.x)),
+				snorm16(quantize_axis(vertex->position.y, center.y, extent.y)),
+				snorm16(quantize_axis(vertex->position.z, center.z, extent.z)),
+				0,
+			},
+			.normal = {
+				snorm16(vertex->normal.x),
+				snorm16(vertex->normal.y),
+				snorm16(vertex->normal.z),
+				0,
+			},
+			.tex_coord = {
+				vertex_half_from_float(vertex->tex_coord.x),
+				vertex_half_from_float(vertex->tex_coord.y),
+			},
+		};
+	}
+}
+
+void vertex_format_encode(const vertex_format_t format, const mesh_primitive_t *primitive,
+	const primitive_vertex_t *vertices, void *destination)
+{
+	switch (format)
+	{
+		case VERTEX_FORMAT_QUANTIZED:
+			encode_quantized(primitive, vertices, destination);
+			break;
+
+		case VERTEX_FORMAT_FLOAT:
+		default:
+			SDL_memcpy(destination, vertices, sizeof(primitive_vertex_t) * primitive->vertex_count);
+			break;
+	}
+}
+
+matrix4x4_t vertex_format_dequantize(const vertex_format_t format, const mesh_primitive_t *primitive)
+{
+	if (format != VERTEX_FORMAT_QUANTIZED)
+	{
+		return matrix4x4_create_scale(vector3f_one());
+	}
+
+	const vector3f_t center = bounds_center(primitive);
+	const vector3f_t extent = bounds_extent(primitive);
+
+	return (matrix4x4_t){
+		extent.x, 0, 0, 0,
+		0, extent.y, 0, 0,
+		0, 0, extent.z, 0,
+		center.x, center.y, center.z, 1,
+	};
+}
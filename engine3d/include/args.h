@@ -78,6 +78,64 @@ typedef struct
 	 * Enable ECS task threads and set number of worker task threads
 	 */
 	Sint32 task_threads;
+
+	/**
+	 * --asset-cache-size [0-]
+	 *
+	 * Memory budget in MiB for decoded assets that are no longer in use
+	 */
+	Sint32 asset_cache_size;
+
+	/**
+	 * --asset-map / --no-asset-map
+	 *
+	 * Memory map archives where possible, enabled by default,
+	 * otherwise reads go through the block cache and are batched
+	 */
+	arg_option_t asset_map;
+
+	/**
+	 * --asset-block-size [KiB]
+	 *
+	 * Size of each block in the block cache, used when assets aren't memory mapped
+	 */
+	const char *asset_block_size;
+
+	/**
+	 * --asset-block-count [0-]
+	 *
+	 * Number of blocks in the block cache, 0 disables it,
+	 * memory mapped archives, as on desktop, read through the page cache instead
+	 */
+	const char *asset_block_count;
+
+	/**
+	 * --asset-trace <file>
+	 *
+	 * Record every asset accessed to a trace file, used by --asset-readahead and chirp-pack
+	 */
+	const char *asset_trace;
+
+	/**
+	 * --asset-readahead <file>
+	 *
+	 * Prefetch assets in a previously recorded trace in the background on startup
+	 */
+	const char *asset_readahead;
+
+	/**
+	 * --asset-disk-cache / --no-asset-disk-cache
+	 *
+	 * Keep decoded models and textures in the pref path, so they're only decoded once
+	 */
+	arg_option_t asset_disk_cache;
+
+	/**
+	 * --quantize-vertices / --no-quantize-vertices
+	 *
+	 * Store model vertices in GPU buffers as 16-bit values instead of floats, enabled by default
+	 */
+	arg_option_t quantize_vertices;
 } args_t;
 
 [[nodiscard]]
@@ -2,16 +2,42 @@
 
 #include "model.h"
 
+#include "chirp/assetloader.h"
+#include "chirp/vertexformat.h"
+
 #include <SDL3/SDL_gpu.h>
 #include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_stdinc.h>
 #include <SDL3/SDL_surface.h>
 
+/**
+ * Called with the loaded model, or nullptr on failure
+ */
+typedef void (*model_loaded_t)(const char *name, model_t *model, void *userdata);
+
 [[nodiscard]]
 SDL_Surface *assets_load_texture(const assets_t *assets, const char *name);
 
 [[nodiscard]]
 bool assets_load_model(const assets_t *assets, SDL_GPUDevice *device,
-	const char *name, model_t *model);
+	vertex_format_t vertex_format, const char *name, model_t *model);
+
+/**
+ * Read and parse a model on a worker thread,
+ * then upload it to the GPU on the thread polling the loader
+ */
+[[nodiscard]]
+bool assets_load_model_async(asset_loader_t *loader, SDL_GPUDevice *device,
+	vertex_format_t vertex_format, const char *name, model_loaded_t callback, void *userdata);
+
+/**
+ * Key of a model in the asset cache
+ */
+[[nodiscard]]
+Uint32 assets_model_key(const char *name);
 
 [[nodiscard]]
 SDL_IOStream *assets_load_script(const assets_t *assets, const char *name);
+
+[[nodiscard]]
+bool assets_view_script(const assets_t *assets, const char *name, asset_view_t *view);
@@ -32,6 +32,7 @@ typedef SDL_FColor clear_color_t;
 typedef matrix4x4_t view_projection_t;
 typedef Sint32 py_vm_index_t;
 typedef matrix4x4_t world_transform_t;
+typedef float lod_size_t;
 
 #define ecs_values_end (ecs_value_t){0,nullptr}
 #define ecs_ids_end (ecs_id_t)0
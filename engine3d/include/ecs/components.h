@@ -21,6 +21,7 @@ extern ecs_id_t EcsRotation;
 extern ecs_id_t EcsPosition;
 extern ecs_id_t EcsScale;
 extern ecs_id_t EcsProjection;
+extern ecs_id_t EcsLodSize;
 extern ecs_id_t EcsNkContext;
 extern ecs_id_t EcsVertexShader;
 extern ecs_id_t EcsFragmentShader;
@@ -31,3 +32,5 @@ extern ecs_id_t EcsScriptEngine;
 extern ecs_id_t EcsArgs;
 extern ecs_id_t EcsModelInstance;
 extern ecs_id_t EcsModelScene;
+extern ecs_id_t EcsAssetLoader;
+extern ecs_id_t EcsAssetCache;
@@ -5,3 +5,4 @@
 typedef Uint64 ecs_id_t;
 
 extern ecs_id_t EcsScene;
+extern ecs_id_t EcsModelLoading;
@@ -3,6 +3,7 @@
 #include "chirp/assets.h"
 #include "chirp/matrix.h"
 #include "chirp/modelinfo.h"
+#include "chirp/vertexformat.h"
 
 #include <SDL3/SDL_gpu.h>
 #include <SDL3/SDL_iostream.h>
@@ -18,20 +19,52 @@ typedef struct model
 
 	model_info_t info;
 
+	// Layout of the vertex buffers, has to match the pipeline
+	vertex_format_t vertex_format;
+
+	// One array for each mesh, with buffers for each of its primitives
 	primitive_buffers_t **buffers;
 
+	// Index ranges of visible clusters while drawing, room for the primitive with the most clusters
+	mesh_lod_t *visible_ranges;
+
+	// Projected size of each node when drawn as a scene, instances keep their own
+	float *lod_sizes;
+
 	SDL_GPUSampler *sampler;
 	SDL_GPUTexture *texture;
 } model_t;
 
-bool model_create(SDL_GPUDevice *device, const assets_t *assets,
-	SDL_IOStream *stream, bool close_io, model_t *model);
+bool model_create(SDL_GPUDevice *device, vertex_format_t vertex_format,
+	const assets_t *assets, SDL_IOStream *stream, bool close_io, model_t *model);
+
+bool model_create_mem(SDL_GPUDevice *device, vertex_format_t vertex_format,
+	const assets_t *assets, const void *data, size_t size, model_t *model);
+
+/**
+ * Upload a model with info already loaded, destroys the model on failure,
+ * each vertex buffer has the vertices followed by the colour of the primitive
+ */
+bool model_upload(SDL_GPUDevice *device, vertex_format_t vertex_format, model_t *model);
 
 void model_destroy(model_t *model);
 
+/**
+ * Approximate memory used by the model, mostly GPU buffers
+ */
+[[nodiscard]]
+size_t model_size(const model_t *model);
+
+/**
+ * Draw all nodes, picking levels of detail using the sizes kept in the model,
+ * so a model should only be drawn once per frame like this
+ */
 void model_draw(const model_t *model, SDL_GPURenderPass *render_pass,
 	SDL_GPUCommandBuffer *command_buffer, matrix4x4_t view_projection);
 
+/**
+ * @param lod_size Projected size used to pick the level of detail last frame, updated when it changes enough
+ */
 void model_draw_indexed(const model_t *model, size_t index,
 	SDL_GPURenderPass *render_pass, SDL_GPUCommandBuffer *command_buffer,
-	matrix4x4_t projection);
+	matrix4x4_t projection, float *lod_size);
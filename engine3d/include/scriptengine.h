@@ -2,8 +2,12 @@
 
 #include <SDL3/SDL_iostream.h>
 
+#include <stddef.h>
+
 int script_engine_create();
 
 bool script_engine_exec(const char *filename, SDL_IOStream *stream, bool close_io);
 
+bool script_engine_exec_mem(const char *filename, const void *data, size_t size);
+
 void script_engine_destroy();
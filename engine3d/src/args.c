@@ -93,6 +93,38 @@ static void print_help()
 			.command = task_threads,
 			.description = "Set number of task threads to use",
 		},
+		(arg_command_t){
+			.command = "--asset-cache-size [MiB]",
+			.description = "Set memory budget for cached assets",
+		},
+		(arg_command_t){
+			.command = "--(no-)asset-map",
+			.description = "Memory map asset archives",
+		},
+		(arg_command_t){
+			.command = "--asset-block-size [KiB]",
+			.description = "Set block size of unmapped asset reads",
+		},
+		(arg_command_t){
+			.command = "--asset-block-count [count]",
+			.description = "Set number of cached blocks of unmapped assets",
+		},
+		(arg_command_t){
+			.command = "--asset-trace [file]",
+			.description = "Record order of loaded assets",
+		},
+		(arg_command_t){
+			.command = "--asset-readahead [file]",
+			.description = "Prefetch assets in a recorded order",
+		},
+		(arg_command_t){
+			.command = "--(no-)asset-disk-cache",
+			.description = "Keep decoded assets between launches",
+		},
+		(arg_command_t){
+			.command = "--(no-)quantize-vertices",
+			.description = "Use compact vertices for models",
+		},
 	};
 
 	log_func(nullptr, SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
@@ -152,6 +184,7 @@ bool args_parse(const int argc, char **argv, args_t *args)
 		.video_driver = nullptr,
 		.threads = 0,
 		.task_threads = 0,
+		.asset_cache_size = 256,
 	};
 
 	for (int i = 1; i < argc; i++)
@@ -255,6 +288,56 @@ bool args_parse(const int argc, char **argv, args_t *args)
 			args->task_threads = SDL_atoi(argv[++i]);
 		}
 
+		else if (SDL_strcmp(arg, "--asset-cache-size") == 0 && i + 1 < argc)
+		{
+			args->asset_cache_size = SDL_max(SDL_atoi(argv[++i]), 0);
+		}
+
+		else if (SDL_strcmp(arg, "--asset-map") == 0)
+		{
+			args->asset_map = OPT_ENABLE;
+		}
+		else if (SDL_strcmp(arg, "--no-asset-map") == 0)
+		{
+			args->asset_map = OPT_DISABLE;
+		}
+
+		else if (SDL_strcmp(arg, "--asset-block-size") == 0 && i + 1 < argc)
+		{
+			args->asset_block_size = argv[++i];
+		}
+		else if (SDL_strcmp(arg, "--asset-block-count") == 0 && i + 1 < argc)
+		{
+			args->asset_block_count = argv[++i];
+		}
+
+		else if (SDL_strcmp(arg, "--asset-trace") == 0 && i + 1 < argc)
+		{
+			args->asset_trace = argv[++i];
+		}
+		else if (SDL_strcmp(arg, "--asset-readahead") == 0 && i + 1 < argc)
+		{
+			args->asset_readahead = argv[++i];
+		}
+
+		else if (SDL_strcmp(arg, "--asset-disk-cache") == 0)
+		{
+			args->asset_disk_cache = OPT_ENABLE;
+		}
+		else if (SDL_strcmp(arg, "--no-asset-disk-cache") == 0)
+		{
+			args->asset_disk_cache = OPT_DISABLE;
+		}
+
+		else if (SDL_strcmp(arg, "--quantize-vertices") == 0)
+		{
+			args->quantize_vertices = OPT_ENABLE;
+		}
+		else if (SDL_strcmp(arg, "--no-quantize-vertices") == 0)
+		{
+			args->quantize_vertices = OPT_DISABLE;
+		}
+
 		else
 		{
 			SDL_LogError(LOG_CATEGORY_CORE, "Unknown arg: '%s'", arg);
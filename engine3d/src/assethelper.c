@@ -1,13 +1,131 @@
 #include "assethelper.h"
 #include "model.h"
 
+#include "chirp/assetloader.h"
 #include "chirp/assets.h"
+#include "chirp/diskcache.h"
 #include "chirp/image.h"
+#include "chirp/logcategory.h"
+#include "chirp/modelcooked.h"
+#include "chirp/modeldeps.h"
+#include "chirp/modelinfo.h"
+#include "chirp/vertexformat.h"
 
+#include <SDL3/SDL_error.h>
 #include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_pixels.h>
 #include <SDL3/SDL_stdinc.h>
 #include <SDL3/SDL_surface.h>
 
+typedef struct model_request
+{
+	char *name;
+	SDL_GPUDevice *device;
+	vertex_format_t vertex_format;
+	model_t model;
+	model_loaded_t callback;
+	void *userdata;
+} model_request_t;
+
+/**
+ * Decoded textures in the disk cache, followed by tightly packed pixels
+ */
+typedef struct cached_texture
+{
+	Uint32 width;
+	Uint32 height;
+} cached_texture_t;
+
+static constexpr size_t cached_texture_bpp = 4;
+
+[[nodiscard]]
+static SDL_Surface *load_cached_texture(const assets_t *assets, const char *path, const Uint32 signature)
+{
+	disk_cache_entry_t entry;
+	if (!disk_cache_open(assets->disk_cache, path, signature, &entry))
+	{
+		return nullptr;
+	}
+
+	cached_texture_t header = {};
+	if (entry.size >= sizeof(cached_texture_t))
+	{
+		SDL_memcpy(&header, entry.data, sizeof(cached_texture_t));
+	}
+
+	const size_t pitch = (size_t) header.width * cached_texture_bpp;
+
+	SDL_Surface *surface = entry.size == sizeof(cached_texture_t) + (pitch * header.height)
+		? SDL_CreateSurface((int) header.width, (int) header.height, SDL_PIXELFORMAT_RGBA32)
+		: nullptr;
+
+	if (surface != nullptr)
+	{
+		const Uint8 *pixels = entry.data + sizeof(cached_texture_t);
+
+		for (Uint32 y = 0; y < header.height; y++)
+		{
+			SDL_memcpy((Uint8*) surface->pixels + ((size_t) surface->pitch * y), pixels + (pitch * y), pitch);
+		}
+	}
+
+	disk_cache_close(&entry);
+	return surface;
+}
+
+static void store_cached_texture(const assets_t *assets, const char *path,
+	const Uint32 signature, const SDL_Surface *surface)
+{
+	const cached_texture_t header = {
+		.width = (Uint32) surface->w,
+		.height = (Uint32) surface->h,
+	};
+
+	const size_t pitch = (size_t) header.width * cached_texture_bpp;
+	const size_t size = sizeof(cached_texture_t) + (pitch * header.height);
+
+	Uint8 *data = surface->format == SDL_PIXELFORMAT_RGBA32 ? SDL_malloc(size) : nullptr;
+	if (data == nullptr)
+	{
+		return;
+	}
+
+	SDL_memcpy(data, &header, sizeof(cached_texture_t));
+
+	for (Uint32 y = 0; y < header.height; y++)
+	{
+		SDL_memcpy(data + sizeof(cached_texture_t) + (pitch * y),
+			(const Uint8*) surface->pixels + ((size_t) surface->pitch * y), pitch);
+	}
+
+	// Only slower next launch
+	if (!disk_cache_store(assets->disk_cache, path, signature, data, size))
+	{
+		SDL_LogWarn(LOG_CATEGORY_ASSETS, "Failed to cache %s: %s", path, SDL_GetError());
+	}
+
+	SDL_free(data);
+}
+
+[[nodiscard]]
+static SDL_Surface *decode_texture(const assets_t *assets, const char *path)
+{
+	asset_view_t view;
+	if (assets_view(assets, path, &view))
+	{
+		return load_qoi_mem(view.data, view.size);
+	}
+
+	SDL_IOStream *stream = assets_load(assets, path);
+	if (stream == nullptr)
+	{
+		return nullptr;
+	}
+
+	return load_qoi(stream, true);
+}
+
 SDL_Surface *assets_load_texture(const assets_t *assets, const char *name)
 {
 	char *path = nullptr;
@@ -16,18 +134,120 @@ SDL_Surface *assets_load_texture(const assets_t *assets, const char *name)
 		return nullptr;
 	}
 
-	SDL_IOStream *stream = assets_load(assets, path);
+	// Archives without content hashes can't tell if a cached texture is outdated
+	Uint32 signature = 0;
+	const bool cacheable = assets->disk_cache != nullptr
+		&& assets_content_hash(assets, path, &signature);
+
+	SDL_Surface *surface = cacheable
+		? load_cached_texture(assets, path, signature)
+		: nullptr;
+
+	if (surface == nullptr)
+	{
+		surface = decode_texture(assets, path);
+
+		if (surface != nullptr && cacheable)
+		{
+			store_cached_texture(assets, path, signature, surface);
+		}
+	}
+
 	SDL_free(path);
+	return surface;
+}
+
+[[nodiscard]]
+static Uint32 asset_key(const char *type, const char *name)
+{
+	char *path = nullptr;
+	if (SDL_asprintf(&path, "%s/%s", type, name) < 0)
+	{
+		return 0;
+	}
+
+	const Uint32 key = assets_hash(path);
+	SDL_free(path);
+
+	return key;
+}
+
+/**
+ * Signature of a model in the disk cache, from every file it's loaded from,
+ * and the settings used when parsing it
+ */
+[[nodiscard]]
+static bool model_signature(const assets_t *assets, const char *name, Uint32 *signature)
+{
+	model_deps_t deps;
+	if (!model_deps_load(assets, name, &deps))
+	{
+		return false;
+	}
+
+	const bool result = model_deps_signature(assets, &deps, signature);
+	model_deps_destroy(&deps);
+
+	if (!result)
+	{
+		return false;
+	}
+
+	// Levels of detail are generated when parsing
+	float lod_ratios[mesh_max_lods];
+	const size_t lod_ratio_count = model_info_lod_ratios(lod_ratios);
+	*signature = SDL_murmur3_32(lod_ratios, sizeof(float) * lod_ratio_count, *signature);
+
+	return true;
+}
+
+[[nodiscard]]
+static bool load_cached_model_info(const assets_t *assets, const char *path,
+	const Uint32 signature, model_info_t *info)
+{
+	disk_cache_entry_t entry;
+	if (!disk_cache_open(assets->disk_cache, path, signature, &entry))
+	{
+		return false;
+	}
+
+	const bool result = model_info_create_cooked_mem(assets, entry.data, entry.size, info);
+	disk_cache_close(&entry);
 
+	return result;
+}
+
+static void store_cached_model_info(const assets_t *assets, const char *path,
+	const Uint32 signature, const model_info_t *info)
+{
+	SDL_IOStream *stream = SDL_IOFromDynamicMem();
 	if (stream == nullptr)
 	{
-		return nullptr;
+		return;
 	}
 
-	return load_qoi(stream, true);
+	const void *data = nullptr;
+	if (model_cooked_write_all(info, stream))
+	{
+		data = SDL_GetPointerProperty(SDL_GetIOProperties(stream),
+			SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, nullptr);
+	}
+
+	// Only slower next launch
+	if (data == nullptr
+		|| !disk_cache_store(assets->disk_cache, path, signature, data, (size_t) SDL_GetIOSize(stream)))
+	{
+		SDL_LogWarn(LOG_CATEGORY_ASSETS, "Failed to cache %s: %s", path, SDL_GetError());
+	}
+
+	SDL_CloseIO(stream);
 }
 
-bool assets_load_model(const assets_t *assets, SDL_GPUDevice *device, const char *name, model_t *model)
+/**
+ * Parsed models are kept in the disk cache, until any of their dependencies change
+ */
+[[nodiscard]]
+static bool load_preloaded_model_info(const assets_t *assets, const char *name, model_info_t *info)
 {
 	char *path = nullptr;
 	if (SDL_asprintf(&path, "models/%s", name) < 0)
@@ -35,6 +255,55 @@ bool assets_load_model(const assets_t *assets, SDL_GPUDevice *device, const char
 		return false;
 	}
 
+	Uint32 signature = 0;
+	const bool cacheable = assets->disk_cache != nullptr
+		&& model_signature(assets, name, &signature);
+
+	if (cacheable && load_cached_model_info(assets, path, signature, info))
+	{
+		SDL_free(path);
+		return true;
+	}
+
+	const bool result = model_info_create_preloaded(assets, name, info);
+
+	if (result && cacheable)
+	{
+		store_cached_model_info(assets, path, signature, info);
+	}
+
+	SDL_free(path);
+	return result;
+}
+
+[[nodiscard]]
+static bool load_model_info(const assets_t *assets, const char *name, model_info_t *info)
+{
+	// Cooked by chirp-pack, so no glTF needs to be parsed
+	if (model_cooked_exists(assets, name))
+	{
+		return model_info_create_cooked(assets, name, info);
+	}
+
+	// Dependencies are known up front, so everything is read at once
+	if (model_deps_exists(assets, name))
+	{
+		return load_preloaded_model_info(assets, name, info);
+	}
+
+	char *path = nullptr;
+	if (SDL_asprintf(&path, "models/%s", name) < 0)
+	{
+		return false;
+	}
+
+	asset_view_t view;
+	if (assets_view(assets, path, &view))
+	{
+		SDL_free(path);
+		return model_info_create_mem(assets, view.data, view.size, info);
+	}
+
 	SDL_IOStream *stream = assets_load(assets, path);
 	SDL_free(path);
 
@@ -43,7 +312,67 @@ bool assets_load_model(const assets_t *assets, SDL_GPUDevice *device, const char
 		return false;
 	}
 
-	return model_create(device, assets, stream, true, model);
+	return model_info_create(assets, stream, true, info);
+}
+
+bool assets_load_model(const assets_t *assets, SDL_GPUDevice *device,
+	const vertex_format_t vertex_format, const char *name, model_t *model)
+{
+	if (!load_model_info(assets, name, &model->info))
+	{
+		return false;
+	}
+
+	return model_upload(device, vertex_format, model);
+}
+
+static bool load_model_job(const assets_t *assets, void *userdata)
+{
+	model_request_t *request = userdata;
+	return load_model_info(assets, request->name, &request->model.info);
+}
+
+static void on_model_loaded(const bool success, void *userdata)
+{
+	model_request_t *request = userdata;
+
+	// GPU resources are only created from the polling thread
+	const bool uploaded = success && model_upload(request->device, request->vertex_format, &request->model);
+	request->callback(request->name, uploaded ? &request->model : nullptr, request->userdata);
+
+	SDL_free(request->name);
+	SDL_free(request);
+}
+
+bool assets_load_model_async(asset_loader_t *loader, SDL_GPUDevice *device,
+	const vertex_format_t vertex_format, const char *name, const model_loaded_t callback, void *userdata)
+{
+	model_request_t *request = SDL_calloc(1, sizeof(model_request_t));
+	if (request == nullptr)
+	{
+		return false;
+	}
+
+	request->name = SDL_strdup(name);
+	request->device = device;
+	request->vertex_format = vertex_format;
+	request->callback = callback;
+	request->userdata = userdata;
+
+	if (request->name == nullptr
+		|| !asset_loader_submit(loader, load_model_job, on_model_loaded, request))
+	{
+		SDL_free(request->name);
+		SDL_free(request);
+		return false;
+	}
+
+	return true;
+}
+
+Uint32 assets_model_key(const char *name)
+{
+	return asset_key("models", name);
 }
 
 SDL_IOStream *assets_load_script(const assets_t *assets, const char *name)
@@ -59,3 +388,17 @@ SDL_IOStream *assets_load_script(const assets_t *assets, const char *name)
 
 	return stream;
 }
+
+bool assets_view_script(const assets_t *assets, const char *name, asset_view_t *view)
+{
+	char *path = nullptr;
+	if (SDL_asprintf(&path, "scripts/%s", name) < 0)
+	{
+		return false;
+	}
+
+	const bool result = assets_view(assets, path, view);
+	SDL_free(path);
+
+	return result;
+}
@@ -10,6 +10,8 @@
 #include "ecs/events.h"
 #include "ecs/tags.h"
 
+#include "chirp/assetcache.h"
+#include "chirp/assetloader.h"
 #include "chirp/ecs.h"
 #include "flecs.h"
 #include "box3d/id.h"
@@ -114,6 +116,7 @@ static void add_modules()
 		EcsInstanceOf = entity("InstanceOf");
 
 		EcsScene = tag("Scene");
+		EcsModelLoading = tag("ModelLoading");
 
 		EcsTimeStats = component("TimeStats", time_stats_t);
 		EcsWindowConfig = component("WindowConfig", window_config_t);
@@ -132,6 +135,7 @@ static void add_modules()
 		EcsPosition = component("Position", position_t);
 		EcsScale = component("Scale", scale_t);
 		EcsProjection = component("Projection", projection_t);
+		EcsLodSize = component("LodSize", lod_size_t);
 		EcsNkContext = component("NkContext", nkui_context_t);
 		EcsVertexShader = component("VertexShader", vertex_shader_t*);
 		EcsFragmentShader = component("FragmentShader", fragment_shader_t*);
@@ -142,6 +146,8 @@ static void add_modules()
 		EcsArgs = component("Args", args_t);
 		EcsModelInstance = component("ModelInstance", model_instance_t);
 		EcsModelScene = component("ModelScene", model_scene_t);
+		EcsAssetLoader = component("AssetLoader", asset_loader_t*);
+		EcsAssetCache = component("AssetCache", asset_cache_t*);
 
 #ifndef NDEBUG
 
@@ -202,6 +208,10 @@ static void add_modules()
 			(ecs_member_t){.name = "value", .type = ecs_id(ecs_f32_t), .count = 16},
 		);
 
+		reflect(EcsLodSize,
+			(ecs_member_t){.name = "value", .type = ecs_id(ecs_f32_t)},
+		);
+
 		reflect(EcsWorldTransform,
 			(ecs_member_t){.name = "value", .type = ecs_id(ecs_f32_t), .count = 16},
 		);
@@ -17,6 +17,7 @@ ecs_id_t EcsRotation = 0;
 ecs_id_t EcsPosition = 0;
 ecs_id_t EcsScale = 0;
 ecs_id_t EcsProjection = 0;
+ecs_id_t EcsLodSize = 0;
 ecs_id_t EcsNkContext = 0;
 ecs_id_t EcsVertexShader = 0;
 ecs_id_t EcsFragmentShader = 0;
@@ -27,3 +28,5 @@ ecs_id_t EcsScriptEngine = 0;
 ecs_id_t EcsArgs = 0;
 ecs_id_t EcsModelInstance = 0;
 ecs_id_t EcsModelScene = 0;
+ecs_id_t EcsAssetLoader = 0;
+ecs_id_t EcsAssetCache = 0;
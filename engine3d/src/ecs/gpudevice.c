@@ -9,6 +9,9 @@
 #include "flecs.h"
 #include "chirp/ecs.h"
 #include "chirp/logcategory.h"
+#include "chirp/modelinfo.h"
+#include "chirp/vector.h"
+#include "chirp/vertexformat.h"
 
 #include <SDL3/SDL_gpu.h>
 #include <SDL3/SDL_log.h>
@@ -211,6 +214,70 @@ static void create_default_pipeline(ecs_iter_t *iter)
 	SDL_GPUDevice *device = *ecs_field(iter, gpu_device_t*, 1);
 	SDL_GPUShader *vertex_shader = *ecs_field(iter, vertex_shader_t*, 2);
 	SDL_GPUShader *fragment_shader = *ecs_field(iter, fragment_shader_t*, 3);
+	const args_t *args = ecs_field(iter, args_t, 4);
+
+	const vertex_format_t vertex_format = args->quantize_vertices == OPT_DISABLE
+		? VERTEX_FORMAT_FLOAT
+		: VERTEX_FORMAT_QUANTIZED;
+
+	const SDL_GPUVertexAttribute float_attributes[] = {
+		// Position
+		(SDL_GPUVertexAttribute){
+			.location = 0,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
+			.offset = offsetof(primitive_vertex_t, position),
+		},
+		// Normal
+		(SDL_GPUVertexAttribute){
+			.location = 1,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
+			.offset = offsetof(primitive_vertex_t, normal),
+		},
+		// Texture coordinate
+		(SDL_GPUVertexAttribute){
+			.location = 2,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2,
+			.offset = offsetof(primitive_vertex_t, tex_coord),
+		},
+		// Colour
+		(SDL_GPUVertexAttribute){
+			.location = 3,
+			.buffer_slot = 1,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4,
+			.offset = 0,
+		},
+	};
+
+	// Dequantized by the vertex fetch and mvp, so the shader is the same
+	const SDL_GPUVertexAttribute quantized_attributes[] = {
+		// Position
+		(SDL_GPUVertexAttribute){
+			.location = 0,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_SHORT4_NORM,
+			.offset = offsetof(quantized_vertex_t, position),
+		},
+		// Normal
+		(SDL_GPUVertexAttribute){
+			.location = 1,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_SHORT4_NORM,
+			.offset = offsetof(quantized_vertex_t, normal),
+		},
+		// Texture coordinate
+		(SDL_GPUVertexAttribute){
+			.location = 2,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_HALF2,
+			.offset = offsetof(quantized_vertex_t, tex_coord),
+		},
+		// Colour
+		(SDL_GPUVertexAttribute){
+			.location = 3,
+			.buffer_slot = 1,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4,
+			.offset = 0,
+		},
+	};
+
+	static_assert(SDL_arraysize(float_attributes) == SDL_arraysize(quantized_attributes));
 
 	const SDL_GPUGraphicsPipelineCreateInfo create_info = {
 		.target_info = (SDL_GPUGraphicsPipelineTargetInfo){
@@ -238,41 +305,24 @@ static void create_default_pipeline(ecs_iter_t *iter)
 			.compare_op = SDL_GPU_COMPAREOP_LESS_OR_EQUAL,
 		},
 		.vertex_input_state = (SDL_GPUVertexInputState){
-			.num_vertex_buffers = 1,
+			.num_vertex_buffers = 2,
 			.vertex_buffer_descriptions = (SDL_GPUVertexBufferDescription[]){
 				(SDL_GPUVertexBufferDescription){
 					.slot = 0,
-					.pitch = sizeof(vertex_t),
+					.pitch = vertex_format_size(vertex_format),
 					.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
 				},
-			},
-			.num_vertex_attributes = 4,
-			.vertex_attributes = (SDL_GPUVertexAttribute[]){
-				// Position
-				(SDL_GPUVertexAttribute){
-					.location = 0,
-					.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
-					.offset = offsetof(vertex_t, position),
-				},
-				// Normal
-				(SDL_GPUVertexAttribute){
-					.location = 1,
-					.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
-					.offset = offsetof(vertex_t, normal),
-				},
-				// Texture coordinate
-				(SDL_GPUVertexAttribute){
-					.location = 2,
-					.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2,
-					.offset = offsetof(vertex_t, tex_coord),
-				},
-				// Colour
-				(SDL_GPUVertexAttribute){
-					.location = 3,
-					.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4,
-					.offset = offsetof(vertex_t, color),
+				// Colour of the primitive, the same for all vertices
+				(SDL_GPUVertexBufferDescription){
+					.slot = 1,
+					.pitch = sizeof(vector4f_t),
+					.input_rate = SDL_GPU_VERTEXINPUTRATE_INSTANCE,
 				},
 			},
+			.num_vertex_attributes = SDL_arraysize(float_attributes),
+			.vertex_attributes = vertex_format == VERTEX_FORMAT_QUANTIZED
+				? quantized_attributes
+				: float_attributes,
 		},
 		.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
 		.rasterizer_state = (SDL_GPURasterizerState){
@@ -362,6 +412,7 @@ void ecs_add_gpu()
 				(ecs_term_t){.id = ecs_singleton_id(EcsGpuDevice), .inout = EcsIn},
 				(ecs_term_t){.id = EcsVertexShader, .inout = EcsIn},
 				(ecs_term_t){.id = EcsFragmentShader, .inout = EcsIn},
+				(ecs_term_t){.id = ecs_singleton_id(EcsArgs), .inout = EcsIn},
 			},
 			.events = {EcsOnSet},
 			.callback = create_default_pipeline,
@@ -1,3 +1,4 @@
+#include "args.h"
 #include "assethelper.h"
 #include "ecs.h"
 #include "model.h"
@@ -6,16 +7,21 @@
 #include "ecs/tags.h"
 
 #include "flecs.h"
+#include "chirp/assetcache.h"
+#include "chirp/assetloader.h"
 #include "chirp/assets.h"
 #include "chirp/ecs.h"
 #include "chirp/logcategory.h"
 #include "chirp/modelinfo.h"
+#include "chirp/vertexformat.h"
 #include "chirp/ecs/components.h"
 #include "flecs/addons/system.h"
 
 #include <SDL3/SDL_assert.h>
 #include <SDL3/SDL_error.h>
+#include <SDL3/SDL_filesystem.h>
 #include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_init.h>
 #include <SDL3/SDL_log.h>
 #include <SDL3/SDL_stdinc.h>
 
@@ -44,38 +50,15 @@ static Uint16 fix_entity_name(const char *name)
 	return changes;
 }
 
-static ecs_entity_t load_model(const char *name)
+static void add_model_nodes(const ecs_entity_t entity, const model_t *model, const char *name)
 {
-	SDL_LogInfo(LOG_CATEGORY_ECS, "Loading model: '%s'", name);
-
-	const assets_t *assets = ecs_get_id(ecs_world(), ecs_singleton(EcsAssets));
-
-	SDL_GPUDevice *gpu_device = *((SDL_GPUDevice**) ecs_get_mut_id(ecs_world(),
-		ecs_singleton(EcsGpuDevice)));
-
-	model_t model;
-	if (!assets_load_model(assets, gpu_device, name, &model))
+	for (size_t i = 0; i < model->info.node_count; i++)
 	{
-		SDL_LogError(LOG_CATEGORY_MODEL, "Failed to load model '%s': %s",
-			name, SDL_GetError());
-		return 0;
-	}
-
-	const ecs_entity_t entity = ecs_entity_init(ecs_world(), &(ecs_entity_desc_t){
-		.name = name,
-	});
-	ecs_add_pair(ecs_world(), entity, EcsChildOf, models_entity());
-
-	ecs_set_id(ecs_world(), entity, EcsModel,
-		sizeof(model_t), &model);
-
-	for (size_t i = 0; i < model.info.node_count; i++)
-	{
-		char *node_name = SDL_strdup(model_node_name(&model.info, i));
+		char *node_name = SDL_strdup(model_node_name(&model->info, i));
 		if (fix_entity_name(node_name) > 0)
 		{
 			SDL_LogWarn(LOG_CATEGORY_MODEL, "Renamed invalid entity name '%s' to '%s' in '%s'",
-				model_node_name(&model.info, i), node_name, name);
+				model_node_name(&model->info, i), node_name, name);
 		}
 		const ecs_entity_t node = ecs_entity_init(ecs_world(), &(ecs_entity_desc_t){
 			.name = node_name,
@@ -84,16 +67,126 @@ static ecs_entity_t load_model(const char *name)
 
 		ecs_add_pair(ecs_world(), node, EcsChildOf, entity);
 
-		const position_t position = model_node_translation(&model.info, i);
+		const position_t position = model_node_translation(&model->info, i);
 		ecs_set_id(ecs_world(), node, EcsPosition,
 			sizeof(position_t), &position);
 
-		const world_transform_t world_transform = model_node_world_transform(&model.info, i);
+		const world_transform_t world_transform = model_node_world_transform(&model->info, i);
 		ecs_set_id(ecs_world(), node, EcsWorldTransform,
 			sizeof(world_transform_t), &world_transform);
 	}
+}
+
+[[nodiscard]]
+static asset_cache_t *asset_cache()
+{
+	return *((asset_cache_t**) ecs_get_mut_id(ecs_world(),
+		ecs_singleton(EcsAssetCache)));
+}
+
+static void free_model(void *data)
+{
+	model_destroy(data);
+	SDL_free(data);
+}
+
+static void set_model(const ecs_entity_t entity, const model_t *model, const char *name)
+{
+	ecs_set_id(ecs_world(), entity, EcsModel,
+		sizeof(model_t), model);
+
+	add_model_nodes(entity, model, name);
+}
+
+static void on_model_loaded(const char *name, model_t *model, [[maybe_unused]] void *userdata)
+{
+	const ecs_entity_t entity = ecs_lookup_child(ecs_world(), models_entity(), name);
+	if (entity == 0)
+	{
+		// Placeholder was removed while loading
+		if (model != nullptr)
+		{
+			model_destroy(model);
+		}
+		return;
+	}
+
+	// Model is left without a model component to mark it as failed
+	ecs_remove_id(ecs_world(), entity, EcsModelLoading);
+
+	if (model == nullptr)
+	{
+		SDL_LogError(LOG_CATEGORY_MODEL, "Failed to load model '%s': %s",
+			name, SDL_GetError());
+		return;
+	}
+
+	model_t *data = SDL_malloc(sizeof(model_t));
+	if (data != nullptr)
+	{
+		*data = *model;
+	}
+
+	// Entity holds the first reference
+	const model_t *cached = data != nullptr
+		? asset_cache_insert(asset_cache(), assets_model_key(name),
+			data, model_size(model), free_model)
+		: nullptr;
+
+	if (cached == nullptr)
+	{
+		SDL_LogError(LOG_CATEGORY_MODEL, "Failed to cache model '%s': %s",
+			name, SDL_GetError());
+		SDL_free(data);
+		model_destroy(model);
+		return;
+	}
 
-	return entity;
+	set_model(entity, cached, name);
+}
+
+static bool load_model(const char *name)
+{
+	SDL_LogInfo(LOG_CATEGORY_ECS, "Loading model: '%s'", name);
+
+	asset_loader_t *loader = *((asset_loader_t**) ecs_get_mut_id(ecs_world(),
+		ecs_singleton(EcsAssetLoader)));
+
+	SDL_GPUDevice *gpu_device = *((SDL_GPUDevice**) ecs_get_mut_id(ecs_world(),
+		ecs_singleton(EcsGpuDevice)));
+
+	// Has to match the layout the pipeline was created with
+	const args_t *args = ecs_get_id(ecs_world(), ecs_singleton(EcsArgs));
+	const vertex_format_t vertex_format = args->quantize_vertices == OPT_DISABLE
+		? VERTEX_FORMAT_FLOAT
+		: VERTEX_FORMAT_QUANTIZED;
+
+	const ecs_entity_t entity = ecs_entity_init(ecs_world(), &(ecs_entity_desc_t){
+		.name = name,
+	});
+	ecs_add_pair(ecs_world(), entity, EcsChildOf, models_entity());
+
+	// Still cached from a previous use
+	const model_t *cached = asset_cache_acquire(asset_cache(), assets_model_key(name));
+	if (cached != nullptr)
+	{
+		SDL_LogDebug(LOG_CATEGORY_MODEL, "Using cached model '%s'", name);
+		set_model(entity, cached, name);
+		return true;
+	}
+
+	// Placeholder until loaded, so the same model is only loaded once
+	ecs_add_id(ecs_world(), entity, EcsModelLoading);
+
+	if (!assets_load_model_async(loader, gpu_device, vertex_format, name, on_model_loaded, nullptr))
+	{
+		SDL_LogError(LOG_CATEGORY_MODEL, "Failed to load model '%s': %s",
+			name, SDL_GetError());
+		ecs_delete(ecs_world(), entity);
+		return false;
+	}
+
+	return true;
 }
 
 static void create_instance(const ecs_entity_t entity, const ecs_entity_t model)
@@ -127,6 +220,10 @@ static void create_instance(const ecs_entity_t entity, const ecs_entity_t model)
 			ecs_set_id(ecs_world(), node, EcsProjection,
 				sizeof(projection_t), &projection);
 
+			const lod_size_t lod_size = 0.F;
+			ecs_set_id(ecs_world(), node, EcsLodSize,
+				sizeof(lod_size_t), &lod_size);
+
 			ecs_add_pair(ecs_world(), node, EcsInstanceOf, child);
 		}
 	}
@@ -149,7 +246,7 @@ static void instance_model(ecs_iter_t *iter)
 	const ecs_entity_t model = ecs_lookup_child(ecs_world(), models_entity(), name);
 	if (model == 0)
 	{
-		if (load_model(name) == 0)
+		if (!load_model(name))
 		{
 			// Don't try to load indefinitely
 			ecs_remove_id(ecs_world(), entity, EcsModelInstance);
@@ -158,6 +255,19 @@ static void instance_model(ecs_iter_t *iter)
 		return; // Deferred, I don't really like this, but it works
 	}
 
+	// Try again next frame
+	if (ecs_has_id(ecs_world(), model, EcsModelLoading))
+	{
+		return;
+	}
+
+	if (!ecs_has_id(ecs_world(), model, EcsModel))
+	{
+		ecs_remove_id(ecs_world(), entity, EcsModelInstance);
+		ecs_remove_id(ecs_world(), entity, EcsModelScene);
+		return;
+	}
+
 	if (ecs_has_id(ecs_world(), entity, EcsModelInstance))
 	{
 		create_instance(entity, model);
@@ -171,8 +281,201 @@ static void instance_model(ecs_iter_t *iter)
 	}
 }
 
+static void start_asset_trace(assets_t *assets, const args_t *args)
+{
+	// Neither is fatal, loading is only slower without readahead
+	if (args->asset_readahead != nullptr && !assets_readahead(assets, args->asset_readahead))
+	{
+		SDL_LogWarn(LOG_CATEGORY_ASSETS, "Failed to start readahead: %s", SDL_GetError());
+	}
+
+	if (args->asset_trace != nullptr && !assets_record_trace(assets, args->asset_trace))
+	{
+		SDL_LogWarn(LOG_CATEGORY_ASSETS, "Failed to record asset trace: %s", SDL_GetError());
+	}
+}
+
+static void use_asset_disk_cache(assets_t *assets, const args_t *args)
+{
+	if (args->asset_disk_cache != OPT_ENABLE)
+	{
+		return;
+	}
+
+	// Project metadata is set by the time assets are loaded
+	char *pref_path = SDL_GetPrefPath(
+		SDL_GetAppMetadataProperty(SDL_PROP_APP_METADATA_CREATOR_STRING),
+		SDL_GetAppMetadataProperty(SDL_PROP_APP_METADATA_NAME_STRING));
+
+	char *path = nullptr;
+	if (pref_path == nullptr || SDL_asprintf(&path, "%scache", pref_path) < 0)
+	{
+		SDL_LogWarn(LOG_CATEGORY_ASSETS, "Failed to get cache path: %s", SDL_GetError());
+		SDL_free(pref_path);
+		return;
+	}
+
+	// Entries from other engine versions are ignored, as decoded layouts may differ
+	if (!assets_use_disk_cache(assets, path, ENGINE_VERSION))
+	{
+		SDL_LogWarn(LOG_CATEGORY_ASSETS, "Failed to use disk cache: %s", SDL_GetError());
+	}
+
+	SDL_free(path);
+	SDL_free(pref_path);
+}
+
+static void create_asset_loader(ecs_iter_t *iter)
+{
+	assets_t *assets = ecs_field(iter, assets_t, 0);
+	const args_t *args = ecs_field(iter, args_t, 1);
+
+	// Before any loads, so every asset is traced and can be cached
+	start_asset_trace(assets, args);
+	use_asset_disk_cache(assets, args);
+
+	asset_cache_t *cache = asset_cache_create((size_t) args->asset_cache_size * 1024 * 1024);
+	if (cache == nullptr)
+	{
+		ecs_set_error("Assets error", SDL_GetError());
+		return;
+	}
+
+	asset_loader_t *loader = asset_loader_create(assets, 0);
+	if (loader == nullptr)
+	{
+		ecs_set_error("Assets error", SDL_GetError());
+		asset_cache_destroy(cache);
+		return;
+	}
+
+	// Models loaded by the workers decode their primitives on the other workers
+	model_info_set_thread_pool(asset_loader_thread_pool(loader), model_parallel_min_vertices);
+
+	ecs_set_id(ecs_world(), ecs_singleton(EcsAssetCache),
+		sizeof(asset_cache_t*), (const void*) &cache);
+
+	ecs_set_id(ecs_world(), ecs_singleton(EcsAssetLoader),
+		sizeof(asset_loader_t*), (const void*) &loader);
+}
+
+static void release_model(ecs_iter_t *iter)
+{
+	asset_cache_t *cache = asset_cache();
+
+	for (Sint32 i = 0; i < iter->count; i++)
+	{
+		const char *name = ecs_get_name(ecs_world(), iter->entities[i]);
+		asset_cache_release(cache, assets_model_key(name));
+	}
+}
+
+/**
+ * Model entities are only kept while used, so the cache can evict unused models,
+ * spawning the model again acquires it from the cache if it's still there
+ */
+static void delete_unused_model(const ecs_entity_t model, const Sint32 removed_instances)
+{
+	// Still loading, or already released when quitting
+	if (!ecs_has_id(ecs_world(), model, EcsModel))
+	{
+		return;
+	}
+
+	if (ecs_count_id(ecs_world(), ecs_pair(EcsInstanceOf, model)) > removed_instances)
+	{
+		return;
+	}
+
+	SDL_LogDebug(LOG_CATEGORY_ECS, "Deleting unused model '%s'",
+		ecs_get_name(ecs_world(), model));
+
+	ecs_delete(ecs_world(), model);
+}
+
+static void remove_instance(ecs_iter_t *iter)
+{
+	// Instances in the same table are instances of the same model
+	const ecs_entity_t model = ecs_pair_second(ecs_world(), ecs_field_id(iter, 0));
+
+	// Nodes are instances of model nodes, not models
+	if (model == 0 || ecs_get_parent(ecs_world(), model) != models_entity())
+	{
+		return;
+	}
+
+	if (!ecs_has_id(ecs_world(), model, EcsScene))
+	{
+		delete_unused_model(model, iter->count);
+	}
+}
+
+static void remove_scene(ecs_iter_t *iter)
+{
+	const ecs_entity_t models = models_entity();
+
+	for (Sint32 i = 0; i < iter->count; i++)
+	{
+		if (ecs_get_parent(ecs_world(), iter->entities[i]) == models)
+		{
+			delete_unused_model(iter->entities[i], 0);
+		}
+	}
+}
+
+static void poll_assets(ecs_iter_t *iter)
+{
+	asset_loader_t *loader = *ecs_field(iter, asset_loader_t*, 0);
+	asset_loader_poll(loader);
+}
+
 void ecs_add_models()
 {
+	ecs_observer_init(ecs_world(), &(ecs_observer_desc_t){
+		.query.terms = {
+			(ecs_term_t){.id = ecs_singleton_id(EcsAssets), .inout = EcsInOut},
+			(ecs_term_t){.id = ecs_singleton_id(EcsArgs), .inout = EcsIn},
+		},
+		.events = {EcsOnSet},
+		.callback = create_asset_loader,
+	});
+
+	// Models are owned by the cache, entities only hold a reference
+	ecs_observer_init(ecs_world(), &(ecs_observer_desc_t){
+		.query.terms = {
+			(ecs_term_t){.id = EcsModel, .inout = EcsInOutNone},
+		},
+		.events = {EcsOnRemove},
+		.callback = release_model,
+	});
+
+	ecs_observer_init(ecs_world(), &(ecs_observer_desc_t){
+		.query.terms = {
+			(ecs_term_t){.id = ecs_pair(EcsInstanceOf, EcsWildcard), .inout = EcsInOutNone},
+		},
+		.events = {EcsOnRemove},
+		.callback = remove_instance,
+	});
+
+	ecs_observer_init(ecs_world(), &(ecs_observer_desc_t){
+		.query.terms = {
+			(ecs_term_t){.id = EcsScene, .inout = EcsInOutNone},
+		},
+		.events = {EcsOnRemove},
+		.callback = remove_scene,
+	});
+
+	ecs_system_init(ecs_world(), &(ecs_system_desc_t){
+		.entity = ecs_entity_init(ecs_world(), &(ecs_entity_desc_t){
+			.name = "PollAssets",
+			.add = ecs_ids(ecs_dependson(ecs_phase(PHASE_RENDER_BEGIN))),
+		}),
+		.query.terms = {
+			(ecs_term_t){.id = ecs_singleton_id(EcsAssetLoader), .inout = EcsInOut},
+		},
+		.callback = poll_assets,
+	});
+
 	ecs_system_init(ecs_world(), &(ecs_system_desc_t){
 		.entity = ecs_entity_init(ecs_world(), &(ecs_entity_desc_t){
 			.name = "LoadModels",
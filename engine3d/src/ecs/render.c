@@ -162,6 +162,7 @@ static void render_model(ecs_iter_t *iter)
 	projection_t *projections = ecs_field(iter, projection_t, 3);
 	const world_transform_t *world_transform = ecs_field(iter, world_transform_t, 13);
 	const model_t *model = ecs_field(iter, model_t, 15);
+	lod_size_t *lod_sizes = ecs_field(iter, lod_size_t, 16);
 
 	for (Sint32 i = 0; i < iter->count; i++)
 	{
@@ -188,7 +189,7 @@ static void render_model(ecs_iter_t *iter)
 		}
 
 		model_draw_indexed(model, i, render_pass, command_buffer,
-			matrix4x4_multiply(projection->value, view_proj));
+			matrix4x4_multiply(projection->value, view_proj), lod_sizes + i);
 	}
 }
 
@@ -302,6 +303,7 @@ void ecs_add_render()
 			/* 13 */ (ecs_term_t){.id = EcsWorldTransform, .src.name = "$mdl_nod"},
 			/* 14 */ (ecs_term_t){.second.name = "$mdl", .first.id = EcsChildOf, .src.name = "$mdl_nod"},
 			/* 15 */ (ecs_term_t){.id = EcsModel, .src.name = "$mdl", .inout = EcsIn},
+			/* 16 */ (ecs_term_t){.id = EcsLodSize, .src.name = "$this", .inout = EcsInOut},
 		},
 		.callback = render_model,
 	});
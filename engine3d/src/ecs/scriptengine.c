@@ -25,6 +25,16 @@ static void load_main_script(ecs_iter_t *iter)
 {
 	const assets_t *assets = ecs_field(iter, assets_t, 0);
 
+	asset_view_t script_view;
+	if (assets_view_script(assets, "main", &script_view))
+	{
+		if (!script_engine_exec_mem("main", script_view.data, script_view.size))
+		{
+			SDL_LogError(LOG_CATEGORY_SCRIPT, "Exec error: %s", SDL_GetError());
+		}
+		return;
+	}
+
 	SDL_IOStream *script_stream = assets_load_script(assets, "main");
 	if (script_stream == nullptr)
 	{
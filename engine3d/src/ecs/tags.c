@@ -1,3 +1,4 @@
 #include "ecs/tags.h"
 
 ecs_id_t EcsScene = 0;
+ecs_id_t EcsModelLoading = 0;
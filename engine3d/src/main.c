@@ -20,10 +20,13 @@
 #include "box3d/id.h"
 #include "box3d/math_functions.h"
 #include "box3d/types.h"
+#include "chirp/assetcache.h"
+#include "chirp/assetloader.h"
 #include "chirp/assets.h"
 #include "chirp/ecs.h"
 #include "chirp/input.h"
 #include "chirp/logcategory.h"
+#include "chirp/modelinfo.h"
 #include "chirp/physics.h"
 #include "chirp/systeminfo.h"
 #include "chirp/vector.h"
@@ -307,6 +310,24 @@ SDL_AppResult SDL_AppInit(void **appstate, const int argc, char **argv)
 		SDL_LogError(LOG_CATEGORY_CORE, "Failed to set hint: %s", SDL_GetError());
 	}
 
+	if (args.asset_map != OPT_NOT_SET
+		&& !SDL_SetHint(ASSETS_HINT_MAP, arg_option_str(args.asset_map)))
+	{
+		SDL_LogError(LOG_CATEGORY_CORE, "Failed to set hint: %s", SDL_GetError());
+	}
+
+	if (args.asset_block_size != nullptr
+		&& !SDL_SetHint(ASSETS_HINT_BLOCK_SIZE, args.asset_block_size))
+	{
+		SDL_LogError(LOG_CATEGORY_CORE, "Failed to set hint: %s", SDL_GetError());
+	}
+
+	if (args.asset_block_count != nullptr
+		&& !SDL_SetHint(ASSETS_HINT_BLOCK_COUNT, args.asset_block_count))
+	{
+		SDL_LogError(LOG_CATEGORY_CORE, "Failed to set hint: %s", SDL_GetError());
+	}
+
 	if (args.allow_screensaver != OPT_NOT_SET
 		&& !SDL_SetHint(SDL_HINT_VIDEO_ALLOW_SCREENSAVER,
 			arg_option_str(args.allow_screensaver)))
@@ -741,21 +762,28 @@ void SDL_AppQuit(void *appstate, [[maybe_unused]] SDL_AppResult result)
 		return;
 	}
 
-	ecs_query_t *query = ecs_query_init(ecs_world(), &(ecs_query_desc_t){
-		.terms = {
-			(ecs_term_t){.id = EcsModel, .inout = EcsIn},
-		},
-	});
-	ecs_iter_t iter = ecs_query_iter(ecs_world(), query);
-	while (ecs_query_next(&iter))
+	// Finishes pending loads, so they're destroyed with the rest of the models
+	asset_loader_t *const *asset_loader = ecs_get_id(ecs_world(), ecs_singleton(EcsAssetLoader));
+	if (asset_loader != nullptr)
 	{
-		model_t *models = ecs_field(&iter, model_t, 0);
-		for (Sint32 i = 0; i < iter.count; i++)
-		{
-			model_destroy(models + i);
-		}
+		// Loads already running keep using the pool until it's destroyed
+		model_info_set_thread_pool(nullptr, model_parallel_min_vertices);
+		asset_loader_destroy(*asset_loader);
+		ecs_remove_id(ecs_world(), ecs_singleton(EcsAssetLoader), EcsAssetLoader);
+	}
+
+	// Models are owned by the cache
+	asset_cache_t *const *asset_cache = ecs_get_id(ecs_world(), ecs_singleton(EcsAssetCache));
+	if (asset_cache != nullptr)
+	{
+		ecs_remove_all(ecs_world(), EcsModel);
+
+		const asset_cache_stats_t stats = asset_cache_stats(*asset_cache);
+		SDL_LogDebug(LOG_CATEGORY_ASSETS, "Asset cache: %" SDL_PRIu64 " hits, %" SDL_PRIu64 " misses, %" SDL_PRIu64 " evictions",
+			stats.hits, stats.misses, stats.evictions);
+
+		asset_cache_destroy(*asset_cache);
 	}
-	ecs_query_fini(query);
 
 	assets_destroy(ecs_get_id(ecs_world(), ecs_singleton(EcsAssets)));
 	script_engine_destroy();
@@ -3,7 +3,11 @@
 
 #include "chirp/assets.h"
 #include "chirp/matrix.h"
+#include "chirp/meshlet.h"
+#include "chirp/meshlod.h"
 #include "chirp/modelinfo.h"
+#include "chirp/vector.h"
+#include "chirp/vertexformat.h"
 
 #include <SDL3/SDL_assert.h>
 #include <SDL3/SDL_gpu.h>
@@ -151,15 +155,95 @@ static bool upload_sampler(model_t *model)
 	return true;
 }
 
-static bool upload_mesh(SDL_GPUDevice *device, const mesh_primitive_t *primitive,
-	primitive_buffers_t *buffers)
+typedef struct mesh_layout
 {
-	const size_t vertex_size = sizeof(vertex_t) * primitive->vertex_count;
-	const size_t index_size = sizeof(primitive_index_t) * primitive->index_count;
+	size_t vertex_size;
+	size_t index_size;
+
+	// Offset of the colour in the transfer buffer, after the indices
+	size_t color_offset;
+	size_t transfer_size;
+} mesh_layout_t;
+
+[[nodiscard]]
+static mesh_layout_t mesh_layout(const vertex_format_t format, const mesh_primitive_t *primitive)
+{
+	const size_t vertex_size = vertex_format_size(format) * primitive->vertex_count;
+	const size_t index_size = primitive->index_size * mesh_primitive_stored_index_count(primitive);
+
+	// Some backends need copy offsets to be aligned
+	const size_t color_offset = (vertex_size + index_size + 15) & ~(size_t) 15;
+
+	return (mesh_layout_t){
+		.vertex_size = vertex_size,
+		.index_size = index_size,
+		.color_offset = color_offset,
+		.transfer_size = color_offset + sizeof(vector4f_t),
+	};
+}
+
+/**
+ * Cooked vertices are always floats, so they're converted through a temporary buffer
+ */
+[[nodiscard]]
+static bool copy_cooked_mesh(const assets_t *assets, const vertex_format_t format,
+	const mesh_primitive_t *primitive, Uint8 *transfer_data, const mesh_layout_t *layout)
+{
+	const size_t vertex_size = sizeof(primitive_vertex_t) * primitive->vertex_count;
+
+	Uint8 *data = SDL_malloc(vertex_size + layout->index_size);
+	if (data == nullptr)
+	{
+		return false;
+	}
+
+	if (!assets_read(assets, primitive->gpu_asset, data, vertex_size + layout->index_size))
+	{
+		SDL_free(data);
+		return false;
+	}
+
+	vertex_format_encode(format, primitive, (const primitive_vertex_t*) data, transfer_data);
+	SDL_memcpy(transfer_data + layout->vertex_size, data + vertex_size, layout->index_size);
+
+	SDL_free(data);
+	return true;
+}
+
+/**
+ * Fill the transfer buffer with vertices followed by indices, then the colour
+ */
+[[nodiscard]]
+static bool copy_mesh(const assets_t *assets, const vertex_format_t format,
+	const mesh_primitive_t *primitive, Uint8 *transfer_data, const mesh_layout_t *layout)
+{
+	SDL_memcpy(transfer_data + layout->color_offset, &primitive->color, sizeof(vector4f_t));
+
+	if (primitive->gpu_asset == nullptr)
+	{
+		vertex_format_encode(format, primitive, primitive->vertices, transfer_data);
+		SDL_memcpy(transfer_data + layout->vertex_size, primitive->indices, layout->index_size);
+		return true;
+	}
+
+	// Already in the right layout, so read straight from the archive
+	if (format == VERTEX_FORMAT_FLOAT)
+	{
+		return assets_read(assets, primitive->gpu_asset, transfer_data,
+			layout->vertex_size + layout->index_size);
+	}
+
+	return copy_cooked_mesh(assets, format, primitive, transfer_data, layout);
+}
+
+static bool upload_mesh(SDL_GPUDevice *device, const assets_t *assets, const vertex_format_t format,
+	const mesh_primitive_t *primitive, primitive_buffers_t *buffers)
+{
+	const mesh_layout_t layout = mesh_layout(format, primitive);
 
 	const SDL_GPUBufferCreateInfo vertex_buffer_info = {
 		.usage = SDL_GPU_BUFFERUSAGE_VERTEX,
-		.size = vertex_size,
+		.size = layout.vertex_size + sizeof(vector4f_t),
 	};
 	buffers->vertex = SDL_CreateGPUBuffer(device, &vertex_buffer_info);
 	if (buffers->vertex == nullptr)
@@ -169,7 +253,7 @@ static bool upload_mesh(SDL_GPUDevice *device, const mesh_primitive_t *primitive
 
 	const SDL_GPUBufferCreateInfo index_buffer_info = {
 		.usage = SDL_GPU_BUFFERUSAGE_INDEX,
-		.size = index_size,
+		.size = layout.index_size,
 	};
 	buffers->index = SDL_CreateGPUBuffer(device, &index_buffer_info);
 	if (buffers->index == nullptr)
@@ -181,7 +265,7 @@ static bool upload_mesh(SDL_GPUDevice *device, const mesh_primitive_t *primitive
 
 	const SDL_GPUTransferBufferCreateInfo transfer_info = {
 		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-		.size = vertex_size + index_size,
+		.size = layout.transfer_size,
 	};
 	SDL_GPUTransferBuffer *transfer_buffer = SDL_CreateGPUTransferBuffer(device, &transfer_info);
 	if (transfer_buffer == nullptr)
@@ -204,8 +288,16 @@ static bool upload_mesh(SDL_GPUDevice *device, const mesh_primitive_t *primitive
 		return false;
 	}
 
-	SDL_memcpy(transfer_data, primitive->vertices, vertex_size);
-	SDL_memcpy(transfer_data + vertex_size, primitive->indices, index_size);
+	if (!copy_mesh(assets, format, primitive, transfer_data, &layout))
+	{
+		SDL_UnmapGPUTransferBuffer(device, transfer_buffer);
+		SDL_ReleaseGPUBuffer(device, buffers->vertex);
+		SDL_ReleaseGPUBuffer(device, buffers->index);
+		SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+		buffers->vertex = nullptr;
+		buffers->index = nullptr;
+		return false;
+	}
 
 	SDL_UnmapGPUTransferBuffer(device, transfer_buffer);
 
@@ -229,18 +321,29 @@ static bool upload_mesh(SDL_GPUDevice *device, const mesh_primitive_t *primitive
 	const SDL_GPUBufferRegion vertex_destination = {
 		.buffer = buffers->vertex,
 		.offset = 0,
-		.size = vertex_size,
+		.size = layout.vertex_size,
 	};
 	SDL_UploadToGPUBuffer(copy_pass, &vertex_source, &vertex_destination, false);
 
+	const SDL_GPUTransferBufferLocation color_source = {
+		.transfer_buffer = transfer_buffer,
+		.offset = layout.color_offset,
+	};
+	const SDL_GPUBufferRegion color_destination = {
+		.buffer = buffers->vertex,
+		.offset = layout.vertex_size,
+		.size = sizeof(vector4f_t),
+	};
+	SDL_UploadToGPUBuffer(copy_pass, &color_source, &color_destination, false);
+
 	const SDL_GPUTransferBufferLocation index_source = {
 		.transfer_buffer = transfer_buffer,
-		.offset = vertex_size,
+		.offset = layout.vertex_size,
 	};
 	const SDL_GPUBufferRegion index_destination = {
 		.buffer = buffers->index,
 		.offset = 0,
-		.size = index_size,
+		.size = layout.index_size,
 	};
 	SDL_UploadToGPUBuffer(copy_pass, &index_source, &index_destination, false);
 
@@ -261,22 +364,43 @@ static bool upload_mesh(SDL_GPUDevice *device, const mesh_primitive_t *primitive
 
 static bool upload_model(model_t *model)
 {
-	model->buffers = SDL_calloc(model->info.node_count,
+	model->buffers = SDL_calloc(model->info.mesh_count,
 		sizeof(primitive_buffers_t*));
 
-	for (size_t nn = 0; nn < model->info.node_count; nn++)
+	// Primitives without clusters are drawn as a single range
+	size_t max_cluster_count = 1;
+
+	for (size_t mm = 0; mm < model->info.mesh_count; mm++)
+	{
+		const model_mesh_t *mesh = model->info.meshes + mm;
+
+		for (size_t pp = 0; pp < mesh->primitive_count; pp++)
+		{
+			max_cluster_count = SDL_max(max_cluster_count, mesh->primitives[pp].cluster_count);
+		}
+	}
+
+	model->visible_ranges = SDL_malloc(sizeof(mesh_lod_t) * max_cluster_count);
+	model->lod_sizes = SDL_calloc(SDL_max(model->info.node_count, 1), sizeof(float));
+
+	if (model->visible_ranges == nullptr || model->lod_sizes == nullptr)
 	{
-		const model_node_t *node = model->info.nodes + nn;
+		return false;
+	}
 
-		model->buffers[nn] = SDL_calloc(node->primitive_count,
+	for (size_t mm = 0; mm < model->info.mesh_count; mm++)
+	{
+		const model_mesh_t *mesh = model->info.meshes + mm;
+
+		model->buffers[mm] = SDL_calloc(mesh->primitive_count,
 			sizeof(primitive_buffers_t));
 
-		for (size_t pp = 0; pp < node->primitive_count; pp++)
+		for (size_t pp = 0; pp < mesh->primitive_count; pp++)
 		{
-			const mesh_primitive_t *primitive = node->primitives + pp;
-			primitive_buffers_t *buffers = model->buffers[nn] + pp;
+			const mesh_primitive_t *primitive = mesh->primitives + pp;
+			primitive_buffers_t *buffers = model->buffers[mm] + pp;
 
-			if (!upload_mesh(model->device, primitive, buffers))
+			if (!upload_mesh(model->device, model->info.assets, model->vertex_format, primitive, buffers))
 			{
 				return false;
 			}
@@ -286,15 +410,13 @@ static bool upload_model(model_t *model)
 	return true;
 }
 
-bool model_create(SDL_GPUDevice *device, const assets_t *assets,
-	SDL_IOStream *stream, const bool close_io, model_t *model)
+bool model_upload(SDL_GPUDevice *device, const vertex_format_t vertex_format, model_t *model)
 {
-	if (!model_info_create(assets, stream, close_io, &model->info))
-	{
-		return false;
-	}
-
 	model->device = device;
+	model->vertex_format = vertex_format;
+	model->buffers = nullptr;
+	model->visible_ranges = nullptr;
+	model->lod_sizes = nullptr;
 	model->sampler = nullptr;
 	model->texture = nullptr;
 
@@ -305,9 +427,34 @@ bool model_create(SDL_GPUDevice *device, const assets_t *assets,
 		return false;
 	}
 
+	// Only the GPU copy is used after this
+	model_info_free_vertices(&model->info);
+
 	return true;
 }
 
+bool model_create(SDL_GPUDevice *device, const vertex_format_t vertex_format,
+	const assets_t *assets, SDL_IOStream *stream, const bool close_io, model_t *model)
+{
+	if (!model_info_create(assets, stream, close_io, &model->info))
+	{
+		return false;
+	}
+
+	return model_upload(device, vertex_format, model);
+}
+
+bool model_create_mem(SDL_GPUDevice *device, const vertex_format_t vertex_format,
+	const assets_t *assets, const void *data, const size_t size, model_t *model)
+{
+	if (!model_info_create_mem(assets, data, size, &model->info))
+	{
+		return false;
+	}
+
+	return model_upload(device, vertex_format, model);
+}
+
 void model_destroy(model_t *model)
 {
 	if (model == nullptr)
@@ -318,36 +465,84 @@ void model_destroy(model_t *model)
 	SDL_ReleaseGPUTexture(model->device, model->texture);
 	SDL_ReleaseGPUSampler(model->device, model->sampler);
 
-	for (size_t nn = 0; nn < model->info.node_count; nn++)
+	for (size_t mm = 0; model->buffers != nullptr && mm < model->info.mesh_count; mm++)
 	{
-		const model_node_t *node = model->info.nodes + nn;
+		const model_mesh_t *mesh = model->info.meshes + mm;
+
+		// Upload may have failed part way through
+		if (model->buffers[mm] == nullptr)
+		{
+			continue;
+		}
 
-		for (size_t pp = 0; pp < node->primitive_count; pp++)
+		for (size_t pp = 0; pp < mesh->primitive_count; pp++)
 		{
-			const primitive_buffers_t *buffers = model->buffers[nn] + pp;
+			const primitive_buffers_t *buffers = model->buffers[mm] + pp;
 
 			SDL_ReleaseGPUBuffer(model->device, buffers->vertex);
 			SDL_ReleaseGPUBuffer(model->device, buffers->index);
 		}
+
+		SDL_free(model->buffers[mm]);
 	}
 
+	SDL_free(model->buffers);
+	model->buffers = nullptr;
+
+	SDL_free(model->visible_ranges);
+	model->visible_ranges = nullptr;
+
+	SDL_free(model->lod_sizes);
+	model->lod_sizes = nullptr;
+
 	model_info_destroy(&model->info);
 }
 
+size_t model_size(const model_t *model)
+{
+	size_t size = sizeof(model_t);
+
+	for (size_t mm = 0; mm < model->info.mesh_count; mm++)
+	{
+		const model_mesh_t *mesh = model->info.meshes + mm;
+
+		for (size_t pp = 0; pp < mesh->primitive_count; pp++)
+		{
+			const mesh_primitive_t *primitive = mesh->primitives + pp;
+			size += (vertex_format_size(model->vertex_format) * primitive->vertex_count)
+				+ sizeof(vector4f_t)
+				+ (primitive->index_size * mesh_primitive_stored_index_count(primitive))
+				+ (sizeof(mesh_cluster_t) * primitive->cluster_count);
+		}
+	}
+
+	return size;
+}
+
 static void mesh_draw(const model_t *model, const mesh_primitive_t *primitive, const primitive_buffers_t *buffers,
-	SDL_GPURenderPass *render_pass, SDL_GPUCommandBuffer *command_buffer, const matrix4x4_t projection)
+	SDL_GPURenderPass *render_pass, SDL_GPUCommandBuffer *command_buffer, const matrix4x4_t projection,
+	const mesh_lod_t *ranges, const size_t range_count)
 {
-	const SDL_GPUBufferBinding vertex_binding = {
-		.buffer = buffers->vertex,
-		.offset = 0,
+	// Colour is stored after the vertices, and read once per instance
+	const SDL_GPUBufferBinding vertex_bindings[] = {
+		(SDL_GPUBufferBinding){
+			.buffer = buffers->vertex,
+			.offset = 0,
+		},
+		(SDL_GPUBufferBinding){
+			.buffer = buffers->vertex,
+			.offset = vertex_format_size(model->vertex_format) * primitive->vertex_count,
+		},
 	};
-	SDL_BindGPUVertexBuffers(render_pass, 0, &vertex_binding, 1);
+	SDL_BindGPUVertexBuffers(render_pass, 0, vertex_bindings, SDL_arraysize(vertex_bindings));
 
 	const SDL_GPUBufferBinding index_binding = {
 		.buffer = buffers->index,
 		.offset = 0,
 	};
-	SDL_BindGPUIndexBuffer(render_pass, &index_binding, SDL_GPU_INDEXELEMENTSIZE_16BIT);
+	SDL_BindGPUIndexBuffer(render_pass, &index_binding, primitive->index_size == sizeof(Uint32)
+		? SDL_GPU_INDEXELEMENTSIZE_32BIT
+		: SDL_GPU_INDEXELEMENTSIZE_16BIT);
 
 	const SDL_GPUTextureSamplerBinding binding = {
 		.texture = model->texture,
@@ -355,26 +550,61 @@ static void mesh_draw(const model_t *model, const mesh_primitive_t *primitive, c
 	};
 	SDL_BindGPUFragmentSamplers(render_pass, 0, &binding, 1);
 
+	// Quantized positions are relative to the bounds of the primitive
 	const vertex_uniform_data_t vertex_data = {
-		.mvp = projection,
+		.mvp = model->vertex_format == VERTEX_FORMAT_FLOAT
+			? projection
+			: matrix4x4_multiply(vertex_format_dequantize(model->vertex_format, primitive), projection),
 	};
 	SDL_PushGPUVertexUniformData(command_buffer, 0, &vertex_data, sizeof(vertex_uniform_data_t));
 
-	SDL_DrawGPUIndexedPrimitives(render_pass, primitive->index_count,
-		1, 0, 0, 0);
+	for (size_t i = 0; i < range_count; i++)
+	{
+		SDL_DrawGPUIndexedPrimitives(render_pass, ranges[i].index_count,
+			1, ranges[i].index_offset, 0, 0);
+	}
 }
 
 static void node_draw(const model_t *model, const size_t node_index, SDL_GPURenderPass *render_pass,
-	SDL_GPUCommandBuffer *command_buffer, const matrix4x4_t projection)
+	SDL_GPUCommandBuffer *command_buffer, const matrix4x4_t projection, float *lod_size)
 {
 	const model_node_t *node = model->info.nodes + node_index;
+	if (node->mesh == nullptr)
+	{
+		return;
+	}
+
+	float screen_size = mesh_screen_size(node->mesh, &projection);
+	if (lod_size != nullptr)
+	{
+		screen_size = mesh_lod_screen_size(*lod_size, screen_size);
+		*lod_size = screen_size;
+	}
 
-	for (size_t i = 0; i < node->primitive_count; i++)
+	// Buffers are shared by all nodes using the mesh
+	const primitive_buffers_t *mesh_buffers = model->buffers[node->mesh - model->info.meshes];
+
+	for (size_t i = 0; i < node->mesh->primitive_count; i++)
 	{
-		const mesh_primitive_t *primitive = node->primitives + i;
-		const primitive_buffers_t *buffers = model->buffers[node_index] + i;
+		const mesh_primitive_t *primitive = node->mesh->primitives + i;
+		const primitive_buffers_t *buffers = mesh_buffers + i;
+
+		const size_t level = mesh_primitive_select_lod(primitive, screen_size);
 
-		mesh_draw(model, primitive, buffers, render_pass, command_buffer, projection);
+		// Clusters are only worth culling at full detail, simplified levels are small on screen
+		if (level > 0)
+		{
+			const mesh_lod_t lod = mesh_primitive_lod(primitive, level);
+			mesh_draw(model, primitive, buffers, render_pass, command_buffer, projection, &lod, 1);
+			continue;
+		}
+
+		const size_t range_count = mesh_primitive_cull_clusters(primitive, &projection, model->visible_ranges);
+		if (range_count > 0)
+		{
+			mesh_draw(model, primitive, buffers, render_pass, command_buffer, projection,
+				model->visible_ranges, range_count);
+		}
 	}
 }
 
@@ -385,15 +615,15 @@ void model_draw(const model_t *model, SDL_GPURenderPass *render_pass,
 	{
 		const model_node_t *node = model->info.nodes + i;
 		const matrix4x4_t projection = matrix4x4_multiply(node->world_transform, view_projection);
-		node_draw(model, i, render_pass, command_buffer, projection);
+		node_draw(model, i, render_pass, command_buffer, projection, model->lod_sizes + i);
 	}
 }
 
 void model_draw_indexed(const model_t *model, const size_t index,
 	SDL_GPURenderPass *render_pass, SDL_GPUCommandBuffer *command_buffer,
-	const matrix4x4_t projection)
+	const matrix4x4_t projection, float *lod_size)
 {
 	SDL_assert(model != nullptr);
 	SDL_assert(index < model->info.node_count);
-	node_draw(model, index, render_pass, command_buffer, projection);
+	node_draw(model, index, render_pass, command_buffer, projection, lod_size);
 }
@@ -4,9 +4,11 @@
 #include "pocketpy.h"
 #include "chirp/logcategory.h"
 
+#include <SDL3/SDL_error.h>
 #include <SDL3/SDL_filesystem.h>
 #include <SDL3/SDL_iostream.h>
 #include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
 
 static char *importfile(const char *path, int *data_size) // TODO
 {
@@ -83,13 +85,19 @@ bool script_engine_exec(const char *filename, SDL_IOStream *stream, const bool c
 		return false;
 	}
 
-	if (!py_execo(file_data, (int) file_size, filename, nullptr))
+	const bool result = script_engine_exec_mem(filename, file_data, file_size);
+	SDL_free(file_data);
+
+	return result;
+}
+
+bool script_engine_exec_mem(const char *filename, const void *data, const size_t size)
+{
+	if (!py_execo(data, (int) size, filename, nullptr))
 	{
-		free(file_data);
 		return SDL_SetError("%s", py_formatexc());
 	}
 
-	free(file_data);
 	return true;
 }
 
@@ -0,0 +1,154 @@
+#include "benchmarks.h"
+
+#include "chirp/assetstream.h"
+#include "chirp/filereader.h"
+
+#include <SDL3/SDL_cpuinfo.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+static const char *bench_path = "bench_assets.bin";
+
+static constexpr int model_count = 16;
+static constexpr Sint64 model_size = 4 * 1024 * 1024;
+static constexpr size_t chunk_size = 16 * 1024;
+static constexpr int iterations = 4;
+
+typedef struct
+{
+	SDL_IOStream *stream;
+	SDL_Mutex *read_mutex;
+	file_reader_t reader;
+	int first;
+	int step;
+} bench_job_t;
+
+static void write_archive()
+{
+	SDL_IOStream *stream = SDL_IOFromFile(bench_path, "wb");
+	assert(stream != nullptr);
+
+	Uint8 *data = SDL_malloc(model_size);
+	Uint32 state = 0x12345678;
+	for (Sint64 i = 0; i < model_size; i++)
+	{
+		state = (state * 1'103'515'245) + 12'345;
+		data[i] = (Uint8) (state >> 16);
+	}
+
+	for (int i = 0; i < model_count; i++)
+	{
+		const size_t written = SDL_WriteIO(stream, data, model_size);
+		assert(written == (size_t) model_size);
+	}
+
+	SDL_free(data);
+	SDL_CloseIO(stream);
+}
+
+static int load_models(void *userdata)
+{
+	const bench_job_t *job = userdata;
+	Uint8 *buffer = SDL_malloc(chunk_size);
+
+	for (int i = job->first; i < model_count; i += job->step)
+	{
+		SDL_IOStream *stream = job->stream != nullptr
+			? asset_stream_open_io(job->stream, job->read_mutex, i * model_size, model_size)
+			: asset_stream_open_reader(job->reader, i * model_size, model_size);
+
+		size_t total = 0;
+		size_t read;
+		while ((read = SDL_ReadIO(stream, buffer, chunk_size)) > 0)
+		{
+			total += read;
+		}
+		assert(total == (size_t) model_size);
+
+		SDL_CloseIO(stream);
+	}
+
+	SDL_free(buffer);
+	return 0;
+}
+
+static double run(const bench_job_t *base, const int thread_count)
+{
+	SDL_Thread *threads[model_count];
+	bench_job_t jobs[model_count];
+
+	const Uint64 begin = SDL_GetPerformanceCounter();
+
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		for (int i = 0; i < thread_count; i++)
+		{
+			jobs[i] = *base;
+			jobs[i].first = i;
+			jobs[i].step = thread_count;
+			threads[i] = SDL_CreateThread(load_models, "bench", jobs + i);
+		}
+
+		for (int i = 0; i < thread_count; i++)
+		{
+			SDL_WaitThread(threads[i], nullptr);
+		}
+	}
+
+	const Uint64 end = SDL_GetPerformanceCounter();
+	return (double) (end - begin) * 1000.0 / (double) SDL_GetPerformanceFrequency() / iterations;
+}
+
+void bench_asset_streams()
+{
+	write_archive();
+
+	SDL_IOStream *stream = SDL_IOFromFile(bench_path, "rb");
+	SDL_Mutex *read_mutex = SDL_CreateMutex();
+
+	file_reader_t reader;
+	const bool opened = file_reader_open(bench_path, &reader);
+	assert(opened);
+
+	const bench_job_t locked = {
+		.stream = stream,
+		.read_mutex = read_mutex,
+	};
+	const bench_job_t positional = {
+		.stream = nullptr,
+		.reader = reader,
+	};
+
+	// Warm up page cache, we want to measure locking, not the disk
+	run(&positional, 1);
+
+	const int max_threads = SDL_min(model_count, SDL_GetNumLogicalCPUCores());
+	const double total_mib = (double) (model_count * model_size) / (1024.0 * 1024.0);
+
+	SDL_Log("Loading %d models of %lld KiB each", model_count, (long long) (model_size / 1024));
+
+	for (int thread_count = 1; thread_count <= max_threads; thread_count++)
+	{
+		const double locked_ms = run(&locked, thread_count);
+		const double positional_ms = run(&positional, thread_count);
+
+		SDL_Log("%2d threads: locked %8.2f ms (%7.1f MiB/s), positional %8.2f ms (%7.1f MiB/s)",
+			thread_count,
+			locked_ms, total_mib / (locked_ms / 1000.0),
+			positional_ms, total_mib / (positional_ms / 1000.0)
+		);
+	}
+
+	file_reader_close(&reader);
+	SDL_DestroyMutex(read_mutex);
+	SDL_CloseIO(stream);
+	SDL_RemovePath(bench_path);
+}
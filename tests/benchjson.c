@@ -0,0 +1,125 @@
+#include "benchmarks.h"
+
+#include "chirp/json.h"
+
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_timer.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+static constexpr int node_count = 100'000;
+static constexpr int iterations = 8;
+
+/**
+ * Similar to what exporters write for large scenes, mostly numbers with some names
+ */
+static char *generate_gltf(size_t *size)
+{
+	SDL_IOStream *stream = SDL_IOFromDynamicMem();
+	assert(stream != nullptr);
+
+	SDL_IOprintf(stream, "{\n\t\"asset\": {\"generator\": \"chirp3d\", \"version\": \"2.0\"},\n\t\"nodes\": [\n");
+
+	for (int i = 0; i < node_count; i++)
+	{
+		SDL_IOprintf(stream,
+			"\t\t{\n\t\t\t\"name\": \"Node.%06d\",\n\t\t\t\"mesh\": %d,\n"
+			"\t\t\t\"rotation\": [0.0, %d.7071068, 0.0, 0.7071068],\n"
+			"\t\t\t\"translation\": [%d.25, -1.5e-3, %d.0]\n\t\t}%s\n",
+			i, i % 64, i % 2, i, -i, i + 1 < node_count ? "," : "");
+	}
+
+	SDL_IOprintf(stream, "\t],\n\t\"buffers\": [{\"uri\": \"scene.bin\", \"byteLength\": 123456}]\n}\n");
+
+	const Sint64 position = SDL_SeekIO(stream, 0, SDL_IO_SEEK_SET);
+	assert(position == 0);
+
+	char *json = SDL_LoadFile_IO(stream, size, true);
+	assert(json != nullptr);
+
+	return json;
+}
+
+/**
+ * Count, then parse, like cgltf does
+ */
+static int parse_jsmn(const char *json, const size_t size)
+{
+	json_parser_t parser;
+	json_init(&parser);
+
+	const int count = json_parse(&parser, json, size, nullptr, 0);
+	assert(count > 0);
+
+	json_token_t *tokens = SDL_malloc(sizeof(json_token_t) * count);
+	assert(tokens != nullptr);
+
+	json_init(&parser);
+	const int parsed_count = json_parse(&parser, json, size, tokens, count);
+	assert(parsed_count == count);
+
+	SDL_free(tokens);
+	return count;
+}
+
+static int parse_tokenize(const char *json, const size_t size)
+{
+	json_token_t *tokens = nullptr;
+
+	const int count = json_tokenize(json, size, &tokens);
+	assert(count > 0);
+
+	SDL_free(tokens);
+	return count;
+}
+
+static double run(int (*parse)(const char*, size_t), const char *json, const size_t size, int *count)
+{
+	const Uint64 begin = SDL_GetPerformanceCounter();
+
+	for (int i = 0; i < iterations; i++)
+	{
+		*count = parse(json, size);
+	}
+
+	const Uint64 end = SDL_GetPerformanceCounter();
+	return (double) (end - begin) * 1000.0 / (double) SDL_GetPerformanceFrequency() / iterations;
+}
+
+void bench_json(const char *path)
+{
+	size_t size = 0;
+	char *json = path != nullptr
+		? SDL_LoadFile(path, &size)
+		: generate_gltf(&size);
+
+	if (json == nullptr)
+	{
+		SDL_Log("Failed to load %s: %s", path, SDL_GetError());
+		return;
+	}
+
+	const double total_mib = (double) size / (1024.0 * 1024.0);
+	SDL_Log("Parsing %.1f MiB of JSON", total_mib);
+
+	// Warm up caches, and make sure both agree
+	int jsmn_count = 0;
+	int tokenize_count = 0;
+	run(parse_jsmn, json, size, &jsmn_count);
+	run(parse_tokenize, json, size, &tokenize_count);
+	assert(jsmn_count == tokenize_count);
+
+	const double jsmn_ms = run(parse_jsmn, json, size, &jsmn_count);
+	const double tokenize_ms = run(parse_tokenize, json, size, &tokenize_count);
+
+	SDL_Log("%d tokens: jsmn %8.2f ms (%7.1f MiB/s), tokenize %8.2f ms (%7.1f MiB/s)",
+		tokenize_count,
+		jsmn_ms, total_mib / (jsmn_ms / 1000.0),
+		tokenize_ms, total_mib / (tokenize_ms / 1000.0)
+	);
+
+	SDL_free(json);
+}
@@ -0,0 +1,25 @@
+#include "benchmarks.h"
+
+#include <stdlib.h>
+
+int main(const int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		return 1;
+	}
+
+	switch (strtol(argv[1], nullptr, 10))
+	{
+		case 1:
+			bench_asset_streams();
+			return 0;
+
+		case 2:
+			bench_json(argc > 2 ? argv[2] : nullptr);
+			return 0;
+
+		default:
+			return 1;
+	}
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+void bench_asset_streams();
+
+/**
+ * @param path glTF file to parse, or nullptr to generate one
+ */
+void bench_json(const char *path);
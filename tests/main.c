@@ -15,6 +15,46 @@ int main(const int argc, char **argv)
 			test_array();
 			return 0;
 
+		case 2:
+			test_compress();
+			return 0;
+
+		case 3:
+			test_asset_cache();
+			return 0;
+
+		case 4:
+			test_block_cache();
+			return 0;
+
+		case 5:
+			test_json();
+			return 0;
+
+		case 6:
+			test_model();
+			return 0;
+
+		case 7:
+			test_mesh_optimize();
+			return 0;
+
+		case 8:
+			test_vertex_format();
+			return 0;
+
+		case 9:
+			test_mesh_lod();
+			return 0;
+
+		case 10:
+			test_mesh_clusters();
+			return 0;
+
+		case 11:
+			test_read_batch();
+			return 0;
+
 		default:
 			return 1;
 	}
@@ -0,0 +1,126 @@
+#include "tests.h"
+
+#include "chirp/assetcache.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <assert.h>
+
+static int freed_count = 0;
+
+static void free_data(void *data)
+{
+	SDL_free(data);
+	freed_count++;
+}
+
+static void *create_data()
+{
+	return SDL_malloc(1);
+}
+
+static void test_asset_cache_acquire()
+{
+	asset_cache_t *cache = asset_cache_create(100);
+
+	const void *missing = asset_cache_acquire(cache, 1);
+	assert(missing == nullptr);
+
+	void *data = create_data();
+	const void *inserted = asset_cache_insert(cache, 1, data, 10, free_data);
+	assert(inserted == data);
+	const void *acquired = asset_cache_acquire(cache, 1);
+	assert(acquired == data);
+
+	// Inserting an existing key returns the cached entry
+	const void *existing = asset_cache_insert(cache, 1, create_data(), 10, free_data);
+	assert(existing == data);
+
+	const asset_cache_stats_t stats = asset_cache_stats(cache);
+	assert(stats.entry_count == 1);
+	assert(stats.size == 10);
+	assert(stats.hits == 1);
+	assert(stats.misses == 1);
+
+	asset_cache_destroy(cache);
+}
+
+static void test_asset_cache_evict()
+{
+	freed_count = 0;
+	asset_cache_t *cache = asset_cache_create(100);
+
+	const void *first = asset_cache_insert(cache, 1, create_data(), 40, free_data);
+	const void *second = asset_cache_insert(cache, 2, create_data(), 40, free_data);
+	assert(first != nullptr && second != nullptr);
+
+	// Still under budget, so nothing is evicted yet
+	asset_cache_release(cache, 1);
+	asset_cache_release(cache, 2);
+	assert(asset_cache_stats(cache).entry_count == 2);
+
+	// Using the first entry again leaves the second one as the least recently used
+	const void *touched = asset_cache_acquire(cache, 1);
+	assert(touched == first);
+	asset_cache_release(cache, 1);
+
+	const void *third = asset_cache_insert(cache, 3, create_data(), 40, free_data);
+	assert(third != nullptr);
+	assert(asset_cache_stats(cache).entry_count == 2);
+	assert(asset_cache_stats(cache).evictions == 1);
+	assert(freed_count == 1);
+
+	const void *evicted = asset_cache_acquire(cache, 2);
+	assert(evicted == nullptr);
+	const void *kept = asset_cache_acquire(cache, 1);
+	assert(kept == first);
+
+	// Over budget, but everything left is still referenced
+	const void *fourth = asset_cache_insert(cache, 4, create_data(), 40, free_data);
+	assert(fourth != nullptr);
+	assert(asset_cache_stats(cache).entry_count == 3);
+	assert(freed_count == 1);
+
+	asset_cache_destroy(cache);
+	assert(freed_count == 4);
+}
+
+/**
+ * Models are inserted when first loaded, released when their last instance is removed,
+ * and acquired again when spawned before being evicted
+ */
+static void test_asset_cache_respawn()
+{
+	freed_count = 0;
+	asset_cache_t *cache = asset_cache_create(100);
+
+	const void *model = asset_cache_insert(cache, 1, create_data(), 60, free_data);
+	assert(model != nullptr);
+
+	// Despawned and spawned again, without loading it again
+	asset_cache_release(cache, 1);
+	const void *respawned = asset_cache_acquire(cache, 1);
+	assert(respawned == model);
+	assert(asset_cache_stats(cache).hits == 1);
+	assert(freed_count == 0);
+
+	// Despawned for good, so loading another model over the budget evicts it
+	asset_cache_release(cache, 1);
+	const void *other = asset_cache_insert(cache, 2, create_data(), 60, free_data);
+	assert(other != nullptr);
+	assert(asset_cache_stats(cache).evictions == 1);
+	assert(freed_count == 1);
+
+	const void *evicted = asset_cache_acquire(cache, 1);
+	assert(evicted == nullptr);
+
+	asset_cache_destroy(cache);
+	assert(freed_count == 2);
+}
+
+void test_asset_cache()
+{
+	test_asset_cache_acquire();
+	test_asset_cache_evict();
+	test_asset_cache_respawn();
+}
@@ -0,0 +1,122 @@
+#include "tests.h"
+
+#include "chirp/blockcache.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <assert.h>
+
+static constexpr size_t file_size = 1000;
+
+static int read_count = 0;
+
+static size_t read_file(void *userdata, void *dst, const size_t size, const Uint64 offset)
+{
+	const Uint8 *file = userdata;
+	SDL_memcpy(dst, file + offset, size);
+	read_count++;
+	return size;
+}
+
+[[nodiscard]]
+static block_cache_t *create_cache(const size_t block_count)
+{
+	Uint8 *file = SDL_malloc(file_size);
+	for (size_t i = 0; i < file_size; i++)
+	{
+		file[i] = (Uint8) (i * 7);
+	}
+
+	read_count = 0;
+	return block_cache_create(64, block_count, file_size, read_file, file);
+}
+
+static void test_block_cache_read()
+{
+	block_cache_t *cache = create_cache(16);
+	assert(cache != nullptr);
+
+	// Spans two blocks, which are read together
+	Uint8 data[32];
+	size_t read_size = block_cache_read(cache, data, 32, 50, 0);
+	assert(read_size == 32);
+	assert(read_count == 1);
+	for (size_t i = 0; i < 32; i++)
+	{
+		assert(data[i] == (Uint8) ((50 + i) * 7));
+	}
+
+	// Stops at the end of the file
+	read_size = block_cache_read(cache, data, 32, 990, 0);
+	assert(read_size == 10);
+	assert(data[9] == (Uint8) (999 * 7));
+	read_size = block_cache_read(cache, data, 32, file_size, 0);
+	assert(read_size == 0);
+
+	const int reads = read_count;
+	read_size = block_cache_read(cache, data, 16, 60, 0);
+	assert(read_size == 16);
+	assert(read_count == reads);
+
+	const block_cache_stats_t stats = block_cache_stats(cache);
+	assert(stats.hits == 3);
+	assert(stats.misses == 2);
+
+	block_cache_destroy(cache);
+}
+
+static void test_block_cache_readahead()
+{
+	block_cache_t *cache = create_cache(16);
+
+	// Blocks up to the expected end are read together with the first one
+	Uint8 data[16];
+	size_t read_size = block_cache_read(cache, data, 16, 0, 256);
+	assert(read_size == 16);
+	assert(read_count == 1);
+
+	for (Uint64 offset = 16; offset < 256; offset += 16)
+	{
+		read_size = block_cache_read(cache, data, 16, offset, 256);
+		assert(read_size == 16);
+		assert(data[0] == (Uint8) (offset * 7));
+	}
+	assert(read_count == 1);
+	assert(block_cache_stats(cache).readahead == 3);
+
+	// Large reads skip the cache
+	Uint8 large[128];
+	read_size = block_cache_read(cache, large, 128, 0, 0);
+	assert(read_size == 128);
+	assert(block_cache_stats(cache).direct == 1);
+
+	block_cache_destroy(cache);
+}
+
+static void test_block_cache_evict()
+{
+	// One block in each shard
+	block_cache_t *cache = create_cache(1);
+
+	Uint8 data[16];
+	size_t read_size = block_cache_read(cache, data, 16, 0, 0);
+	assert(read_size == 16);
+	read_size = block_cache_read(cache, data, 16, 64 * 8, 0);
+	assert(read_size == 16);
+	assert(read_count == 2);
+
+	// Shares a shard with the previous block, so it was evicted
+	read_size = block_cache_read(cache, data, 16, 0, 0);
+	assert(read_size == 16);
+	assert(read_count == 3);
+	assert(data[1] == 7);
+
+	block_cache_destroy(cache);
+}
+
+void test_block_cache()
+{
+	test_block_cache_read();
+	test_block_cache_readahead();
+	test_block_cache_evict();
+}
@@ -0,0 +1,113 @@
+#include "tests.h"
+
+#include "chirp/assetstream.h"
+#include "chirp/compress.h"
+
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+static Uint8 *create_data(const size_t size)
+{
+	Uint8 *data = SDL_malloc(size);
+	assert(data != nullptr);
+
+	// Mix of repeating runs and noise, similar to vertex buffers
+	Uint32 seed = 1;
+	for (size_t i = 0; i < size; i++)
+	{
+		seed = (seed * 1103515245) + 12345;
+		data[i] = (i / 256) % 2 == 0
+			? (Uint8) (i % 16)
+			: (Uint8) (seed >> 16);
+	}
+
+	return data;
+}
+
+static void test_compress_block()
+{
+	constexpr size_t size = 4096;
+	Uint8 *data = create_data(size);
+
+	const size_t capacity = compress_bound(size);
+	Uint8 *compressed = SDL_malloc(capacity);
+	const size_t compressed_size = compress_block(data, size, compressed, capacity);
+
+	assert(compressed_size > 0);
+	assert(compressed_size < size);
+
+	Uint8 *decompressed = SDL_malloc(size);
+	const bool decompressed_ok = decompress_block(compressed, compressed_size, decompressed, size);
+	assert(decompressed_ok);
+	assert(SDL_memcmp(data, decompressed, size) == 0);
+
+	// Wrong size is an error, not a partial decode
+	const bool short_ok = decompress_block(compressed, compressed_size, decompressed, size - 1);
+	assert(!short_ok);
+
+	SDL_free(decompressed);
+	SDL_free(compressed);
+	SDL_free(data);
+}
+
+static void test_compress_small()
+{
+	const char data[] = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab";
+
+	Uint8 compressed[64];
+	const size_t compressed_size = compress_block(data, sizeof(data), compressed, sizeof(compressed));
+	assert(compressed_size > 0);
+
+	char decompressed[sizeof(data)];
+	const bool decompressed_ok = decompress_block(compressed, compressed_size, decompressed, sizeof(data));
+	assert(decompressed_ok);
+	assert(SDL_memcmp(data, decompressed, sizeof(data)) == 0);
+
+	// Doesn't fit
+	const size_t too_small_size = compress_block(data, sizeof(data), compressed, 2);
+	assert(too_small_size == 0);
+}
+
+static void test_compress_stream()
+{
+	const size_t size = (compress_block_size * 3) + 1234;
+	Uint8 *data = create_data(size);
+
+	size_t compressed_size = 0;
+	Uint8 *compressed = compress_chunked(data, size, &compressed_size);
+	assert(compressed != nullptr);
+	assert(compressed_size < size);
+
+	SDL_IOStream *stream = asset_stream_open_compressed(SDL_IOFromConstMem(compressed, compressed_size));
+	assert(stream != nullptr);
+	assert(SDL_GetIOSize(stream) == (Sint64) size);
+
+	// Read across block boundaries
+	Uint8 *decompressed = SDL_malloc(size);
+	size_t read = SDL_ReadIO(stream, decompressed, size);
+	assert(read == size);
+	assert(SDL_memcmp(data, decompressed, size) == 0);
+
+	// Seek into the middle of a block
+	const Sint64 offset = compress_block_size + 100;
+	const Sint64 position = SDL_SeekIO(stream, offset, SDL_IO_SEEK_SET);
+	assert(position == offset);
+	read = SDL_ReadIO(stream, decompressed, 16);
+	assert(read == 16);
+	assert(SDL_memcmp(data + offset, decompressed, 16) == 0);
+
+	SDL_CloseIO(stream);
+	SDL_free(decompressed);
+	SDL_free(compressed);
+	SDL_free(data);
+}
+
+void test_compress()
+{
+	test_compress_block();
+	test_compress_small();
+	test_compress_stream();
+}
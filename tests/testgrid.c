@@ -0,0 +1,72 @@
+#include "tests.h"
+
+#include "chirp/modelinfo.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+void create_test_grid(primitive_vertex_t *vertices, Uint32 *indices,
+	const float curvature, const bool shuffle)
+{
+	Uint64 state = 1234;
+
+	Uint32 vertex_order[grid_vertex_count];
+	for (size_t i = 0; i < grid_vertex_count; i++)
+	{
+		vertex_order[i] = (Uint32) i;
+	}
+
+	for (size_t i = grid_vertex_count - 1; shuffle && i > 0; i--)
+	{
+		const size_t j = SDL_rand_r(&state, (Sint32) (i + 1));
+		const Uint32 temp = vertex_order[i];
+		vertex_order[i] = vertex_order[j];
+		vertex_order[j] = temp;
+	}
+
+	for (size_t y = 0; y <= grid_size; y++)
+	{
+		for (size_t x = 0; x <= grid_size; x++)
+		{
+			const float dx = (float) x - ((float) grid_size * 0.5F);
+			const float dy = (float) y - ((float) grid_size * 0.5F);
+
+			vertices[vertex_order[(y * (grid_size + 1)) + x]] = (primitive_vertex_t){
+				.position = {(float) x, (float) y, curvature * ((dx * dx) + (dy * dy))},
+				.normal = {0.F, 0.F, 1.F},
+			};
+		}
+	}
+
+	for (size_t y = 0; y < grid_size; y++)
+	{
+		for (size_t x = 0; x < grid_size; x++)
+		{
+			const Uint32 v0 = vertex_order[(y * (grid_size + 1)) + x];
+			const Uint32 v1 = vertex_order[(y * (grid_size + 1)) + x + 1];
+			const Uint32 v2 = vertex_order[((y + 1) * (grid_size + 1)) + x];
+			const Uint32 v3 = vertex_order[((y + 1) * (grid_size + 1)) + x + 1];
+
+			Uint32 *quad = indices + (((y * grid_size) + x) * 6);
+			quad[0] = v0;
+			quad[1] = v1;
+			quad[2] = v2;
+			quad[3] = v2;
+			quad[4] = v1;
+			quad[5] = v3;
+		}
+	}
+
+	for (size_t i = (grid_index_count / 3) - 1; shuffle && i > 0; i--)
+	{
+		const size_t j = SDL_rand_r(&state, (Sint32) (i + 1));
+
+		for (size_t k = 0; k < 3; k++)
+		{
+			const Uint32 temp = indices[(i * 3) + k];
+			indices[(i * 3) + k] = indices[(j * 3) + k];
+			indices[(j * 3) + k] = temp;
+		}
+	}
+}
@@ -0,0 +1,121 @@
+#include "tests.h"
+
+#include "chirp/json.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+/**
+ * Tokenize using both parsers, and make sure they agree
+ * @returns Number of tokens, or the error from json_parse
+ */
+static int compare_parsers(const char *json)
+{
+	const size_t json_len = SDL_strlen(json);
+
+	json_parser_t parser;
+	json_init(&parser);
+
+	constexpr size_t token_count = 64;
+	json_token_t expected[token_count];
+	const int expected_count = json_parse(&parser, json, json_len, expected, token_count);
+
+	json_token_t *tokens = nullptr;
+	const int count = json_tokenize(json, json_len, &tokens);
+
+	if (expected_count < 0)
+	{
+		assert(count < 0);
+		assert(tokens == nullptr);
+		return expected_count;
+	}
+
+	assert(count == expected_count);
+
+	for (int i = 0; i < count; i++)
+	{
+		assert(tokens[i].type == expected[i].type);
+		assert(tokens[i].start == expected[i].start);
+		assert(tokens[i].end == expected[i].end);
+		assert(tokens[i].size == expected[i].size);
+		assert(tokens[i].parent == expected[i].parent);
+	}
+
+	SDL_free(tokens);
+	return count;
+}
+
+/**
+ * @param expected Number of tokens, or the error from json_parse
+ */
+static void expect_result(const char *json, const int expected)
+{
+	const int result = compare_parsers(json);
+	assert(result == expected);
+}
+
+/**
+ * Fails with any error, without the parsers necessarily agreeing on which
+ */
+static void expect_error(const char *json)
+{
+	const int result = compare_parsers(json);
+	assert(result < 0);
+}
+
+static void test_json_tokens()
+{
+	expect_result("{}", 1);
+	expect_result("[1, -2.5e3, true, false, null]", 6);
+	expect_result("{\"met\": {\"n\": \"chirp3d\", \"v\": \"1.0.0\"}, \"win\": [1280, 720]}", 11);
+
+	// Strings and primitives crossing 16 and 32 byte blocks
+	expect_result("{\"a string long enough to cross a block\": 1234567890123456789012345678901234567890}", 3);
+	expect_result("[\"0123456789abcdefghijklmnopqrstu\\\\\", \"0123456789abcdefghijklmnopqrstuv\\\"\"]", 3);
+	expect_result("\t[\r\n{\"uri\" :\"buffer.bin\" ,\"byteLength\":\t12}\n]\n", 6);
+}
+
+static void test_json_escapes()
+{
+	expect_result("[\"\\\"\\\\\\/\\b\\f\\n\\r\\t\", \"\\u00e9\\uD83D\"]", 3);
+	expect_result("[\"\\\\\", \"\\\\\\\"\"]", 3);
+
+	// Structural characters inside strings are ignored
+	expect_result("{\"{[:,]}\": \"\\\"}\"}", 3);
+
+	expect_result("[\"\\x\"]", JSON_ERROR_INVALID);
+	expect_result("[\"\\u12g4\"]", JSON_ERROR_INVALID);
+}
+
+static void test_json_errors()
+{
+	expect_error("[1, 2");
+	expect_error("{\"a\": \"b");
+	expect_result("[1}", JSON_ERROR_INVALID);
+	expect_result("{1: 2}", JSON_ERROR_INVALID);
+	expect_result("[1, 2]x", JSON_ERROR_INVALID);
+
+	// Primitives have to be followed by something
+	expect_result("1", JSON_ERROR_INCOMPLETE);
+}
+
+static void test_json_null()
+{
+	// Everything after a null character is ignored
+	const char json[] = "[1, 2]\0[3]";
+
+	json_token_t *tokens = nullptr;
+	const int count = json_tokenize(json, sizeof(json) - 1, &tokens);
+	assert(count == 3);
+	SDL_free(tokens);
+}
+
+void test_json()
+{
+	test_json_tokens();
+	test_json_escapes();
+	test_json_errors();
+	test_json_null();
+}
@@ -0,0 +1,331 @@
+#include "tests.h"
+
+#include "chirp/matrix.h"
+#include "chirp/meshlet.h"
+#include "chirp/modelinfo.h"
+#include "chirp/vector.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+static constexpr size_t face_size = 16;
+static constexpr size_t face_vertex_count = (face_size + 1) * (face_size + 1);
+static constexpr size_t face_index_count = face_size * face_size * 6;
+
+static constexpr size_t cube_vertex_count = face_vertex_count * 6;
+static constexpr size_t cube_index_count = face_index_count * 6;
+
+/**
+ * Cube from -8 to 8, each face a grid with its own vertices, facing outwards
+ */
+static void create_cube(primitive_vertex_t *vertices, Uint32 *indices)
+{
+	const vector3f_t normals[] = {
+		{1.F, 0.F, 0.F}, {-1.F, 0.F, 0.F},
+		{0.F, 1.F, 0.F}, {0.F, -1.F, 0.F},
+		{0.F, 0.F, 1.F}, {0.F, 0.F, -1.F},
+	};
+
+	for (size_t face = 0; face < SDL_arraysize(normals); face++)
+	{
+		const vector3f_t normal = normals[face];
+
+		// Picked so that u x v is the normal, making triangles counter-clockwise from outside
+		const vector3f_t u_axis = SDL_fabsf(normal.x) > 0.F
+			? (vector3f_t){0.F, 1.F, 0.F}
+			: (SDL_fabsf(normal.y) > 0.F ? (vector3f_t){0.F, 0.F, 1.F} : (vector3f_t){1.F, 0.F, 0.F});
+		const vector3f_t v_axis = vector3f_cross(normal, u_axis);
+
+		primitive_vertex_t *face_vertices = vertices + (face * face_vertex_count);
+		Uint32 *face_indices = indices + (face * face_index_count);
+
+		for (size_t y = 0; y <= face_size; y++)
+		{
+			for (size_t x = 0; x <= face_size; x++)
+			{
+				const float s = (float) x - ((float) face_size * 0.5F);
+				const float t = (float) y - ((float) face_size * 0.5F);
+
+				face_vertices[(y * (face_size + 1)) + x] = (primitive_vertex_t){
+					.position = vector3f_add(vector3f_scale(normal, (float) face_size * 0.5F),
+						vector3f_add(vector3f_scale(u_axis, s), vector3f_scale(v_axis, t))),
+					.normal = normal,
+				};
+			}
+		}
+
+		for (size_t y = 0; y < face_size; y++)
+		{
+			for (size_t x = 0; x < face_size; x++)
+			{
+				const Uint32 v0 = (Uint32) ((face * face_vertex_count) + (y * (face_size + 1)) + x);
+				const Uint32 v1 = v0 + 1;
+				const Uint32 v2 = v0 + (Uint32) (face_size + 1);
+				const Uint32 v3 = v2 + 1;
+
+				Uint32 *quad = face_indices + (((y * face_size) + x) * 6);
+				quad[0] = v0;
+				quad[1] = v1;
+				quad[2] = v2;
+				quad[3] = v2;
+				quad[4] = v1;
+				quad[5] = v3;
+			}
+		}
+	}
+}
+
+static mesh_primitive_t create_cube_primitive()
+{
+	mesh_primitive_t primitive = {
+		.vertices = SDL_malloc(sizeof(primitive_vertex_t) * cube_vertex_count),
+		.vertex_count = cube_vertex_count,
+		.indices = SDL_malloc(sizeof(Uint16) * cube_index_count),
+		.index_count = cube_index_count,
+		.index_size = sizeof(Uint16),
+	};
+
+	Uint32 *indices = SDL_malloc(sizeof(Uint32) * cube_index_count);
+	assert(primitive.vertices != nullptr && primitive.indices != nullptr && indices != nullptr);
+
+	create_cube(primitive.vertices, indices);
+	for (size_t i = 0; i < cube_index_count; i++)
+	{
+		((Uint16*) primitive.indices)[i] = (Uint16) indices[i];
+	}
+
+	SDL_free(indices);
+
+	const bool built = mesh_primitive_build_clusters(&primitive);
+	assert(built);
+
+	return primitive;
+}
+
+static void destroy_primitive(const mesh_primitive_t *primitive)
+{
+	SDL_free(primitive->vertices);
+	SDL_free(primitive->indices);
+	SDL_free(primitive->clusters);
+}
+
+static vector3f_t triangle_normal(const mesh_primitive_t *primitive, const size_t index)
+{
+	const Uint16 *triangle = (const Uint16*) primitive->indices + index;
+	const vector3f_t p0 = primitive->vertices[triangle[0]].position;
+
+	return vector3f_normalize(vector3f_cross(
+		vector3f_sub(primitive->vertices[triangle[1]].position, p0),
+		vector3f_sub(primitive->vertices[triangle[2]].position, p0)));
+}
+
+static void test_mesh_clusters_build()
+{
+	const mesh_primitive_t primitive = create_cube_primitive();
+	assert(primitive.cluster_count > cube_index_count / (mesh_cluster_max_triangles * 3));
+
+	Uint8 used[cube_vertex_count];
+	size_t offset = 0;
+
+	for (size_t i = 0; i < primitive.cluster_count; i++)
+	{
+		const mesh_cluster_t *cluster = primitive.clusters + i;
+		const Uint16 *indices = (const Uint16*) primitive.indices + cluster->index_offset;
+
+		// One after another, in the order they're drawn
+		assert(cluster->index_offset == offset);
+		assert(cluster->index_count > 0);
+		assert(cluster->index_count <= mesh_cluster_max_triangles * 3);
+		assert(cluster->index_count % 3 == 0);
+		offset += cluster->index_count;
+
+		SDL_memset(used, 0, sizeof(used));
+		size_t vertex_count = 0;
+
+		for (size_t j = 0; j < cluster->index_count; j++)
+		{
+			const primitive_vertex_t *vertex = primitive.vertices + indices[j];
+			const vector3f_t offset_from_center = vector3f_sub(vertex->position, cluster->center);
+			assert(SDL_sqrtf(vector3f_dot(offset_from_center, offset_from_center)) <= cluster->radius + 0.0001F);
+
+			vertex_count += used[indices[j]] == 0 ? 1 : 0;
+			used[indices[j]] = 1;
+		}
+
+		assert(vertex_count <= mesh_cluster_max_vertices);
+
+		if (cluster->cone_cutoff >= 1.F)
+		{
+			continue;
+		}
+
+		// Half angle of the cone, as a cosine
+		const float min_dot = SDL_sqrtf(1.F - (cluster->cone_cutoff * cluster->cone_cutoff));
+		for (size_t j = 0; j < cluster->index_count; j += 3)
+		{
+			const vector3f_t normal = triangle_normal(&primitive, cluster->index_offset + j);
+			assert(vector3f_dot(normal, cluster->cone_axis) >= min_dot - 0.0001F);
+		}
+	}
+
+	assert(offset == cube_index_count);
+	destroy_primitive(&primitive);
+}
+
+static void test_mesh_clusters_small()
+{
+	mesh_primitive_t primitive = create_cube_primitive();
+
+	// A single cluster's worth, so culled with the node instead
+	primitive.index_count = mesh_cluster_max_triangles * 3;
+	const bool built = mesh_primitive_build_clusters(&primitive);
+	assert(built);
+	assert(primitive.cluster_count == 0);
+	assert(primitive.clusters == nullptr);
+
+	mesh_lod_t range;
+	const matrix4x4_t mvp = matrix4x4_create_translation((vector3f_t){0.F, 0.F, 1000.F});
+	const size_t range_count = mesh_primitive_cull_clusters(&primitive, &mvp, &range);
+	assert(range_count == 1);
+	assert(range.index_offset == 0);
+	assert(range.index_count == primitive.index_count);
+
+	destroy_primitive(&primitive);
+}
+
+/**
+ * Visible triangles when looking from position towards target, in total and for each face,
+ * checking that every triangle facing the camera inside the view is drawn
+ */
+static size_t visible_triangles(const mesh_primitive_t *primitive, const vector3f_t position,
+	const vector3f_t target, const matrix4x4_t projection, size_t *range_count, size_t *face_counts)
+{
+	const matrix4x4_t mvp = matrix4x4_multiply(
+		matrix4x4_create_look_at(position, target, (vector3f_t){0.F, 1.F, 0.F}), projection);
+
+	mesh_lod_t ranges[cube_index_count / 3];
+	*range_count = mesh_primitive_cull_clusters(primitive, &mvp, ranges);
+
+	size_t triangle_count = 0;
+	SDL_memset(face_counts, 0, sizeof(size_t) * 6);
+
+	for (size_t i = 0; i < *range_count; i++)
+	{
+		assert(ranges[i].index_offset + ranges[i].index_count <= primitive->index_count);
+		triangle_count += ranges[i].index_count / 3;
+
+		for (size_t j = ranges[i].index_offset; j < ranges[i].index_offset + ranges[i].index_count; j += 3)
+		{
+			face_counts[j / face_index_count]++;
+		}
+	}
+
+	for (size_t i = 0; i < primitive->index_count; i += 3)
+	{
+		const Uint16 *triangle = (const Uint16*) primitive->indices + i;
+		const vector3f_t p0 = primitive->vertices[triangle[0]].position;
+
+		// Only perspective cameras can see triangles from behind
+		if (projection.m[11] != 0.F
+			&& vector3f_dot(triangle_normal(primitive, i), vector3f_sub(position, p0)) <= 0.F)
+		{
+			continue;
+		}
+
+		// Fully inside the view frustum, between the near and far planes
+		bool inside = true;
+		for (size_t j = 0; j < 3; j++)
+		{
+			const vector3f_t p = primitive->vertices[triangle[j]].position;
+			const float *m = mvp.m;
+
+			const float x = (p.x * m[0]) + (p.y * m[4]) + (p.z * m[8]) + m[12];
+			const float y = (p.x * m[1]) + (p.y * m[5]) + (p.z * m[9]) + m[13];
+			const float z = (p.x * m[2]) + (p.y * m[6]) + (p.z * m[10]) + m[14];
+			const float w = (p.x * m[3]) + (p.y * m[7]) + (p.z * m[11]) + m[15];
+
+			inside = inside && SDL_fabsf(x) < w && SDL_fabsf(y) < w && z > 0.F && z < w;
+		}
+
+		if (!inside)
+		{
+			continue;
+		}
+
+		bool drawn = false;
+		for (size_t j = 0; j < *range_count; j++)
+		{
+			drawn = drawn || (i >= ranges[j].index_offset && i < ranges[j].index_offset + ranges[j].index_count);
+		}
+
+		assert(drawn);
+	}
+
+	return triangle_count;
+}
+
+static void test_mesh_clusters_cull()
+{
+	const mesh_primitive_t primitive = create_cube_primitive();
+
+	const size_t face_triangle_count = face_index_count / 3;
+	const size_t cube_triangle_count = cube_index_count / 3;
+
+	const matrix4x4_t perspective = matrix4x4_create_perspective(SDL_PI_F * 0.5F, 1.F, 0.1F, 100.F);
+	size_t range_count = 0;
+	size_t faces[6];
+
+	// Sides are seen edge on, so only the back is always facing away,
+	// apart from a cluster continuing from the face before it
+	const size_t front = visible_triangles(&primitive, (vector3f_t){0.F, 0.F, 40.F},
+		vector3f_zero(), perspective, &range_count, faces);
+	assert(faces[4] == face_triangle_count);
+	assert(faces[5] <= mesh_cluster_max_triangles);
+	assert(front < cube_triangle_count);
+
+	// Looking at a corner, three faces are visible, and the other three clearly face away
+	const size_t corner = visible_triangles(&primitive, (vector3f_t){30.F, 30.F, 30.F},
+		vector3f_zero(), perspective, &range_count, faces);
+	assert(faces[0] == face_triangle_count);
+	assert(faces[2] == face_triangle_count);
+	assert(faces[4] == face_triangle_count);
+	assert(faces[1] <= mesh_cluster_max_triangles);
+	assert(faces[3] <= mesh_cluster_max_triangles);
+	assert(faces[5] <= mesh_cluster_max_triangles);
+	assert(corner < cube_triangle_count);
+
+	// Looking above the centre, the rows at the bottom of the front face are outside the view
+	visible_triangles(&primitive, (vector3f_t){0.F, 0.F, 40.F},
+		(vector3f_t){0.F, 60.F, 0.F}, perspective, &range_count, faces);
+	assert(faces[4] > 0);
+	assert(faces[4] < face_triangle_count);
+
+	// Looking away
+	const size_t away_count = visible_triangles(&primitive, (vector3f_t){0.F, 0.F, 40.F},
+		(vector3f_t){0.F, 0.F, 80.F}, perspective, &range_count, faces);
+	assert(away_count == 0);
+	assert(range_count == 0);
+
+	// Too far away to be inside the view at all
+	const size_t far_count = visible_triangles(&primitive, (vector3f_t){0.F, 0.F, 200.F},
+		vector3f_zero(), perspective, &range_count, faces);
+	assert(far_count == 0);
+
+	// Orthographic cameras only cull by the view, so everything is drawn, as a single range
+	const matrix4x4_t orthographic = matrix4x4_create_orthographic(-20.F, 20.F, -20.F, 20.F, 0.1F, 100.F);
+	const size_t orthographic_count = visible_triangles(&primitive, (vector3f_t){0.F, 0.F, 40.F},
+		vector3f_zero(), orthographic, &range_count, faces);
+	assert(orthographic_count == cube_triangle_count);
+	assert(range_count == 1);
+
+	destroy_primitive(&primitive);
+}
+
+void test_mesh_clusters()
+{
+	test_mesh_clusters_build();
+	test_mesh_clusters_small();
+	test_mesh_clusters_cull();
+}
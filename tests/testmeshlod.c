@@ -0,0 +1,226 @@
+#include "tests.h"
+
+#include "chirp/matrix.h"
+#include "chirp/meshlod.h"
+#include "chirp/modelinfo.h"
+#include "chirp/vector.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+/**
+ * Area of all triangles projected onto the xy plane, negative for triangles facing away
+ */
+static float projected_area(const primitive_vertex_t *vertices, const Uint32 *indices,
+	const size_t index_count)
+{
+	float area = 0.F;
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		const vector3f_t p0 = vertices[indices[i + 0]].position;
+		const vector3f_t p1 = vertices[indices[i + 1]].position;
+		const vector3f_t p2 = vertices[indices[i + 2]].position;
+
+		const float triangle_area = (((p1.x - p0.x) * (p2.y - p0.y)) - ((p1.y - p0.y) * (p2.x - p0.x))) * 0.5F;
+		assert(triangle_area > 0.F);
+
+		area += triangle_area;
+	}
+
+	return area;
+}
+
+static void test_mesh_simplify_plane()
+{
+	primitive_vertex_t vertices[grid_vertex_count];
+	Uint32 indices[grid_index_count];
+	create_test_grid(vertices, indices, 0.F, false);
+
+	Uint32 result[grid_index_count];
+	size_t result_count = 0;
+	float result_error = 1.F;
+
+	const size_t target_count = grid_index_count / 4;
+	const bool simplified = mesh_simplify(result, indices, grid_index_count, vertices, grid_vertex_count,
+		target_count, 0.01F, &result_count, &result_error);
+	assert(simplified);
+
+	assert(result_count <= target_count);
+	assert(result_count % 3 == 0);
+	assert(result_error < 0.0001F);
+
+	// Nothing flipped, and borders are kept, so it still covers the same area
+	const float area = projected_area(vertices, result, result_count);
+	assert(SDL_fabsf(area - (float) (grid_size * grid_size)) < 0.01F);
+
+	for (size_t i = 0; i < result_count; i++)
+	{
+		assert(result[i] < grid_vertex_count);
+	}
+}
+
+static void test_mesh_simplify_error()
+{
+	primitive_vertex_t vertices[grid_vertex_count];
+	Uint32 indices[grid_index_count];
+	create_test_grid(vertices, indices, 0.02F, false);
+
+	Uint32 strict[grid_index_count];
+	Uint32 relaxed[grid_index_count];
+
+	size_t strict_count = 0;
+	size_t relaxed_count = 0;
+	float strict_error = 0.F;
+	float relaxed_error = 0.F;
+
+	const bool strict_simplified = mesh_simplify(strict, indices, grid_index_count,
+		vertices, grid_vertex_count, 0, 0.0001F, &strict_count, &strict_error);
+	assert(strict_simplified);
+
+	const bool relaxed_simplified = mesh_simplify(relaxed, indices, grid_index_count,
+		vertices, grid_vertex_count, 0, 0.05F, &relaxed_count, &relaxed_error);
+	assert(relaxed_simplified);
+
+	// Curved everywhere, so a small error allows few collapses
+	assert(strict_error <= 0.0001F);
+	assert(strict_count > grid_index_count / 2);
+
+	assert(relaxed_error <= 0.05F);
+	assert(relaxed_count < strict_count);
+
+	projected_area(vertices, relaxed, relaxed_count);
+}
+
+static void test_mesh_primitive_generate_lods()
+{
+	primitive_vertex_t vertices[grid_vertex_count];
+	Uint32 indices[grid_index_count];
+	create_test_grid(vertices, indices, 0.F, false);
+
+	mesh_primitive_t primitive = {
+		.vertices = SDL_malloc(sizeof(vertices)),
+		.vertex_count = grid_vertex_count,
+		.indices = SDL_malloc(sizeof(Uint16) * grid_index_count),
+		.index_count = grid_index_count,
+		.index_size = sizeof(Uint16),
+	};
+
+	SDL_memcpy(primitive.vertices, vertices, sizeof(vertices));
+	for (size_t i = 0; i < grid_index_count; i++)
+	{
+		((Uint16*) primitive.indices)[i] = (Uint16) indices[i];
+	}
+
+	const float ratios[] = {0.5F, 0.25F, 0.125F};
+	const bool generated = mesh_primitive_generate_lods(&primitive, ratios, SDL_arraysize(ratios));
+	assert(generated);
+
+	assert(primitive.lod_count >= 2);
+	assert(primitive.index_count == grid_index_count);
+
+	const mesh_lod_t full = mesh_primitive_lod(&primitive, 0);
+	assert(full.index_offset == 0);
+	assert(full.index_count == grid_index_count);
+
+	// Stored one after another, each with fewer triangles
+	size_t offset = grid_index_count;
+	size_t previous_count = grid_index_count;
+
+	for (size_t i = 0; i < primitive.lod_count; i++)
+	{
+		const mesh_lod_t lod = mesh_primitive_lod(&primitive, i + 1);
+		assert(lod.index_offset == offset);
+		assert(lod.index_count < previous_count);
+		assert(lod.index_count <= (size_t) ((float) grid_index_count * ratios[i]));
+
+		const Uint16 *lod_indices = (const Uint16*) primitive.indices + lod.index_offset;
+		for (size_t j = 0; j < lod.index_count; j++)
+		{
+			assert(lod_indices[j] < primitive.vertex_count);
+		}
+
+		offset += lod.index_count;
+		previous_count = lod.index_count;
+	}
+
+	assert(mesh_primitive_stored_index_count(&primitive) == offset);
+
+	// Levels past the last one use the last one
+	const mesh_lod_t coarsest = mesh_primitive_lod(&primitive, mesh_max_lods);
+	assert(coarsest.index_offset + coarsest.index_count == offset);
+
+	SDL_free(primitive.vertices);
+	SDL_free(primitive.indices);
+}
+
+static void test_mesh_lod_select()
+{
+	const mesh_primitive_t primitive = {
+		.index_count = 1200,
+		.lods = {
+			{.index_offset = 1200, .index_count = 600},
+			{.index_offset = 1800, .index_count = 300},
+		},
+		.lod_count = 2,
+	};
+
+	assert(mesh_primitive_select_lod(&primitive, 1.F) == 0);
+	assert(mesh_primitive_select_lod(&primitive, mesh_lod_detail_size) == 0);
+	assert(mesh_primitive_select_lod(&primitive, mesh_lod_detail_size * 0.6F) == 1);
+	assert(mesh_primitive_select_lod(&primitive, mesh_lod_detail_size * 0.5F) == 2);
+	assert(mesh_primitive_select_lod(&primitive, 0.F) == 2);
+
+	// Small changes are ignored
+	assert(mesh_lod_screen_size(0.F, 0.2F) == 0.2F);
+	assert(mesh_lod_screen_size(0.2F, 0.21F) == 0.2F);
+	assert(mesh_lod_screen_size(0.2F, 0.19F) == 0.2F);
+	assert(mesh_lod_screen_size(0.2F, 0.3F) == 0.3F);
+	assert(mesh_lod_screen_size(0.2F, 0.1F) == 0.1F);
+}
+
+static void test_mesh_screen_size()
+{
+	mesh_primitive_t primitive = {
+		.bounds_min = {-1.F, -1.F, -1.F},
+		.bounds_max = {1.F, 1.F, 1.F},
+	};
+
+	const model_mesh_t mesh = {
+		.primitives = &primitive,
+		.primitive_count = 1,
+	};
+
+	// 90 degrees vertically, so the screen is as high as the distance, times two
+	const matrix4x4_t projection = matrix4x4_create_perspective(SDL_PI_F * 0.5F, 1.F, 0.1F, 100.F);
+	const float radius = SDL_sqrtf(3.F);
+
+	const matrix4x4_t near = matrix4x4_multiply(
+		matrix4x4_create_translation((vector3f_t){0.F, 0.F, -10.F}), projection);
+	assert(SDL_fabsf(mesh_screen_size(&mesh, &near) - (radius / 10.F)) < 0.0001F);
+
+	const matrix4x4_t far = matrix4x4_multiply(
+		matrix4x4_create_translation((vector3f_t){0.F, 0.F, -20.F}), projection);
+	assert(SDL_fabsf(mesh_screen_size(&mesh, &far) - (radius / 20.F)) < 0.0001F);
+
+	// Scaling the model scales its size on screen
+	const matrix4x4_t scaled = matrix4x4_multiply(
+		matrix4x4_create_scale((vector3f_t){2.F, 2.F, 2.F}), far);
+	assert(SDL_fabsf(mesh_screen_size(&mesh, &scaled) - (radius / 10.F)) < 0.0001F);
+
+	// Behind the camera
+	const matrix4x4_t behind = matrix4x4_multiply(
+		matrix4x4_create_translation((vector3f_t){0.F, 0.F, 10.F}), projection);
+	assert(mesh_screen_size(&mesh, &behind) == 1.F);
+}
+
+void test_mesh_lod()
+{
+	test_mesh_simplify_plane();
+	test_mesh_simplify_error();
+	test_mesh_primitive_generate_lods();
+	test_mesh_lod_select();
+	test_mesh_screen_size();
+}
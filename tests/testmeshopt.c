@@ -0,0 +1,181 @@
+#include "tests.h"
+
+#include "chirp/meshopt.h"
+#include "chirp/modelinfo.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+/**
+ * Sum of positions of all triangles, with each corner weighted differently,
+ * stays the same as long as triangles keep their winding
+ */
+static vector3f_t triangle_checksum(const primitive_vertex_t *vertices, const Uint32 *indices,
+	const size_t index_count)
+{
+	vector3f_t checksum = {};
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		const vector3f_t p0 = vertices[indices[i + 0]].position;
+		const vector3f_t p1 = vertices[indices[i + 1]].position;
+		const vector3f_t p2 = vertices[indices[i + 2]].position;
+
+		// Rotating the corners of a triangle keeps the winding, so only the cross product is used
+		checksum.x += ((p1.x - p0.x) * (p2.y - p0.y)) - ((p1.y - p0.y) * (p2.x - p0.x));
+		checksum.y += p0.x + p1.x + p2.x;
+		checksum.z += p0.y + p1.y + p2.y;
+	}
+
+	return checksum;
+}
+
+static void test_mesh_optimize_vertex_cache()
+{
+	primitive_vertex_t vertices[grid_vertex_count];
+	Uint32 indices[grid_index_count];
+	create_test_grid(vertices, indices, 0.F, true);
+
+	const vector3f_t checksum = triangle_checksum(vertices, indices, grid_index_count);
+	const mesh_cache_stats_t before = mesh_analyze_vertex_cache(indices, grid_index_count,
+		grid_vertex_count, mesh_cache_size);
+
+	// Random order is close to the worst case
+	assert(before.acmr > 2.F);
+	assert(before.atvr > 4.F);
+
+	const bool optimized = mesh_optimize_vertex_cache(indices, grid_index_count,
+		grid_vertex_count, mesh_cache_size);
+	assert(optimized);
+
+	const mesh_cache_stats_t after = mesh_analyze_vertex_cache(indices, grid_index_count,
+		grid_vertex_count, mesh_cache_size);
+
+	assert(after.acmr < 0.8F);
+	assert(after.atvr < 1.6F);
+
+	const vector3f_t result = triangle_checksum(vertices, indices, grid_index_count);
+	assert(result.x == checksum.x);
+	assert(result.y == checksum.y);
+	assert(result.z == checksum.z);
+}
+
+static void test_mesh_optimize_overdraw()
+{
+	primitive_vertex_t vertices[grid_vertex_count];
+	Uint32 indices[grid_index_count];
+	create_test_grid(vertices, indices, 0.F, true);
+
+	const vector3f_t checksum = triangle_checksum(vertices, indices, grid_index_count);
+
+	const bool cache_optimized = mesh_optimize_vertex_cache(indices, grid_index_count,
+		grid_vertex_count, mesh_cache_size);
+	assert(cache_optimized);
+
+	const mesh_cache_stats_t before = mesh_analyze_vertex_cache(indices, grid_index_count,
+		grid_vertex_count, mesh_cache_size);
+
+	const bool overdraw_optimized = mesh_optimize_overdraw(indices, grid_index_count,
+		vertices, grid_vertex_count, mesh_cache_size, 1.05F);
+	assert(overdraw_optimized);
+
+	const mesh_cache_stats_t after = mesh_analyze_vertex_cache(indices, grid_index_count,
+		grid_vertex_count, mesh_cache_size);
+
+	// Clusters are only split where the cache isn't affected much
+	assert(after.acmr <= before.acmr * 1.1F);
+
+	const vector3f_t result = triangle_checksum(vertices, indices, grid_index_count);
+	assert(result.x == checksum.x);
+	assert(result.y == checksum.y);
+	assert(result.z == checksum.z);
+}
+
+static void test_mesh_optimize_vertex_fetch()
+{
+	primitive_vertex_t vertices[grid_vertex_count];
+	Uint32 indices[grid_index_count];
+	create_test_grid(vertices, indices, 0.F, true);
+
+	const vector3f_t checksum = triangle_checksum(vertices, indices, grid_index_count);
+
+	primitive_vertex_t result[grid_vertex_count];
+	size_t used_count = 0;
+
+	const bool optimized = mesh_optimize_vertex_fetch(result, vertices, grid_vertex_count,
+		indices, grid_index_count, &used_count);
+	assert(optimized);
+
+	assert(used_count == grid_vertex_count);
+
+	// Each index is either one that was already used, or the next one
+	Uint32 next = 0;
+	for (size_t i = 0; i < grid_index_count; i++)
+	{
+		assert(indices[i] <= next);
+		if (indices[i] == next)
+		{
+			next++;
+		}
+	}
+
+	const vector3f_t fetch_checksum = triangle_checksum(result, indices, grid_index_count);
+	assert(fetch_checksum.x == checksum.x);
+	assert(fetch_checksum.y == checksum.y);
+	assert(fetch_checksum.z == checksum.z);
+}
+
+static void test_mesh_primitive_optimize()
+{
+	// Two triangles, with an unused vertex in between
+	const primitive_vertex_t vertices[] = {
+		{.position = {0.F, 0.F, 0.F}},
+		{.position = {5.F, 5.F, 5.F}},
+		{.position = {1.F, 0.F, 0.F}},
+		{.position = {0.F, 1.F, 0.F}},
+		{.position = {1.F, 1.F, 0.F}},
+	};
+	const Uint16 indices[] = {3, 2, 4, 0, 2, 3};
+
+	mesh_primitive_t primitive = {
+		.vertices = SDL_malloc(sizeof(vertices)),
+		.vertex_count = SDL_arraysize(vertices),
+		.indices = SDL_malloc(sizeof(indices)),
+		.index_count = SDL_arraysize(indices),
+		.index_size = sizeof(Uint16),
+	};
+
+	SDL_memcpy(primitive.vertices, vertices, sizeof(vertices));
+	SDL_memcpy(primitive.indices, indices, sizeof(indices));
+
+	const bool optimized = mesh_primitive_optimize(&primitive);
+	assert(optimized);
+
+	assert(primitive.vertex_count == 4);
+	assert(primitive.index_count == 6);
+	assert(primitive.index_size == sizeof(Uint16));
+
+	for (size_t i = 0; i < primitive.vertex_count; i++)
+	{
+		assert(primitive.vertices[i].position.z == 0.F);
+	}
+
+	const Uint16 *result = primitive.indices;
+	for (size_t i = 0; i < primitive.index_count; i++)
+	{
+		assert(result[i] < primitive.vertex_count);
+	}
+
+	SDL_free(primitive.vertices);
+	SDL_free(primitive.indices);
+}
+
+void test_mesh_optimize()
+{
+	test_mesh_optimize_vertex_cache();
+	test_mesh_optimize_overdraw();
+	test_mesh_optimize_vertex_fetch();
+	test_mesh_primitive_optimize();
+}
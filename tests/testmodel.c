@@ -0,0 +1,236 @@
+#include "tests.h"
+
+#include "chirp/modelinfo.h"
+#include "chirp/threadpool.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+/*
+ * A single triangle, with position, normal and texture coordinates interleaved in one buffer view,
+ * the second primitive uses a sparse accessor, which has to be unpacked by cgltf,
+ * the third one 32-bit indices, which fit in 16 bits,
+ * and the fourth one normalized 16-bit positions, from KHR_mesh_quantization
+ *
+ * Vertex i has position (i, 10 + i, 20 + i), normal (30 + i, 40 + i, 50 + i)
+ * and texture coordinates (60 + i, 70 + i), the sparse accessor is all zeros, except (7, 8, 9),
+ * 16-bit indices are 0, 1, 2 and 32-bit indices 2, 1, 0,
+ * quantized positions are (1, 0, 0), (0, 1, 0) and (0, 0, -1)
+ *
+ * Both nodes use the same mesh, with different transforms
+ */
+static const char gltf[] =
+	"{"
+	"\"asset\": {\"version\": \"2.0\"},"
+	"\"extensionsUsed\": [\"KHR_mesh_quantization\"],"
+	"\"extensionsRequired\": [\"KHR_mesh_quantization\"],"
+	"\"buffers\": [{\"byteLength\": 156, \"uri\": \"data:application/octet-stream;base64,"
+	"AAAAAAAAIEEAAKBBAADwQQAAIEIAAEhCAABwQgAAjEIAAIA/AAAwQQAAqEEAAPhBAAAkQgAATEIAAHRCAACOQgAAAEAAAEBB"
+	"AACwQQAAAEIAAChCAABQQgAAeEIAAJBCAAABAAIAAAABAAAAAADgQAAAAEEAABBBAgAAAAEAAAAAAAAA/38AAAAAAAAAAP9/"
+	"AAAAAAAAAAABgAAA\"}],"
+	"\"bufferViews\": ["
+	"{\"buffer\": 0, \"byteOffset\": 0, \"byteLength\": 96, \"byteStride\": 32},"
+	"{\"buffer\": 0, \"byteOffset\": 96, \"byteLength\": 6},"
+	"{\"buffer\": 0, \"byteOffset\": 104, \"byteLength\": 2},"
+	"{\"buffer\": 0, \"byteOffset\": 108, \"byteLength\": 12},"
+	"{\"buffer\": 0, \"byteOffset\": 120, \"byteLength\": 12},"
+	"{\"buffer\": 0, \"byteOffset\": 132, \"byteLength\": 24, \"byteStride\": 8}"
+	"],"
+	"\"accessors\": ["
+	"{\"bufferView\": 0, \"byteOffset\": 0, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\"},"
+	"{\"bufferView\": 0, \"byteOffset\": 12, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\"},"
+	"{\"bufferView\": 0, \"byteOffset\": 24, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC2\"},"
+	"{\"bufferView\": 1, \"componentType\": 5123, \"count\": 3, \"type\": \"SCALAR\"},"
+	"{\"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\", \"sparse\": {\"count\": 1,"
+	"\"indices\": {\"bufferView\": 2, \"componentType\": 5123}, \"values\": {\"bufferView\": 3}}},"
+	"{\"bufferView\": 4, \"componentType\": 5125, \"count\": 3, \"type\": \"SCALAR\"},"
+	"{\"bufferView\": 5, \"componentType\": 5122, \"normalized\": true, \"count\": 3, \"type\": \"VEC3\"}"
+	"],"
+	"\"materials\": [{\"name\": \"white\", \"pbrMetallicRoughness\": {\"baseColorFactor\": [1.0, 0.5, 0.25, 1.0]}}],"
+	"\"meshes\": [{\"primitives\": ["
+	"{\"attributes\": {\"POSITION\": 0, \"NORMAL\": 1, \"TEXCOORD_0\": 2}, \"indices\": 3, \"material\": 0},"
+	"{\"attributes\": {\"POSITION\": 4, \"NORMAL\": 1}, \"indices\": 3, \"material\": 0},"
+	"{\"attributes\": {\"POSITION\": 0}, \"indices\": 5, \"material\": 0},"
+	"{\"attributes\": {\"POSITION\": 6}, \"indices\": 3, \"material\": 0}"
+	"]}],"
+	"\"nodes\": [{\"name\": \"triangle\", \"mesh\": 0},"
+	"{\"name\": \"copy\", \"mesh\": 0, \"translation\": [5.0, 0.0, 0.0]}]"
+	"}";
+
+/*
+ * A single triangle with 32-bit indices 0, 1 and 65537, which is out of range,
+ * but would be 1 if narrowed to 16 bits
+ */
+static const char gltf_index_range[] =
+	"{"
+	"\"asset\": {\"version\": \"2.0\"},"
+	"\"buffers\": [{\"byteLength\": 48, \"uri\": \"data:application/octet-stream;base64,"
+	"AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAgD8AAAAAAAAAAAEAAAABAAEA\"}],"
+	"\"bufferViews\": ["
+	"{\"buffer\": 0, \"byteOffset\": 0, \"byteLength\": 36},"
+	"{\"buffer\": 0, \"byteOffset\": 36, \"byteLength\": 12}"
+	"],"
+	"\"accessors\": ["
+	"{\"bufferView\": 0, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\"},"
+	"{\"bufferView\": 1, \"componentType\": 5125, \"count\": 3, \"type\": \"SCALAR\"}"
+	"],"
+	"\"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0}, \"indices\": 1}]}],"
+	"\"nodes\": [{\"mesh\": 0}]"
+	"}";
+
+static void test_model_interleaved(const mesh_primitive_t *primitive)
+{
+	assert(primitive->vertex_count == 3);
+	assert(primitive->index_count == 3);
+	assert(primitive->index_size == sizeof(Uint16));
+
+	assert(primitive->color.x == 1.F);
+	assert(primitive->color.y == 0.5F);
+	assert(primitive->color.z == 0.25F);
+	assert(primitive->color.w == 1.F);
+
+	assert(primitive->bounds_min.x == 0.F);
+	assert(primitive->bounds_min.y == 10.F);
+	assert(primitive->bounds_min.z == 20.F);
+
+	assert(primitive->bounds_max.x == 2.F);
+	assert(primitive->bounds_max.y == 12.F);
+	assert(primitive->bounds_max.z == 22.F);
+
+	for (size_t i = 0; i < primitive->vertex_count; i++)
+	{
+		const primitive_vertex_t *vertex = primitive->vertices + i;
+		const float offset = (float) i;
+
+		assert(vertex->position.x == offset);
+		assert(vertex->position.y == 10.F + offset);
+		assert(vertex->position.z == 20.F + offset);
+
+		assert(vertex->normal.x == 30.F + offset);
+		assert(vertex->normal.y == 40.F + offset);
+		assert(vertex->normal.z == 50.F + offset);
+
+		assert(vertex->tex_coord.x == 60.F + offset);
+		assert(vertex->tex_coord.y == 70.F + offset);
+
+		assert(((const Uint16*) primitive->indices)[i] == i);
+	}
+}
+
+static void test_model_sparse(const mesh_primitive_t *primitive)
+{
+	assert(primitive->vertex_count == 3);
+
+	assert(primitive->vertices[0].position.x == 0.F);
+	assert(primitive->vertices[0].position.y == 0.F);
+	assert(primitive->vertices[0].position.z == 0.F);
+
+	assert(primitive->vertices[1].position.x == 7.F);
+	assert(primitive->vertices[1].position.y == 8.F);
+	assert(primitive->vertices[1].position.z == 9.F);
+
+	assert(primitive->vertices[2].position.x == 0.F);
+
+	assert(primitive->vertices[1].normal.z == 51.F);
+
+	// No texture coordinates, so left zeroed
+	assert(primitive->vertices[1].tex_coord.x == 0.F);
+}
+
+static void test_model_narrow_indices(const mesh_primitive_t *primitive)
+{
+	assert(primitive->index_count == 3);
+	assert(primitive->index_size == sizeof(Uint16));
+
+	// Vertices are reordered to the order they're used in
+	const Uint16 *indices = primitive->indices;
+	assert(indices[0] == 0);
+	assert(indices[1] == 1);
+	assert(indices[2] == 2);
+
+	assert(primitive->vertices[0].position.x == 2.F);
+	assert(primitive->vertices[2].position.x == 0.F);
+}
+
+static void test_model_quantized(const mesh_primitive_t *primitive)
+{
+	assert(primitive->vertex_count == 3);
+
+	assert(primitive->vertices[0].position.x == 1.F);
+	assert(primitive->vertices[1].position.y == 1.F);
+	assert(primitive->vertices[2].position.z == -1.F);
+
+	assert(primitive->bounds_min.z == -1.F);
+	assert(primitive->bounds_max.x == 1.F);
+}
+
+static void test_index_size()
+{
+	assert(mesh_primitive_index_size(0) == sizeof(Uint16));
+	assert(mesh_primitive_index_size(65'536) == sizeof(Uint16));
+	assert(mesh_primitive_index_size(65'537) == sizeof(Uint32));
+}
+
+static void test_index_range()
+{
+	model_info_t model;
+	const bool loaded = model_info_create_mem(nullptr, gltf_index_range, sizeof(gltf_index_range) - 1, &model);
+	assert(!loaded);
+
+	// Whatever was loaded before failing
+	model_info_destroy(&model);
+}
+
+static void test_model_nodes(const model_info_t *model)
+{
+	assert(model->node_count == 2);
+	assert(SDL_strcmp(model_node_name(model, 0), "triangle") == 0);
+	assert(SDL_strcmp(model_node_name(model, 1), "copy") == 0);
+
+	// Decoded once, and shared by both nodes
+	assert(model->mesh_count == 1);
+	assert(model->nodes[0].mesh == model->meshes);
+	assert(model->nodes[1].mesh == model->meshes);
+	assert(model_node_translation(model, 1).x == 5.F);
+
+	const model_mesh_t *mesh = model->meshes;
+	assert(mesh->primitive_count == 4);
+
+	test_model_interleaved(mesh->primitives);
+	test_model_sparse(mesh->primitives + 1);
+	test_model_narrow_indices(mesh->primitives + 2);
+	test_model_quantized(mesh->primitives + 3);
+}
+
+static void test_model_parallel()
+{
+	thread_pool_t *pool = thread_pool_create("test", 2);
+	assert(pool != nullptr);
+
+	// Small enough to otherwise always be decoded serially
+	model_info_set_thread_pool(pool, 0);
+
+	model_info_t model;
+	const bool loaded = model_info_create_mem(nullptr, gltf, sizeof(gltf) - 1, &model);
+	assert(loaded);
+	test_model_nodes(&model);
+	model_info_destroy(&model);
+
+	model_info_set_thread_pool(nullptr, model_parallel_min_vertices);
+	thread_pool_destroy(pool);
+}
+
+void test_model()
+{
+	model_info_t model;
+	const bool loaded = model_info_create_mem(nullptr, gltf, sizeof(gltf) - 1, &model);
+	assert(loaded);
+	test_model_nodes(&model);
+	model_info_destroy(&model);
+
+	test_model_parallel();
+	test_index_size();
+	test_index_range();
+}
@@ -0,0 +1,173 @@
+#include "tests.h"
+
+#include "chirp/filereader.h"
+#include "chirp/readbatch.h"
+
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_hints.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+static const char *test_path = "test_read_batch.bin";
+
+static constexpr size_t file_size = 256 * 1024;
+
+// More than fit in the queue at once, so some are started as others finish
+static constexpr size_t request_count = 100;
+
+[[nodiscard]]
+static Uint8 file_byte(const size_t offset)
+{
+	return (Uint8) ((offset * 7) + (offset >> 8));
+}
+
+static void write_file()
+{
+	Uint8 *data = SDL_malloc(file_size);
+	assert(data != nullptr);
+
+	for (size_t i = 0; i < file_size; i++)
+	{
+		data[i] = file_byte(i);
+	}
+
+	const bool saved = SDL_SaveFile(test_path, data, file_size);
+	assert(saved);
+
+	SDL_free(data);
+}
+
+static void read_all(const file_reader_t *reader)
+{
+	read_request_t requests[request_count];
+	bool finished[request_count];
+
+	Uint8 *data = SDL_malloc(file_size);
+	assert(data != nullptr);
+
+	// Different sizes, in no particular order, the last one reads up to the end of the file
+	const size_t request_size = file_size / request_count;
+	for (size_t i = 0; i < request_count; i++)
+	{
+		const size_t slot = (i * 37) % request_count;
+		const size_t size = slot == request_count - 1
+			? file_size - (slot * request_size)
+			: request_size - (i % 3);
+
+		requests[i] = (read_request_t){
+			.dst = data + (slot * request_size),
+			.size = size,
+			.offset = slot * request_size,
+		};
+		finished[i] = false;
+	}
+
+	read_batch_t *batch = read_batch_submit(reader, requests, request_count);
+	assert(batch != nullptr);
+
+	size_t finished_count = 0;
+	const read_request_t *request = nullptr;
+
+	while (true)
+	{
+		const bool waited = read_batch_wait(batch, &request);
+		assert(waited);
+
+		if (request == nullptr)
+		{
+			break;
+		}
+
+		// Each request finishes once, and only once it's read entirely
+		const size_t index = (size_t) (request - requests);
+		assert(index < request_count);
+		assert(!finished[index]);
+		finished[index] = true;
+		finished_count++;
+
+		const Uint8 *dst = request->dst;
+		for (size_t i = 0; i < request->size; i++)
+		{
+			assert(dst[i] == file_byte(request->offset + i));
+		}
+	}
+
+	assert(finished_count == request_count);
+	read_batch_destroy(batch);
+
+	SDL_free(data);
+}
+
+static void read_past_end(const file_reader_t *reader)
+{
+	Uint8 data[64];
+	const read_request_t requests[] = {
+		{.dst = data, .size = 32, .offset = 0},
+		{.dst = data + 32, .size = 32, .offset = file_size - 16},
+	};
+
+	read_batch_t *batch = read_batch_submit(reader, requests, SDL_arraysize(requests));
+	assert(batch != nullptr);
+
+	// The request that can't be read entirely fails the batch, whenever it finishes
+	bool waited = true;
+	const read_request_t *request = nullptr;
+
+	for (size_t i = 0; i < SDL_arraysize(requests) && waited; i++)
+	{
+		waited = read_batch_wait(batch, &request);
+	}
+
+	assert(!waited);
+
+	// Stays failed
+	waited = read_batch_wait(batch, &request);
+	assert(!waited);
+	assert(request == nullptr);
+
+	read_batch_destroy(batch);
+}
+
+static void read_empty(const file_reader_t *reader)
+{
+	read_batch_t *batch = read_batch_submit(reader, nullptr, 0);
+	assert(batch != nullptr);
+
+	const read_request_t *request = nullptr;
+	const bool waited = read_batch_wait(batch, &request);
+	assert(waited);
+	assert(request == nullptr);
+
+	read_batch_destroy(batch);
+}
+
+static void run_reads(const file_reader_t *reader)
+{
+	read_all(reader);
+	read_past_end(reader);
+	read_empty(reader);
+}
+
+void test_read_batch()
+{
+	write_file();
+
+	file_reader_t reader;
+	const bool opened = file_reader_open(test_path, &reader);
+	assert(opened);
+
+	// Using io_uring where available
+	run_reads(&reader);
+
+	// One positional read at a time
+	const bool hint_set = SDL_SetHint(READ_BATCH_HINT_IO_URING, "0");
+	assert(hint_set);
+	run_reads(&reader);
+	SDL_ResetHint(READ_BATCH_HINT_IO_URING);
+
+	file_reader_close(&reader);
+	SDL_RemovePath(test_path);
+}
@@ -1,3 +1,39 @@
 #pragma once
 
+#include "chirp/modelinfo.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
 void test_array();
+
+void test_compress();
+
+void test_asset_cache();
+
+void test_block_cache();
+
+void test_json();
+
+void test_model();
+
+void test_mesh_optimize();
+
+void test_vertex_format();
+
+void test_mesh_lod();
+
+void test_mesh_clusters();
+
+void test_read_batch();
+
+static constexpr size_t grid_size = 32;
+static constexpr size_t grid_vertex_count = (grid_size + 1) * (grid_size + 1);
+static constexpr size_t grid_index_count = grid_size * grid_size * 6;
+
+/**
+ * Grid of quads facing +z, bent into a bowl by curvature, so simplifying it has an error,
+ * optionally with triangles and vertices in random order, similar to what exporters sometimes write
+ */
+void create_test_grid(primitive_vertex_t *vertices, Uint32 *indices, float curvature, bool shuffle);
@@ -0,0 +1,104 @@
+#include "tests.h"
+
+#include "chirp/matrix.h"
+#include "chirp/modelinfo.h"
+#include "chirp/vector.h"
+#include "chirp/vertexformat.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+static void test_half()
+{
+	const float exact[] = {0.F, 1.F, -2.5F, 0.125F, 1024.F, 65504.F};
+	for (size_t i = 0; i < SDL_arraysize(exact); i++)
+	{
+		assert(vertex_half_to_float(vertex_half_from_float(exact[i])) == exact[i]);
+	}
+
+	// Halfway between 1 and the next half, rounded to even
+	assert(vertex_half_from_float(1.F + SDL_scalbnf(1.F, -11)) == 0x3c00);
+
+	// Smallest denormal
+	assert(vertex_half_from_float(SDL_scalbnf(1.F, -24)) == 0x0001);
+	assert(vertex_half_to_float(0x0001) == SDL_scalbnf(1.F, -24));
+
+	assert(vertex_half_from_float(SDL_scalbnf(1.F, -26)) == 0x0000);
+	assert(vertex_half_from_float(100'000.F) == 0x7c00);
+	assert(vertex_half_from_float(-100'000.F) == 0xfc00);
+}
+
+static void test_quantized()
+{
+	const primitive_vertex_t vertices[] = {
+		{
+			.position = {-4.F, 10.F, 3.F},
+			.normal = {0.F, 0.F, -1.F},
+			.tex_coord = {0.F, 1.F},
+		},
+		{
+			.position = {6.F, 12.F, 3.F},
+			.normal = {0.F, 1.F, 0.F},
+			.tex_coord = {4.5F, -2.F},
+		},
+		{
+			.position = {1.F, 11.F, 3.F},
+			.normal = {0.6F, 0.F, -0.8F},
+			.tex_coord = {0.25F, 0.75F},
+		},
+	};
+
+	mesh_primitive_t primitive = {
+		.vertices = (primitive_vertex_t*) vertices,
+		.vertex_count = SDL_arraysize(vertices),
+	};
+	mesh_primitive_update_bounds(&primitive);
+
+	quantized_vertex_t quantized[SDL_arraysize(vertices)];
+	assert(vertex_format_size(VERTEX_FORMAT_QUANTIZED) == sizeof(quantized_vertex_t));
+	vertex_format_encode(VERTEX_FORMAT_QUANTIZED, &primitive, vertices, quantized);
+
+	const matrix4x4_t dequantize = vertex_format_dequantize(VERTEX_FORMAT_QUANTIZED, &primitive);
+
+	for (size_t i = 0; i < SDL_arraysize(vertices); i++)
+	{
+		const quantized_vertex_t *vertex = quantized + i;
+
+		// Same as the vertex fetch does with signed normalized values
+		const float x = (float) vertex->position[0] / (float) SDL_MAX_SINT16;
+		const float y = (float) vertex->position[1] / (float) SDL_MAX_SINT16;
+		const float z = (float) vertex->position[2] / (float) SDL_MAX_SINT16;
+
+		const vector3f_t position = {
+			.x = (x * dequantize.m[0]) + dequantize.m[12],
+			.y = (y * dequantize.m[5]) + dequantize.m[13],
+			.z = (z * dequantize.m[10]) + dequantize.m[14],
+		};
+
+		assert(SDL_fabsf(position.x - vertices[i].position.x) < 0.001F);
+		assert(SDL_fabsf(position.y - vertices[i].position.y) < 0.001F);
+		assert(position.z == vertices[i].position.z);
+
+		const vector3f_t normal = {
+			.x = (float) vertex->normal[0] / (float) SDL_MAX_SINT16,
+			.y = (float) vertex->normal[1] / (float) SDL_MAX_SINT16,
+			.z = (float) vertex->normal[2] / (float) SDL_MAX_SINT16,
+		};
+		assert(vector3f_dot(normal, vertices[i].normal) > 0.9999F);
+
+		assert(vertex_half_to_float(vertex->tex_coord[0]) == vertices[i].tex_coord.x);
+		assert(vertex_half_to_float(vertex->tex_coord[1]) == vertices[i].tex_coord.y);
+	}
+
+	// Extremes of the bounds map to the full range
+	assert(quantized[0].position[0] == -SDL_MAX_SINT16);
+	assert(quantized[1].position[0] == SDL_MAX_SINT16);
+}
+
+void test_vertex_format()
+{
+	test_half();
+	test_quantized();
+}
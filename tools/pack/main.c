@@ -0,0 +1,263 @@
+#include "manifest.h"
+#include "nestwriter.h"
+#include "packlist.h"
+
+#include "chirp/modelinfo.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct pack_args
+{
+	const char *project_dir;
+	const char *output;
+	const char *trace;
+	bool cook;
+	nest_options_t options;
+} pack_args_t;
+
+static void print_usage()
+{
+	SDL_Log("Usage: chirp-pack [options] <project directory> <output file>");
+	SDL_Log("  --trace <file>       Order assets by a trace recorded with --asset-trace");
+	SDL_Log("  --align <bytes>      Align each asset, power of two up to 65536, default 16");
+	SDL_Log("  --compress           Compress assets that get smaller");
+	SDL_Log("  --resident <bytes>   Keep assets up to this size in memory once loaded, default 16384");
+	SDL_Log("  --group-resident     Store resident assets first, for archives that aren't memory mapped");
+	SDL_Log("  --cook               Convert models ahead of time, so no glTF is parsed when loading");
+	SDL_Log("  --lods <ratios>      Triangle ratios of levels of detail when cooking, or none, default 0.5,0.25,0.125");
+	SDL_Log("  --verbose            Log each asset");
+}
+
+[[nodiscard]]
+static bool parse_alignment(const char *value, Uint8 *alignment_log2)
+{
+	const long alignment = SDL_strtol(value, nullptr, 10);
+
+	for (Uint8 i = 0; i <= 16; i++)
+	{
+		if (alignment == 1L << i)
+		{
+			*alignment_log2 = i;
+			return true;
+		}
+	}
+
+	return SDL_SetError("Invalid alignment: %s", value);
+}
+
+[[nodiscard]]
+static bool parse_lod_ratios(const char *value)
+{
+	if (SDL_strcmp(value, "none") == 0)
+	{
+		return model_info_set_lod_ratios(nullptr, 0);
+	}
+
+	float ratios[mesh_max_lods];
+	size_t count = 0;
+
+	const char *current = value;
+	while (true)
+	{
+		if (count >= mesh_max_lods)
+		{
+			return SDL_SetError("Too many levels of detail: %s", value);
+		}
+
+		char *end = nullptr;
+		ratios[count++] = (float) SDL_strtod(current, &end);
+
+		if (end == current || (*end != ',' && *end != '\0'))
+		{
+			return SDL_SetError("Invalid level of detail ratios: %s", value);
+		}
+
+		if (*end == '\0')
+		{
+			break;
+		}
+
+		current = end + 1;
+	}
+
+	return model_info_set_lod_ratios(ratios, count);
+}
+
+[[nodiscard]]
+static bool parse_args(const int argc, char **argv, pack_args_t *args)
+{
+	*args = (pack_args_t){
+		.options = (nest_options_t){
+			.alignment_log2 = 4,
+			.compress = false,
+			.resident_size = 16 * 1024,
+			.group_resident = false,
+		},
+	};
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char *arg = argv[i];
+
+		if (SDL_strcmp(arg, "--trace") == 0 && i + 1 < argc)
+		{
+			args->trace = argv[++i];
+		}
+		else if (SDL_strcmp(arg, "--align") == 0 && i + 1 < argc)
+		{
+			if (!parse_alignment(argv[++i], &args->options.alignment_log2))
+			{
+				return false;
+			}
+		}
+		else if (SDL_strcmp(arg, "--resident") == 0 && i + 1 < argc)
+		{
+			args->options.resident_size = SDL_strtoull(argv[++i], nullptr, 10);
+		}
+		else if (SDL_strcmp(arg, "--group-resident") == 0)
+		{
+			args->options.group_resident = true;
+		}
+		else if (SDL_strcmp(arg, "--compress") == 0)
+		{
+			args->options.compress = true;
+		}
+		else if (SDL_strcmp(arg, "--cook") == 0)
+		{
+			args->cook = true;
+		}
+		else if (SDL_strcmp(arg, "--lods") == 0 && i + 1 < argc)
+		{
+			if (!parse_lod_ratios(argv[++i]))
+			{
+				return false;
+			}
+		}
+		else if (SDL_strcmp(arg, "--verbose") == 0)
+		{
+			SDL_SetLogPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_DEBUG);
+		}
+		else if (arg[0] == '-')
+		{
+			return SDL_SetError("Unknown option: %s", arg);
+		}
+		else if (args->project_dir == nullptr)
+		{
+			args->project_dir = arg;
+		}
+		else if (args->output == nullptr)
+		{
+			args->output = arg;
+		}
+		else
+		{
+			return SDL_SetError("Unexpected argument: %s", arg);
+		}
+	}
+
+	if (args->project_dir == nullptr || args->output == nullptr)
+	{
+		return SDL_SetError("Missing project directory or output file");
+	}
+
+	return true;
+}
+
+[[nodiscard]]
+static bool load_manifest(const char *project_dir, manifest_t *manifest)
+{
+	char *path = nullptr;
+	if (SDL_asprintf(&path, "%s/project.toml", project_dir) < 0)
+	{
+		return false;
+	}
+
+	size_t size = 0;
+	char *text = SDL_LoadFile(path, &size);
+	SDL_free(path);
+
+	if (text == nullptr)
+	{
+		return false;
+	}
+
+	const bool result = manifest_create(text, size, manifest);
+	SDL_free(text);
+
+	return result;
+}
+
+[[nodiscard]]
+static bool apply_trace(const char *path, pack_list_t *list)
+{
+	size_t size = 0;
+	char *trace = SDL_LoadFile(path, &size);
+	if (trace == nullptr)
+	{
+		return false;
+	}
+
+	const bool result = pack_list_apply_trace(list, trace, size);
+	SDL_free(trace);
+
+	return result;
+}
+
+[[nodiscard]]
+static bool pack(const pack_args_t *args)
+{
+	manifest_t manifest;
+	if (!load_manifest(args->project_dir, &manifest))
+	{
+		return false;
+	}
+
+	pack_list_t list;
+	if (!pack_list_create(args->project_dir, &manifest, args->cook, &list))
+	{
+		manifest_destroy(&manifest);
+		return false;
+	}
+
+	manifest_destroy(&manifest);
+
+	if (args->trace != nullptr && !apply_trace(args->trace, &list))
+	{
+		pack_list_destroy(&list);
+		return false;
+	}
+
+	const bool result = nest_write(args->output, &list, &args->options);
+	if (result)
+	{
+		SDL_Log("Packed %zu assets into %s", list.count, args->output);
+	}
+
+	pack_list_destroy(&list);
+	return result;
+}
+
+int main(const int argc, char **argv)
+{
+	pack_args_t args;
+	if (!parse_args(argc, argv, &args))
+	{
+		SDL_Log("%s", SDL_GetError());
+		print_usage();
+		return 1;
+	}
+
+	if (!pack(&args))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to pack %s: %s",
+			args.project_dir, SDL_GetError());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,327 @@
+#include "manifest.h"
+#include "toml.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct json_writer
+{
+	char *data;
+	size_t size;
+	size_t capacity;
+} json_writer_t;
+
+typedef struct key_mapping
+{
+	const char *toml;
+	const char *json;
+} key_mapping_t;
+
+static const key_mapping_t metadata_keys[] = {
+	{"name", "nam"},
+	{"version", "ver"},
+	{"identifier", "ide"},
+	{"creator", "cre"},
+	{"copyright", "cop"},
+	{"url", "url"},
+	{"type", "typ"},
+};
+
+static const key_mapping_t window_keys[] = {
+	{"title", "tit"},
+	{"size", "siz"},
+	{"fullscreen", "ful"},
+	{"icon", "ico"},
+};
+
+static const key_mapping_t input_keys[] = {
+	{"keycode", "key"},
+	{"mouse", "mou"},
+	{"axis", "axi"},
+	{"deadzone", "dea"},
+	{"gamepad", "gam"},
+};
+
+[[nodiscard]]
+static bool write_raw(json_writer_t *writer, const char *str, const size_t size)
+{
+	if (writer->size + size + 1 > writer->capacity)
+	{
+		const size_t capacity = SDL_max(writer->capacity * 2, writer->size + size + 1);
+		char *data = SDL_realloc(writer->data, capacity);
+		if (data == nullptr)
+		{
+			return false;
+		}
+
+		writer->data = data;
+		writer->capacity = capacity;
+	}
+
+	SDL_memcpy(writer->data + writer->size, str, size);
+	writer->size += size;
+	writer->data[writer->size] = '\0';
+
+	return true;
+}
+
+[[nodiscard]]
+static bool write_str(json_writer_t *writer, const char *str)
+{
+	return write_raw(writer, str, SDL_strlen(str));
+}
+
+[[nodiscard]]
+static bool write_string(json_writer_t *writer, const char *str)
+{
+	if (!write_str(writer, "\""))
+	{
+		return false;
+	}
+
+	for (const char *c = str; *c != '\0'; c++)
+	{
+		bool result;
+
+		switch (*c)
+		{
+			case '"':
+				result = write_str(writer, "\\\"");
+				break;
+
+			case '\\':
+				result = write_str(writer, "\\\\");
+				break;
+
+			case '\n':
+				result = write_str(writer, "\\n");
+				break;
+
+			case '\t':
+				result = write_str(writer, "\\t");
+				break;
+
+			default:
+				result = write_raw(writer, c, 1);
+				break;
+		}
+
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return write_str(writer, "\"");
+}
+
+[[nodiscard]]
+static bool write_value(json_writer_t *writer, const toml_value_t *value)
+{
+	switch (value->type)
+	{
+		case TOML_STRING:
+			return write_string(writer, value->text);
+
+		case TOML_NUMBER:
+		case TOML_BOOL:
+			return write_str(writer, value->text);
+
+		case TOML_ARRAY:
+			if (!write_str(writer, "["))
+			{
+				return false;
+			}
+			for (size_t i = 0; i < value->item_count; i++)
+			{
+				if ((i > 0 && !write_str(writer, ","))
+					|| !write_value(writer, value->items + i))
+				{
+					return false;
+				}
+			}
+			return write_str(writer, "]");
+
+		default:
+			return SDL_SetError("Unexpected table: %s", value->key);
+	}
+}
+
+[[nodiscard]]
+static const char *mapped_key(const key_mapping_t *mappings, const size_t count, const char *key)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		if (SDL_strcmp(mappings[i].toml, key) == 0)
+		{
+			return mappings[i].json;
+		}
+	}
+
+	return nullptr;
+}
+
+[[nodiscard]]
+static bool write_key(json_writer_t *writer, const bool first, const char *key)
+{
+	return (first || write_str(writer, ","))
+		&& write_string(writer, key)
+		&& write_str(writer, ":");
+}
+
+/**
+ * Write a table with keys renamed, unknown keys are errors as the engine can't read them
+ */
+[[nodiscard]]
+static bool write_table(json_writer_t *writer, const toml_value_t *table,
+	const key_mapping_t *mappings, const size_t mapping_count)
+{
+	if (!write_str(writer, "{"))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < table->item_count; i++)
+	{
+		const toml_value_t *value = table->items + i;
+
+		const char *key = mapped_key(mappings, mapping_count, value->key);
+		if (key == nullptr)
+		{
+			return SDL_SetError("Unknown key in [%s]: %s", table->key, value->key);
+		}
+
+		if (!write_key(writer, i == 0, key))
+		{
+			return false;
+		}
+
+		// Engine always expects a list of keycodes
+		const bool as_array = SDL_strcmp(key, "key") == 0 && value->type != TOML_ARRAY;
+
+		if ((as_array && !write_str(writer, "["))
+			|| !write_value(writer, value)
+			|| (as_array && !write_str(writer, "]")))
+		{
+			return false;
+		}
+	}
+
+	return write_str(writer, "}");
+}
+
+[[nodiscard]]
+static bool write_input(json_writer_t *writer, const toml_value_t *input)
+{
+	if (!write_str(writer, "{"))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < input->item_count; i++)
+	{
+		const toml_value_t *action = input->items + i;
+
+		if (action->type != TOML_TABLE)
+		{
+			return SDL_SetError("Input %s is not a table", action->key);
+		}
+
+		if (!write_key(writer, i == 0, action->key)
+			|| !write_table(writer, action, input_keys, SDL_arraysize(input_keys)))
+		{
+			return false;
+		}
+	}
+
+	return write_str(writer, "}");
+}
+
+[[nodiscard]]
+static bool write_project(json_writer_t *writer, const toml_value_t *root)
+{
+	const toml_value_t *metadata = toml_get(root, "metadata");
+	const toml_value_t *window = toml_get(root, "window");
+	const toml_value_t *input = toml_get(root, "input");
+
+	bool first = true;
+
+	if (!write_str(writer, "{"))
+	{
+		return false;
+	}
+
+	if (metadata != nullptr)
+	{
+		if (!write_key(writer, first, "met")
+			|| !write_table(writer, metadata, metadata_keys, SDL_arraysize(metadata_keys)))
+		{
+			return false;
+		}
+		first = false;
+	}
+
+	if (window != nullptr)
+	{
+		if (!write_key(writer, first, "win")
+			|| !write_table(writer, window, window_keys, SDL_arraysize(window_keys)))
+		{
+			return false;
+		}
+		first = false;
+	}
+
+	if (input != nullptr)
+	{
+		if (!write_key(writer, first, "inp")
+			|| !write_input(writer, input))
+		{
+			return false;
+		}
+	}
+
+	return write_str(writer, "}");
+}
+
+bool manifest_create(const char *text, const size_t size, manifest_t *manifest)
+{
+	*manifest = (manifest_t){};
+
+	if (!toml_parse(text, size, &manifest->root))
+	{
+		return false;
+	}
+
+	json_writer_t writer = {};
+
+	if (!write_project(&writer, &manifest->root))
+	{
+		SDL_free(writer.data);
+		toml_destroy(&manifest->root);
+		return false;
+	}
+
+	manifest->json = writer.data;
+	manifest->json_size = writer.size;
+
+	return true;
+}
+
+void manifest_destroy(const manifest_t *manifest)
+{
+	toml_destroy(&manifest->root);
+	SDL_free(manifest->json);
+}
+
+const toml_value_t *manifest_assets(const manifest_t *manifest, const char *type)
+{
+	const toml_value_t *assets = toml_get(toml_get(&manifest->root, "assets"), type);
+	if (assets == nullptr || assets->type != TOML_ARRAY)
+	{
+		return nullptr;
+	}
+
+	return assets;
+}
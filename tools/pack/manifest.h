@@ -0,0 +1,30 @@
+#pragma once
+
+#include "toml.h"
+
+#include <stddef.h>
+
+typedef struct manifest
+{
+	toml_value_t root;
+
+	// Compact JSON, as read by the engine
+	char *json;
+	size_t json_size;
+} manifest_t;
+
+/**
+ * Parse project.toml and convert it to the format stored in archives
+ */
+[[nodiscard]]
+bool manifest_create(const char *text, size_t size, manifest_t *manifest);
+
+void manifest_destroy(const manifest_t *manifest);
+
+/**
+ * Names listed under [assets]
+ * @param type For example "models"
+ * @returns Array of strings, or nullptr if none
+ */
+[[nodiscard]]
+const toml_value_t *manifest_assets(const manifest_t *manifest, const char *type);
@@ -0,0 +1,342 @@
+#include "nestwriter.h"
+#include "packlist.h"
+
+#include "chirp/assets.h"
+#include "chirp/compress.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct nest_descriptor
+{
+	Uint32 hash;
+	Uint16 flags;
+	Uint64 offset;
+	Uint64 size;
+	const char *name;
+
+	// Contents before compression, to find assets that can share the same data,
+	// the hash is also stored, so the engine can tell if an asset has changed
+	Uint32 content_hash;
+	Uint64 raw_size;
+	bool written;
+} nest_descriptor_t;
+
+static constexpr Uint8 nest_version = 3;
+
+// Magic, version, alignment and file count
+static constexpr Sint64 header_size = 10;
+
+// Hash, flags, reserved, offset, size, content hash and reserved
+static constexpr size_t descriptor_size = 32;
+
+[[nodiscard]]
+static bool write_zeros(SDL_IOStream *stream, size_t size)
+{
+	static constexpr Uint8 zeros[256] = {};
+
+	while (size > 0)
+	{
+		const size_t chunk = SDL_min(size, sizeof(zeros));
+		if (SDL_WriteIO(stream, zeros, chunk) != chunk)
+		{
+			return false;
+		}
+		size -= chunk;
+	}
+
+	return true;
+}
+
+[[nodiscard]]
+static bool write_padding(SDL_IOStream *stream, const Uint64 alignment)
+{
+	const Sint64 position = SDL_TellIO(stream);
+	if (position < 0)
+	{
+		return false;
+	}
+
+	return write_zeros(stream, (alignment - ((Uint64) position % alignment)) % alignment);
+}
+
+[[nodiscard]]
+static bool write_header(SDL_IOStream *stream, const nest_options_t *options, const Uint32 file_count)
+{
+	return SDL_WriteIO(stream, "nest", 4) == 4
+		&& SDL_WriteU8(stream, nest_version)
+		&& SDL_WriteU8(stream, options->alignment_log2)
+		&& SDL_WriteU32LE(stream, file_count)
+		// Directory is written last, once all offsets are known
+		&& write_zeros(stream, descriptor_size * file_count);
+}
+
+[[nodiscard]]
+static bool write_entry(SDL_IOStream *stream, const nest_options_t *options,
+	pack_entry_t *entry, nest_descriptor_t *descriptor)
+{
+	if (!write_padding(stream, (Uint64) 1 << options->alignment_log2)
+		|| !pack_entry_load(entry))
+	{
+		return false;
+	}
+
+	const void *data = entry->data;
+	size_t size = entry->size;
+
+	void *compressed = nullptr;
+	if (options->compress)
+	{
+		size_t compressed_size = 0;
+		compressed = compress_chunked(entry->data, entry->size, &compressed_size);
+
+		if (compressed != nullptr && compressed_size < entry->size)
+		{
+			data = compressed;
+			size = compressed_size;
+			descriptor->flags |= asset_flag_compressed;
+		}
+	}
+
+	descriptor->offset = (Uint64) SDL_TellIO(stream);
+	descriptor->size = size;
+
+	const bool result = SDL_WriteIO(stream, data, size) == size;
+
+	SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "%s: %zu bytes, stored as %zu bytes",
+		entry->name, entry->size, size);
+
+	SDL_free(compressed);
+	pack_entry_unload(entry);
+
+	return result;
+}
+
+[[nodiscard]]
+static bool init_descriptors(const pack_list_t *list, const nest_options_t *options,
+	nest_descriptor_t *descriptors)
+{
+	for (size_t i = 0; i < list->count; i++)
+	{
+		const pack_entry_t *entry = list->entries + i;
+
+		descriptors[i].hash = assets_hash(entry->name);
+		descriptors[i].name = entry->name;
+		descriptors[i].flags = entry->flags;
+
+		Uint64 size = 0;
+		if (!pack_entry_size(entry, &size))
+		{
+			return false;
+		}
+
+		if (options->resident_size > 0 && size <= options->resident_size)
+		{
+			descriptors[i].flags |= asset_flag_resident;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Find an already written entry with the same contents, hashes are only used to find candidates
+ * @returns Descriptor of the entry, or nullptr if there is none
+ */
+[[nodiscard]]
+static const nest_descriptor_t *find_duplicate(pack_list_t *list,
+	const nest_descriptor_t *descriptors, const size_t index)
+{
+	const pack_entry_t *entry = list->entries + index;
+	const nest_descriptor_t *descriptor = descriptors + index;
+
+	for (size_t i = 0; i < list->count; i++)
+	{
+		const nest_descriptor_t *other = descriptors + i;
+
+		if (!other->written
+			|| other->content_hash != descriptor->content_hash
+			|| other->raw_size != descriptor->raw_size
+			|| (other->flags & asset_flag_gpu_ready) != (descriptor->flags & asset_flag_gpu_ready))
+		{
+			continue;
+		}
+
+		pack_entry_t *other_entry = list->entries + i;
+		if (!pack_entry_load(other_entry))
+		{
+			return nullptr;
+		}
+
+		const bool same = SDL_memcmp(other_entry->data, entry->data, entry->size) == 0;
+		pack_entry_unload(other_entry);
+
+		if (same)
+		{
+			return other;
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+ * Write entries in list order, assets with the same contents are only stored once
+ * @param mask Only write entries where these flags match
+ * @param flags Flags to match, within the mask
+ */
+[[nodiscard]]
+static bool write_entries(SDL_IOStream *stream, const nest_options_t *options,
+	pack_list_t *list, nest_descriptor_t *descriptors, const Uint16 mask, const Uint16 flags)
+{
+	for (size_t i = 0; i < list->count; i++)
+	{
+		pack_entry_t *entry = list->entries + i;
+		nest_descriptor_t *descriptor = descriptors + i;
+
+		if ((descriptor->flags & mask) != flags)
+		{
+			continue;
+		}
+
+		if (!pack_entry_load(entry))
+		{
+			return false;
+		}
+
+		descriptor->content_hash = SDL_murmur3_32(entry->data, entry->size, 0);
+		descriptor->raw_size = entry->size;
+
+		const nest_descriptor_t *duplicate = find_duplicate(list, descriptors, i);
+
+		if (duplicate != nullptr)
+		{
+			descriptor->flags = duplicate->flags;
+			descriptor->offset = duplicate->offset;
+			descriptor->size = duplicate->size;
+
+			SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "%s: same contents as %s",
+				entry->name, duplicate->name);
+
+			pack_entry_unload(entry);
+		}
+		else if (!write_entry(stream, options, entry, descriptor))
+		{
+			return false;
+		}
+
+		descriptor->written = true;
+	}
+
+	return true;
+}
+
+static int compare_descriptors(const void *a, const void *b)
+{
+	const Uint32 hash_a = ((const nest_descriptor_t*) a)->hash;
+	const Uint32 hash_b = ((const nest_descriptor_t*) b)->hash;
+
+	return (hash_a > hash_b) - (hash_a < hash_b);
+}
+
+/**
+ * Directory is sorted by hash, so the engine can search it directly
+ */
+[[nodiscard]]
+static bool write_directory(SDL_IOStream *stream, nest_descriptor_t *descriptors, const size_t count)
+{
+	SDL_qsort(descriptors, count, sizeof(nest_descriptor_t), compare_descriptors);
+
+	for (size_t i = 1; i < count; i++)
+	{
+		if (descriptors[i].hash == descriptors[i - 1].hash)
+		{
+			return SDL_SetError("Hash collision between %s and %s",
+				descriptors[i - 1].name, descriptors[i].name);
+		}
+	}
+
+	if (SDL_SeekIO(stream, header_size, SDL_IO_SEEK_SET) < 0)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const nest_descriptor_t *descriptor = descriptors + i;
+
+		if (!SDL_WriteU32LE(stream, descriptor->hash)
+			|| !SDL_WriteU16LE(stream, descriptor->flags)
+			|| !SDL_WriteU16LE(stream, 0)
+			|| !SDL_WriteU64LE(stream, descriptor->offset)
+			|| !SDL_WriteU64LE(stream, descriptor->size)
+			|| !SDL_WriteU32LE(stream, descriptor->content_hash)
+			|| !SDL_WriteU32LE(stream, 0))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool nest_write(const char *path, pack_list_t *list, const nest_options_t *options)
+{
+	if (list->count > SDL_MAX_UINT32)
+	{
+		return SDL_SetError("Too many files: %zu", list->count);
+	}
+
+	nest_descriptor_t *descriptors = SDL_calloc(SDL_max(list->count, 1), sizeof(nest_descriptor_t));
+	if (descriptors == nullptr)
+	{
+		return false;
+	}
+
+	SDL_IOStream *stream = SDL_IOFromFile(path, "wb");
+	if (stream == nullptr)
+	{
+		SDL_free(descriptors);
+		return false;
+	}
+
+	bool result = write_header(stream, options, (Uint32) list->count)
+		&& init_descriptors(list, options, descriptors);
+
+	// Otherwise the order from the trace and model dependencies is kept
+	if (options->group_resident)
+	{
+		result = result
+			&& write_entries(stream, options, list, descriptors, asset_flag_resident, asset_flag_resident)
+			&& write_entries(stream, options, list, descriptors, asset_flag_resident, 0);
+	}
+	else
+	{
+		result = result && write_entries(stream, options, list, descriptors, 0, 0);
+	}
+
+	result = result && write_directory(stream, descriptors, list->count);
+
+	if (!SDL_CloseIO(stream))
+	{
+		result = false;
+	}
+
+	SDL_free(descriptors);
+
+	// Don't leave a broken archive behind
+	if (!result)
+	{
+		char *error = SDL_strdup(SDL_GetError());
+		SDL_RemovePath(path);
+		SDL_SetError("%s", error != nullptr ? error : "Unknown error");
+		SDL_free(error);
+	}
+
+	return result;
+}
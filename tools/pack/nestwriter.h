@@ -0,0 +1,28 @@
+#pragma once
+
+#include "packlist.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+typedef struct nest_options
+{
+	// Alignment of each asset as a power of two, for example 12 for 4 KiB
+	Uint8 alignment_log2;
+
+	// Compress assets that get smaller, compressed assets can't be viewed in place
+	bool compress;
+
+	// Assets up to this size are kept in memory once loaded, 0 to disable
+	Uint64 resident_size;
+
+	// Store resident assets first, so they can be read at once, instead of in list order
+	bool group_resident;
+} nest_options_t;
+
+/**
+ * Write a version 3 archive, in list order, or with resident assets first if grouped,
+ * entries are loaded one at a time and unloaded once written,
+ * assets with identical contents are stored once and share the same offset
+ */
+[[nodiscard]]
+bool nest_write(const char *path, pack_list_t *list, const nest_options_t *options);
@@ -0,0 +1,558 @@
+#include "packlist.h"
+#include "manifest.h"
+#include "toml.h"
+
+#include "chirp/assets.h"
+#include "chirp/assettrace.h"
+#include "chirp/json.h"
+#include "chirp/modelcooked.h"
+#include "chirp/modeldeps.h"
+#include "chirp/modelinfo.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+[[nodiscard]]
+static pack_entry_t *find_entry(const pack_list_t *list, const size_t first, const char *name)
+{
+	for (size_t i = first; i < list->count; i++)
+	{
+		if (SDL_strcmp(list->entries[i].name, name) == 0)
+		{
+			return list->entries + i;
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+ * Add an entry, taking ownership of name, path and data,
+ * assets shared between models are only added the first time
+ * @returns New or existing entry, or nullptr on failure
+ */
+[[nodiscard]]
+static pack_entry_t *add_entry(pack_list_t *list, char *name, char *path, void *data, const size_t size)
+{
+	pack_entry_t *existing = find_entry(list, 0, name);
+	if (existing != nullptr)
+	{
+		SDL_free(name);
+		SDL_free(path);
+		SDL_free(data);
+		return existing;
+	}
+
+	pack_entry_t *entries = SDL_realloc(list->entries, sizeof(pack_entry_t) * (list->count + 1));
+	if (entries == nullptr)
+	{
+		SDL_free(name);
+		SDL_free(path);
+		SDL_free(data);
+		return nullptr;
+	}
+
+	list->entries = entries;
+	list->entries[list->count] = (pack_entry_t){
+		.name = name,
+		.path = path,
+		.data = data,
+		.size = size,
+	};
+
+	return list->entries + list->count++;
+}
+
+[[nodiscard]]
+static pack_entry_t *add_file(pack_list_t *list, const char *project_dir,
+	const char *name_format, const char *path_format, const char *name)
+{
+	char *asset_name = nullptr;
+	char *path = nullptr;
+
+	if (SDL_asprintf(&asset_name, name_format, name) < 0
+		|| SDL_asprintf(&path, path_format, project_dir, name) < 0)
+	{
+		SDL_free(asset_name);
+		SDL_free(path);
+		return nullptr;
+	}
+
+	if (!SDL_GetPathInfo(path, nullptr))
+	{
+		SDL_SetError("File not found: %s", path);
+		SDL_free(asset_name);
+		SDL_free(path);
+		return nullptr;
+	}
+
+	return add_entry(list, asset_name, path, nullptr, 0);
+}
+
+/**
+ * Same naming as the engine uses when a model asks for a buffer or image
+ */
+[[nodiscard]]
+static bool add_dependency(pack_list_t *list, const char *project_dir,
+	const char *uri, model_deps_t *deps)
+{
+	char *asset_name = model_dependency_asset_name(uri);
+	char *path = nullptr;
+
+	if (asset_name == nullptr
+		|| SDL_asprintf(&path, "%s/models/%s", project_dir, uri) < 0)
+	{
+		SDL_free(asset_name);
+		return false;
+	}
+
+	SDL_PathInfo info;
+	if (!SDL_GetPathInfo(path, &info))
+	{
+		SDL_SetError("File not found: %s", path);
+		SDL_free(asset_name);
+		SDL_free(path);
+		return false;
+	}
+
+	char *dependency_name = SDL_strdup(asset_name);
+	char *dependency_uri = SDL_strdup(uri);
+
+	if (add_entry(list, asset_name, path, nullptr, 0) == nullptr
+		|| dependency_name == nullptr || dependency_uri == nullptr)
+	{
+		SDL_free(dependency_name);
+		SDL_free(dependency_uri);
+		return false;
+	}
+
+	return model_deps_add(deps, model_dependency_type(uri),
+		dependency_name, dependency_uri, info.size);
+}
+
+/**
+ * Add all external files referenced by a glTF file
+ */
+[[nodiscard]]
+static bool add_dependencies(pack_list_t *list, const char *project_dir,
+	const char *gltf, const size_t size, model_deps_t *deps)
+{
+	json_token_t *tokens = nullptr;
+	const int count = json_tokenize(gltf, size, &tokens);
+
+	if (count == JSON_ERROR_OOM)
+	{
+		return false;
+	}
+
+	if (count < 0)
+	{
+		return SDL_SetError("Invalid glTF");
+	}
+
+	for (int i = 0; i + 1 < count; i++)
+	{
+		const json_token_t *key = tokens + i;
+		const json_token_t *value = key + 1;
+
+		if (key->type != JSON_STRING || key->size != 1 || value->type != JSON_STRING
+			|| key->end - key->start != 3 || SDL_strncmp(gltf + key->start, "uri", 3) != 0)
+		{
+			continue;
+		}
+
+		// Embedded data
+		const size_t uri_len = value->end - value->start;
+		if (uri_len >= 5 && SDL_strncmp(gltf + value->start, "data:", 5) == 0)
+		{
+			continue;
+		}
+
+		char *uri = SDL_strndup(gltf + value->start, uri_len);
+		const bool result = uri != nullptr && add_dependency(list, project_dir, uri, deps);
+		SDL_free(uri);
+
+		if (!result)
+		{
+			SDL_free(tokens);
+			return false;
+		}
+	}
+
+	SDL_free(tokens);
+	return true;
+}
+
+/**
+ * Add everything in a stream written to memory as a new entry
+ */
+[[nodiscard]]
+static pack_entry_t *add_stream(pack_list_t *list, char *name, SDL_IOStream *stream)
+{
+	if (SDL_SeekIO(stream, 0, SDL_IO_SEEK_SET) != 0)
+	{
+		SDL_free(name);
+		SDL_CloseIO(stream);
+		return nullptr;
+	}
+
+	size_t size = 0;
+	void *data = SDL_LoadFile_IO(stream, &size, true);
+	if (data == nullptr)
+	{
+		SDL_free(name);
+		return nullptr;
+	}
+
+	return add_entry(list, name, nullptr, data, size);
+}
+
+/**
+ * Record everything the model is loaded from, so the engine can read it all at once
+ */
+[[nodiscard]]
+static bool add_model_deps(pack_list_t *list, const char *name, const model_deps_t *deps)
+{
+	char *deps_name = model_deps_name(name);
+	if (deps_name == nullptr)
+	{
+		return false;
+	}
+
+	SDL_IOStream *stream = SDL_IOFromDynamicMem();
+	if (stream == nullptr)
+	{
+		SDL_free(deps_name);
+		return false;
+	}
+
+	if (!model_deps_write(deps, stream))
+	{
+		SDL_free(deps_name);
+		SDL_CloseIO(stream);
+		return false;
+	}
+
+	return add_stream(list, deps_name, stream) != nullptr;
+}
+
+[[nodiscard]]
+static bool add_model(pack_list_t *list, const char *project_dir, const char *name)
+{
+	pack_entry_t *entry = add_file(list, project_dir, "models/%s", "%s/models/%s.gltf", name);
+	if (entry == nullptr || !pack_entry_load(entry))
+	{
+		return false;
+	}
+
+	// Entry can move when more are added
+	const char *gltf = entry->data;
+	const size_t gltf_size = entry->size;
+
+	char *gltf_name = SDL_strdup(entry->name);
+	char *gltf_uri = SDL_strdup("");
+
+	if (gltf_name == nullptr || gltf_uri == nullptr)
+	{
+		SDL_free(gltf_name);
+		SDL_free(gltf_uri);
+		return false;
+	}
+
+	model_deps_t deps = {};
+
+	// Buffers and images are placed right after the model that uses them
+	const bool result = model_deps_add(&deps, MODEL_DEPENDENCY_GLTF, gltf_name, gltf_uri, gltf_size)
+		&& add_dependencies(list, project_dir, gltf, gltf_size, &deps)
+		&& add_model_deps(list, name, &deps);
+
+	model_deps_destroy(&deps);
+	return result;
+}
+
+[[nodiscard]]
+static bool add_cooked_mesh(pack_list_t *list, const char *name,
+	const size_t index, const mesh_primitive_t *primitive)
+{
+	char *mesh_name = model_cooked_mesh_name(name, index);
+	if (mesh_name == nullptr)
+	{
+		return false;
+	}
+
+	SDL_IOStream *stream = SDL_IOFromDynamicMem();
+	if (stream == nullptr)
+	{
+		SDL_free(mesh_name);
+		return false;
+	}
+
+	if (!model_cooked_write_mesh(primitive, stream))
+	{
+		SDL_free(mesh_name);
+		SDL_CloseIO(stream);
+		return false;
+	}
+
+	pack_entry_t *entry = add_stream(list, mesh_name, stream);
+	if (entry == nullptr)
+	{
+		return false;
+	}
+
+	entry->flags |= asset_flag_gpu_ready;
+	return true;
+}
+
+[[nodiscard]]
+static bool add_cooked(pack_list_t *list, const char *name, const model_info_t *model)
+{
+	char *cooked_name = model_cooked_name(name);
+	if (cooked_name == nullptr)
+	{
+		return false;
+	}
+
+	SDL_IOStream *stream = SDL_IOFromDynamicMem();
+	if (stream == nullptr)
+	{
+		SDL_free(cooked_name);
+		return false;
+	}
+
+	if (!model_cooked_write(model, stream))
+	{
+		SDL_free(cooked_name);
+		SDL_CloseIO(stream);
+		return false;
+	}
+
+	if (add_stream(list, cooked_name, stream) == nullptr)
+	{
+		return false;
+	}
+
+	// Primitives are numbered across all meshes, in the order the engine reads them
+	size_t index = 0;
+
+	for (size_t mm = 0; mm < model->mesh_count; mm++)
+	{
+		const model_mesh_t *mesh = model->meshes + mm;
+
+		for (size_t pp = 0; pp < mesh->primitive_count; pp++)
+		{
+			if (!add_cooked_mesh(list, name, index++, mesh->primitives + pp))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Parse and convert the model now, instead of every time it's loaded,
+ * buffers and images aren't needed by cooked models
+ */
+[[nodiscard]]
+static bool add_cooked_model(pack_list_t *list, const char *project_dir, const char *name)
+{
+	char *path = nullptr;
+	if (SDL_asprintf(&path, "%s/models/%s.gltf", project_dir, name) < 0)
+	{
+		return false;
+	}
+
+	model_info_t model;
+	const bool created = model_info_create_file(path, &model);
+	SDL_free(path);
+
+	if (!created)
+	{
+		return false;
+	}
+
+	const bool result = add_cooked(list, name, &model);
+	model_info_destroy(&model);
+
+	return result;
+}
+
+typedef bool (*add_asset_t)(pack_list_t *list, const char *project_dir, const char *name);
+
+[[nodiscard]]
+static bool add_texture(pack_list_t *list, const char *project_dir, const char *name)
+{
+	return add_file(list, project_dir, "textures/%s", "%s/textures/%s.qoi", name) != nullptr;
+}
+
+[[nodiscard]]
+static bool add_script(pack_list_t *list, const char *project_dir, const char *name)
+{
+	return add_file(list, project_dir, "scripts/%s", "%s/scripts/%s.py", name) != nullptr;
+}
+
+[[nodiscard]]
+static bool add_assets(pack_list_t *list, const char *project_dir,
+	const manifest_t *manifest, const char *type, const add_asset_t add_asset)
+{
+	const toml_value_t *names = manifest_assets(manifest, type);
+
+	for (size_t i = 0; names != nullptr && i < names->item_count; i++)
+	{
+		const toml_value_t *name = names->items + i;
+		if (name->type != TOML_STRING)
+		{
+			return SDL_SetError("Invalid name in %s", type);
+		}
+
+		if (!add_asset(list, project_dir, name->text))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool pack_list_create(const char *project_dir, const manifest_t *manifest,
+	const bool cook, pack_list_t *list)
+{
+	*list = (pack_list_t){};
+
+	char *name = SDL_strdup("project");
+	char *json = SDL_strndup(manifest->json, manifest->json_size);
+
+	if (name == nullptr || json == nullptr)
+	{
+		SDL_free(name);
+		SDL_free(json);
+		return false;
+	}
+
+	if (add_entry(list, name, nullptr, json, manifest->json_size) == nullptr)
+	{
+		pack_list_destroy(list);
+		return false;
+	}
+
+	if (!add_assets(list, project_dir, manifest, "models", cook ? add_cooked_model : add_model)
+		|| !add_assets(list, project_dir, manifest, "textures", add_texture)
+		|| !add_assets(list, project_dir, manifest, "scripts", add_script))
+	{
+		pack_list_destroy(list);
+		return false;
+	}
+
+	return true;
+}
+
+void pack_list_destroy(const pack_list_t *list)
+{
+	for (size_t i = 0; i < list->count; i++)
+	{
+		const pack_entry_t *entry = list->entries + i;
+
+		SDL_free(entry->name);
+		SDL_free(entry->path);
+		SDL_free(entry->data);
+	}
+
+	SDL_free(list->entries);
+}
+
+typedef struct trace_order
+{
+	pack_list_t *list;
+	size_t placed;
+} trace_order_t;
+
+static void place_traced(const char *name, void *userdata)
+{
+	trace_order_t *order = userdata;
+	pack_list_t *list = order->list;
+
+	const pack_entry_t *found = find_entry(list, order->placed, name);
+	if (found == nullptr)
+	{
+		// Assets can be accessed multiple times
+		if (find_entry(list, 0, name) == nullptr)
+		{
+			SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Traced asset is not in project: %s", name);
+		}
+		return;
+	}
+
+	// Keep the order of everything else
+	const size_t index = found - list->entries;
+	const pack_entry_t entry = *found;
+
+	SDL_memmove(list->entries + order->placed + 1, list->entries + order->placed,
+		sizeof(pack_entry_t) * (index - order->placed));
+
+	list->entries[order->placed++] = entry;
+}
+
+bool pack_list_apply_trace(pack_list_t *list, const char *trace, const size_t size)
+{
+	trace_order_t order = {
+		.list = list,
+		// Project is always loaded first
+		.placed = list->count > 0 && list->entries[0].path == nullptr ? 1 : 0,
+	};
+
+	if (!asset_trace_parse(trace, size, place_traced, &order))
+	{
+		return false;
+	}
+
+	SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "Ordered %zu entries by trace", order.placed);
+	return true;
+}
+
+bool pack_entry_load(pack_entry_t *entry)
+{
+	if (entry->data != nullptr)
+	{
+		return true;
+	}
+
+	entry->data = SDL_LoadFile(entry->path, &entry->size);
+	return entry->data != nullptr;
+}
+
+void pack_entry_unload(pack_entry_t *entry)
+{
+	// Entries without a path only exist in memory
+	if (entry->path == nullptr)
+	{
+		return;
+	}
+
+	SDL_free(entry->data);
+	entry->data = nullptr;
+}
+
+bool pack_entry_size(const pack_entry_t *entry, Uint64 *size)
+{
+	if (entry->data != nullptr)
+	{
+		*size = entry->size;
+		return true;
+	}
+
+	SDL_PathInfo info;
+	if (!SDL_GetPathInfo(entry->path, &info))
+	{
+		return SDL_SetError("File not found: %s", entry->path);
+	}
+
+	*size = info.size;
+	return true;
+}
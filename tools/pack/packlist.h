@@ -0,0 +1,64 @@
+#pragma once
+
+#include "manifest.h"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct pack_entry
+{
+	// Name of the asset inside the archive
+	char *name;
+
+	// File to read the asset from, if data is not already loaded
+	char *path;
+
+	void *data;
+	size_t size;
+
+	// Asset flags stored in the archive, like asset_flag_gpu_ready
+	Uint16 flags;
+} pack_entry_t;
+
+/**
+ * Entries in the order they're written to the archive
+ */
+typedef struct pack_list
+{
+	pack_entry_t *entries;
+	size_t count;
+} pack_list_t;
+
+/**
+ * Collect all assets used by a project, ordered by when they're usually loaded:
+ * the manifest first, then each model together with its buffers, images and dependency list,
+ * followed by textures and scripts
+ * @param cook Store models in the cooked format instead of as glTF, see modelcooked.h
+ */
+[[nodiscard]]
+bool pack_list_create(const char *project_dir, const manifest_t *manifest,
+	bool cook, pack_list_t *list);
+
+void pack_list_destroy(const pack_list_t *list);
+
+/**
+ * Move entries in a recorded access trace to the front, in the order they were loaded,
+ * the trace is a text file with one asset name per line, see assettrace.h
+ */
+[[nodiscard]]
+bool pack_list_apply_trace(pack_list_t *list, const char *trace, size_t size);
+
+/**
+ * Load entry data from its path, if not already loaded
+ */
+[[nodiscard]]
+bool pack_entry_load(pack_entry_t *entry);
+
+void pack_entry_unload(pack_entry_t *entry);
+
+/**
+ * Size of the entry data, without loading it
+ */
+[[nodiscard]]
+bool pack_entry_size(const pack_entry_t *entry, Uint64 *size);
@@ -0,0 +1,472 @@
+#include "toml.h"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef struct toml_parser
+{
+	const char *text;
+	size_t size;
+	size_t pos;
+	int line;
+} toml_parser_t;
+
+[[nodiscard]]
+static char peek(const toml_parser_t *parser)
+{
+	return parser->pos < parser->size ? parser->text[parser->pos] : '\0';
+}
+
+[[nodiscard]]
+static bool parse_error(const toml_parser_t *parser, const char *message)
+{
+	return SDL_SetError("Line %d: %s", parser->line, message);
+}
+
+static void skip_whitespace(toml_parser_t *parser)
+{
+	while (peek(parser) == ' ' || peek(parser) == '\t' || peek(parser) == '\r')
+	{
+		parser->pos++;
+	}
+
+	if (peek(parser) == '#')
+	{
+		while (parser->pos < parser->size && peek(parser) != '\n')
+		{
+			parser->pos++;
+		}
+	}
+}
+
+/**
+ * Skip whitespace, comments and newlines, for example between array items
+ */
+static void skip_blank(toml_parser_t *parser)
+{
+	skip_whitespace(parser);
+
+	while (peek(parser) == '\n')
+	{
+		parser->pos++;
+		parser->line++;
+		skip_whitespace(parser);
+	}
+}
+
+[[nodiscard]]
+static bool is_bare_key(const char c)
+{
+	return SDL_isalnum(c) || c == '_' || c == '-';
+}
+
+[[nodiscard]]
+static bool add_item(toml_value_t *parent, const toml_value_t *item)
+{
+	toml_value_t *items = SDL_realloc(parent->items, sizeof(toml_value_t) * (parent->item_count + 1));
+	if (items == nullptr)
+	{
+		return false;
+	}
+
+	parent->items = items;
+	parent->items[parent->item_count++] = *item;
+	return true;
+}
+
+[[nodiscard]]
+static bool add_entry(const toml_parser_t *parser, toml_value_t *table, const toml_value_t *item)
+{
+	if (toml_get(table, item->key) != nullptr)
+	{
+		return parse_error(parser, "Duplicate key");
+	}
+
+	return add_item(table, item);
+}
+
+[[nodiscard]]
+static bool parse_string(toml_parser_t *parser, char **str)
+{
+	const char quote = peek(parser);
+	parser->pos++;
+
+	// Unescaped string is never longer than the escaped one
+	const size_t start = parser->pos;
+	size_t end = start;
+	while (end < parser->size && parser->text[end] != quote && parser->text[end] != '\n')
+	{
+		end += quote == '"' && parser->text[end] == '\\' ? 2 : 1;
+	}
+
+	*str = SDL_malloc(end - start + 1);
+	if (*str == nullptr)
+	{
+		return false;
+	}
+
+	size_t length = 0;
+
+	while (peek(parser) != quote)
+	{
+		char c = peek(parser);
+
+		if (c == '\0' || c == '\n')
+		{
+			SDL_free(*str);
+			*str = nullptr;
+			return parse_error(parser, "Unterminated string");
+		}
+
+		parser->pos++;
+
+		// Literal strings are used as is
+		if (c == '\\' && quote == '"')
+		{
+			c = peek(parser);
+			parser->pos++;
+
+			switch (c)
+			{
+				case 'n':
+					c = '\n';
+					break;
+
+				case 't':
+					c = '\t';
+					break;
+
+				case '"':
+				case '\\':
+					break;
+
+				default:
+					SDL_free(*str);
+					*str = nullptr;
+					return parse_error(parser, "Unsupported escape sequence");
+			}
+		}
+
+		(*str)[length++] = c;
+	}
+
+	parser->pos++;
+	(*str)[length] = '\0';
+	return true;
+}
+
+[[nodiscard]]
+static bool parse_key(toml_parser_t *parser, char **key)
+{
+	if (peek(parser) == '"' || peek(parser) == '\'')
+	{
+		return parse_string(parser, key);
+	}
+
+	const size_t start = parser->pos;
+	while (is_bare_key(peek(parser)))
+	{
+		parser->pos++;
+	}
+
+	if (parser->pos == start)
+	{
+		return parse_error(parser, "Expected key");
+	}
+
+	if (peek(parser) == '.')
+	{
+		return parse_error(parser, "Dotted keys are not supported");
+	}
+
+	*key = SDL_strndup(parser->text + start, parser->pos - start);
+	return *key != nullptr;
+}
+
+[[nodiscard]]
+static bool parse_value(toml_parser_t *parser, toml_value_t *value);
+
+[[nodiscard]]
+static bool parse_array(toml_parser_t *parser, toml_value_t *value)
+{
+	value->type = TOML_ARRAY;
+	parser->pos++;
+
+	while (true)
+	{
+		skip_blank(parser);
+
+		if (peek(parser) == ']')
+		{
+			parser->pos++;
+			return true;
+		}
+
+		toml_value_t item = {};
+		if (!parse_value(parser, &item))
+		{
+			toml_destroy(&item);
+			return false;
+		}
+
+		if (!add_item(value, &item))
+		{
+			toml_destroy(&item);
+			return false;
+		}
+
+		skip_blank(parser);
+
+		if (peek(parser) == ',')
+		{
+			parser->pos++;
+		}
+		else if (peek(parser) != ']')
+		{
+			return parse_error(parser, "Expected ',' or ']'");
+		}
+	}
+}
+
+[[nodiscard]]
+static bool parse_key_value(toml_parser_t *parser, toml_value_t *item)
+{
+	if (!parse_key(parser, &item->key))
+	{
+		return false;
+	}
+
+	skip_whitespace(parser);
+
+	if (peek(parser) != '=')
+	{
+		return parse_error(parser, "Expected '='");
+	}
+
+	parser->pos++;
+	skip_whitespace(parser);
+
+	return parse_value(parser, item);
+}
+
+[[nodiscard]]
+static bool parse_inline_table(toml_parser_t *parser, toml_value_t *value)
+{
+	value->type = TOML_TABLE;
+	parser->pos++;
+
+	while (true)
+	{
+		skip_whitespace(parser);
+
+		if (peek(parser) == '}')
+		{
+			parser->pos++;
+			return true;
+		}
+
+		toml_value_t item = {};
+		if (!parse_key_value(parser, &item)
+			|| !add_entry(parser, value, &item))
+		{
+			toml_destroy(&item);
+			return false;
+		}
+
+		skip_whitespace(parser);
+
+		if (peek(parser) == ',')
+		{
+			parser->pos++;
+		}
+		else if (peek(parser) != '}')
+		{
+			return parse_error(parser, "Expected ',' or '}'");
+		}
+	}
+}
+
+[[nodiscard]]
+static bool parse_scalar(toml_parser_t *parser, toml_value_t *value)
+{
+	const size_t start = parser->pos;
+	while (SDL_isalnum(peek(parser)) || SDL_strchr("+-._", peek(parser)) != nullptr)
+	{
+		parser->pos++;
+	}
+
+	const size_t length = parser->pos - start;
+	const char *text = parser->text + start;
+
+	if ((length == 4 && SDL_strncmp(text, "true", length) == 0)
+		|| (length == 5 && SDL_strncmp(text, "false", length) == 0))
+	{
+		value->type = TOML_BOOL;
+	}
+	else if (length > 0 && (SDL_isdigit(text[0]) || text[0] == '+' || text[0] == '-'))
+	{
+		value->type = TOML_NUMBER;
+	}
+	else
+	{
+		return parse_error(parser, "Expected value");
+	}
+
+	value->text = SDL_strndup(text, length);
+	return value->text != nullptr;
+}
+
+static bool parse_value(toml_parser_t *parser, toml_value_t *value)
+{
+	switch (peek(parser))
+	{
+		case '"':
+		case '\'':
+			value->type = TOML_STRING;
+			return parse_string(parser, &value->text);
+
+		case '[':
+			return parse_array(parser, value);
+
+		case '{':
+			return parse_inline_table(parser, value);
+
+		default:
+			return parse_scalar(parser, value);
+	}
+}
+
+[[nodiscard]]
+static bool parse_table_header(toml_parser_t *parser, toml_value_t *root, size_t *table)
+{
+	parser->pos++;
+	skip_whitespace(parser);
+
+	toml_value_t item = {
+		.type = TOML_TABLE,
+	};
+
+	if (!parse_key(parser, &item.key))
+	{
+		return false;
+	}
+
+	skip_whitespace(parser);
+
+	if (peek(parser) != ']')
+	{
+		toml_destroy(&item);
+		return parse_error(parser, "Expected ']'");
+	}
+
+	parser->pos++;
+
+	if (!add_entry(parser, root, &item))
+	{
+		toml_destroy(&item);
+		return false;
+	}
+
+	// Index, as the pointer changes when more tables are added
+	*table = root->item_count - 1;
+	return true;
+}
+
+bool toml_parse(const char *text, const size_t size, toml_value_t *root)
+{
+	*root = (toml_value_t){
+		.type = TOML_TABLE,
+	};
+
+	toml_parser_t parser = {
+		.text = text,
+		.size = size,
+		.pos = 0,
+		.line = 1,
+	};
+
+	// Keys before the first header belong to the root
+	size_t table = SIZE_MAX;
+
+	while (true)
+	{
+		skip_blank(&parser);
+
+		if (parser.pos >= parser.size)
+		{
+			return true;
+		}
+
+		bool result;
+
+		if (peek(&parser) == '[')
+		{
+			result = parse_table_header(&parser, root, &table);
+		}
+		else
+		{
+			toml_value_t item = {};
+			toml_value_t *parent = table == SIZE_MAX ? root : root->items + table;
+
+			result = parse_key_value(&parser, &item) && add_entry(&parser, parent, &item);
+			if (!result)
+			{
+				toml_destroy(&item);
+			}
+		}
+
+		if (result)
+		{
+			skip_whitespace(&parser);
+
+			if (parser.pos < parser.size && peek(&parser) != '\n')
+			{
+				result = parse_error(&parser, "Expected new line");
+			}
+		}
+
+		if (!result)
+		{
+			toml_destroy(root);
+			*root = (toml_value_t){};
+			return false;
+		}
+	}
+}
+
+void toml_destroy(const toml_value_t *value)
+{
+	if (value == nullptr)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < value->item_count; i++)
+	{
+		toml_destroy(value->items + i);
+	}
+
+	SDL_free(value->items);
+	SDL_free(value->key);
+	SDL_free(value->text);
+}
+
+const toml_value_t *toml_get(const toml_value_t *table, const char *key)
+{
+	if (table == nullptr || table->type != TOML_TABLE)
+	{
+		return nullptr;
+	}
+
+	for (size_t i = 0; i < table->item_count; i++)
+	{
+		if (SDL_strcmp(table->items[i].key, key) == 0)
+		{
+			return table->items + i;
+		}
+	}
+
+	return nullptr;
+}
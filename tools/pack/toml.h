@@ -0,0 +1,45 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <stddef.h>
+
+typedef enum : Uint8
+{
+	TOML_STRING = 0,
+	TOML_NUMBER = 1,
+	TOML_BOOL   = 2,
+	TOML_ARRAY  = 3,
+	TOML_TABLE  = 4,
+} toml_type_t;
+
+typedef struct toml_value
+{
+	toml_type_t type;
+
+	// Key in the parent table, nullptr for array items
+	char *key;
+
+	// Unescaped string, or the value as written for numbers and booleans
+	char *text;
+
+	// Items for arrays, or key/value pairs for tables
+	struct toml_value *items;
+	size_t item_count;
+} toml_value_t;
+
+/**
+ * Parse the subset of TOML used by project manifests:
+ * tables, strings, numbers, booleans, arrays and inline tables
+ */
+[[nodiscard]]
+bool toml_parse(const char *text, size_t size, toml_value_t *root);
+
+void toml_destroy(const toml_value_t *value);
+
+/**
+ * Find a value in a table
+ * @returns Value, or nullptr if not found
+ */
+[[nodiscard]]
+const toml_value_t *toml_get(const toml_value_t *table, const char *key);